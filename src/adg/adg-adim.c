@@ -86,6 +86,9 @@ static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_memory_size        (AdgEntity      *entity,
+                                                 AdgMemoryStats *stats);
+static AdgEntity *      _adg_clone              (AdgEntity      *entity);
 static gchar *          _adg_default_value      (AdgDim         *dim);
 static gboolean         _adg_compute_geometry   (AdgDim         *dim);
 static void             _adg_update_entities    (AdgADim        *adim);
@@ -121,6 +124,8 @@ adg_adim_class_init(AdgADimClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_size = _adg_memory_size;
+    entity_class->clone = _adg_clone;
 
     dim_class->default_value = _adg_default_value;
     dim_class->compute_geometry = _adg_compute_geometry;
@@ -275,8 +280,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -930,6 +937,45 @@ _adg_arrange(AdgEntity *entity)
     adg_entity_set_extents(entity, &extents);
 }
 
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgADimPrivate *data = adg_adim_get_instance_private((AdgADim *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    if (adg_entity_account_shared(data->trail))
+        stats->paths += adg_trail_get_memory_size(data->trail);
+
+    if (data->marker1 != NULL)
+        adg_entity_account_memory((AdgEntity *) data->marker1);
+
+    if (data->marker2 != NULL)
+        adg_entity_account_memory((AdgEntity *) data->marker2);
+}
+
+static AdgEntity *
+_adg_clone(AdgEntity *entity)
+{
+    AdgADimPrivate *data, *clone_data;
+    AdgEntity *clone;
+
+    clone = _ADG_OLD_ENTITY_CLASS->clone(entity);
+    data = adg_adim_get_instance_private((AdgADim *) entity);
+    clone_data = adg_adim_get_instance_private((AdgADim *) clone);
+
+    /* Trail, markers and geometry are rebuilt while arranging */
+    if (clone_data->org1 == NULL)
+        clone_data->org1 = adg_entity_point(clone, NULL, data->org1);
+    if (clone_data->org2 == NULL)
+        clone_data->org2 = adg_entity_point(clone, NULL, data->org2);
+    clone_data->has_extension1 = data->has_extension1;
+    clone_data->has_extension2 = data->has_extension2;
+
+    return clone;
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
@@ -150,7 +150,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
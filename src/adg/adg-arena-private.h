@@ -0,0 +1,86 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2022  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+#ifndef __ADG_ARENA_PRIVATE_H__
+#define __ADG_ARENA_PRIVATE_H__
+
+
+G_BEGIN_DECLS
+
+typedef struct _AdgArena AdgArena;
+typedef struct _AdgArenaPath AdgArenaPath;
+
+/* A bump allocator for scratch memory. Blocks are carved out of the
+ * current chunk and are never released one by one: the whole arena
+ * is rewound by _adg_arena_reset(). After a reset the chunks are
+ * merged, so in the steady state an arena owns a single chunk big
+ * enough for a whole arrange pass. */
+struct _AdgArena {
+    GSList     *chunks;
+    gchar      *next;
+    gsize       n_left;
+    gsize       chunk_size;
+    gsize       n_used;
+    gsize       n_peak;
+    guint       generation;
+};
+
+/* A cairo path built on the current arena or, when there is no
+ * current arena, on a heap buffer retained across rebuilds. The
+ * path built on an arena is valid only while the same arena is
+ * current and has not been rewound in the meantime: the owner
+ * should check it with _adg_arena_path_is_valid() and rebuild
+ * the data when needed, e.g. from an #AdgTrail callback. */
+struct _AdgArenaPath {
+    cairo_path_t        path;
+    guint               generation;
+    cairo_path_data_t  *heap;
+    gint                n_heap;
+};
+
+
+AdgArena *              _adg_arena_new          (void);
+void                    _adg_arena_free         (AdgArena       *arena);
+gpointer                _adg_arena_alloc        (AdgArena       *arena,
+                                                 gsize           size);
+void                    _adg_arena_reset        (AdgArena       *arena);
+void                    _adg_arena_release      (AdgArena       *arena,
+                                                 gpointer        block,
+                                                 gsize           size);
+gsize                   _adg_arena_get_size     (AdgArena       *arena);
+AdgArena *              _adg_arena_set_current  (AdgArena       *arena);
+AdgArena *              _adg_arena_get_current  (void);
+
+void                    _adg_arena_path_init    (AdgArenaPath   *arena_path);
+void                    _adg_arena_path_dispose (AdgArenaPath   *arena_path);
+void                    _adg_arena_path_invalidate
+                                                (AdgArenaPath   *arena_path);
+gboolean                _adg_arena_path_is_valid(const AdgArenaPath
+                                                                *arena_path);
+cairo_path_data_t *     _adg_arena_path_alloc   (AdgArenaPath   *arena_path,
+                                                 gint            num_data);
+gsize                   _adg_arena_path_get_size(const AdgArenaPath
+                                                                *arena_path);
+
+G_END_DECLS
+
+
+#endif /* __ADG_ARENA_PRIVATE_H__ */
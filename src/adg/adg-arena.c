@@ -0,0 +1,251 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2022  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+
+
+/*
+ * Bump allocator for the scratch geometry built while arranging and
+ * rendering an AdgCanvas (see adg_canvas_switch_arena()). The canvas
+ * rewinds its arena at the start of every arrange pass and makes it
+ * the current arena of the calling thread while arranging and
+ * rendering its entities: code that
+ * needs temporary path data fetches it with _adg_arena_get_current()
+ * and falls back to the general allocator when there is none.
+ *
+ * Memory got from an arena is valid only until the next reset, so it
+ * must never be stored in the entities as is: AdgArenaPath tags the
+ * data with the arena generation, so the owner can detect a reset
+ * and rebuild the data on demand.
+ */
+
+
+#include "adg-internal.h"
+
+#include "adg-arena-private.h"
+
+#define _ADG_ARENA_CHUNK_SIZE   4096
+#define _ADG_ARENA_ALIGN(size)  (((size) + sizeof(gdouble) - 1) & ~(sizeof(gdouble) - 1))
+
+
+static GPrivate         _adg_arena_current = G_PRIVATE_INIT(NULL);
+
+
+/* Generations are unique among all the arenas, so a stale tag
+ * never matches a different arena. 0 is reserved for the data
+ * not allocated from an arena */
+static guint
+_adg_arena_next_generation(void)
+{
+    static gint serial = 0;
+    guint generation;
+
+    do {
+        generation = (guint) g_atomic_int_add(&serial, 1) + 1;
+    } while (generation == 0);
+
+    return generation;
+}
+
+AdgArena *
+_adg_arena_new(void)
+{
+    AdgArena *arena = g_new0(AdgArena, 1);
+    arena->generation = _adg_arena_next_generation();
+    return arena;
+}
+
+void
+_adg_arena_free(AdgArena *arena)
+{
+    if (arena == NULL)
+        return;
+
+    g_slist_free_full(arena->chunks, g_free);
+    g_free(arena);
+}
+
+/* Allocates a new chunk big enough for at least size bytes */
+static void
+_adg_arena_grow(AdgArena *arena, gsize size)
+{
+    gsize chunk_size = MAX(size, _ADG_ARENA_CHUNK_SIZE);
+
+    arena->next = g_malloc(chunk_size);
+    arena->n_left = chunk_size;
+    arena->chunk_size += chunk_size;
+    arena->chunks = g_slist_prepend(arena->chunks, arena->next);
+}
+
+gpointer
+_adg_arena_alloc(AdgArena *arena, gsize size)
+{
+    gpointer block;
+
+    size = _ADG_ARENA_ALIGN(size);
+
+    if (size > arena->n_left)
+        _adg_arena_grow(arena, size);
+
+    block = arena->next;
+    arena->next += size;
+    arena->n_left -= size;
+    arena->n_used += size;
+    arena->n_peak = MAX(arena->n_peak, arena->n_used);
+
+    return block;
+}
+
+/* Gives back a block to the arena: only the last allocated block can
+ * actually be reused, e.g. a scratch buffer dropped just after use */
+void
+_adg_arena_release(AdgArena *arena, gpointer block, gsize size)
+{
+    size = _ADG_ARENA_ALIGN(size);
+
+    if ((gchar *) block + size != arena->next)
+        return;
+
+    arena->next = block;
+    arena->n_left += size;
+    arena->n_used -= size;
+}
+
+void
+_adg_arena_reset(AdgArena *arena)
+{
+    if (arena->chunks != NULL && arena->chunks->next != NULL) {
+        /* More chunks were needed: replace them with a single
+         * chunk big enough for the previous peak */
+        gsize peak = arena->n_peak;
+
+        g_slist_free_full(arena->chunks, g_free);
+        arena->chunks = NULL;
+        arena->chunk_size = 0;
+        _adg_arena_grow(arena, peak);
+    } else if (arena->chunks != NULL) {
+        arena->next = arena->chunks->data;
+        arena->n_left = arena->chunk_size;
+    }
+
+    arena->n_used = 0;
+    arena->generation = _adg_arena_next_generation();
+}
+
+gsize
+_adg_arena_get_size(AdgArena *arena)
+{
+    return arena != NULL ? arena->chunk_size : 0;
+}
+
+/* Returns the previous current arena, to be restored later on */
+AdgArena *
+_adg_arena_set_current(AdgArena *arena)
+{
+    AdgArena *old_arena = g_private_get(&_adg_arena_current);
+
+    g_private_set(&_adg_arena_current, arena);
+
+    return old_arena;
+}
+
+AdgArena *
+_adg_arena_get_current(void)
+{
+    return g_private_get(&_adg_arena_current);
+}
+
+
+void
+_adg_arena_path_init(AdgArenaPath *arena_path)
+{
+    arena_path->path.status = CAIRO_STATUS_INVALID_PATH_DATA;
+    arena_path->path.data = NULL;
+    arena_path->path.num_data = 0;
+    arena_path->generation = 0;
+    arena_path->heap = NULL;
+    arena_path->n_heap = 0;
+}
+
+void
+_adg_arena_path_dispose(AdgArenaPath *arena_path)
+{
+    g_free(arena_path->heap);
+    _adg_arena_path_init(arena_path);
+}
+
+void
+_adg_arena_path_invalidate(AdgArenaPath *arena_path)
+{
+    arena_path->path.status = CAIRO_STATUS_INVALID_PATH_DATA;
+    arena_path->path.data = NULL;
+    arena_path->path.num_data = 0;
+}
+
+gboolean
+_adg_arena_path_is_valid(const AdgArenaPath *arena_path)
+{
+    AdgArena *arena;
+
+    if (arena_path->path.data == NULL)
+        return FALSE;
+
+    /* Data on the heap is valid until explicitely invalidated */
+    if (arena_path->generation == 0)
+        return TRUE;
+
+    arena = _adg_arena_get_current();
+    return arena != NULL && arena->generation == arena_path->generation;
+}
+
+/* Allocates room for num_data items and makes it the path data.
+ * The content of the previous data is not preserved */
+cairo_path_data_t *
+_adg_arena_path_alloc(AdgArenaPath *arena_path, gint num_data)
+{
+    AdgArena *arena = _adg_arena_get_current();
+    cairo_path_data_t *data;
+
+    if (arena != NULL) {
+        data = _adg_arena_alloc(arena, sizeof(cairo_path_data_t) * num_data);
+        arena_path->generation = arena->generation;
+    } else {
+        if (num_data > arena_path->n_heap) {
+            arena_path->heap = g_renew(cairo_path_data_t,
+                                       arena_path->heap, num_data);
+            arena_path->n_heap = num_data;
+        }
+        data = arena_path->heap;
+        arena_path->generation = 0;
+    }
+
+    arena_path->path.status = CAIRO_STATUS_SUCCESS;
+    arena_path->path.data = data;
+    arena_path->path.num_data = num_data;
+
+    return data;
+}
+
+/* The memory owned by arena_path: the arena data belongs to the canvas */
+gsize
+_adg_arena_path_get_size(const AdgArenaPath *arena_path)
+{
+    return arena_path->n_heap * sizeof(cairo_path_data_t);
+}
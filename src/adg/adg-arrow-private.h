@@ -28,6 +28,8 @@ typedef struct _AdgArrowPrivate AdgArrowPrivate;
 
 struct _AdgArrowPrivate {
     gdouble      angle;
+    AdgTrail    *model;
+    AdgArenaPath model_path;
 };
 
 G_END_DECLS
@@ -46,13 +46,17 @@
 #include "adg-internal.h"
 #include "adg-model.h"
 #include "adg-trail.h"
-#include "adg-path.h"
 #include "adg-marker.h"
+#include "adg-arena-private.h"
 
 #include "adg-arrow.h"
 #include "adg-arrow-private.h"
 
 
+#define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_arrow_parent_class)
+#define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_arrow_parent_class)
+
+
 G_DEFINE_TYPE_WITH_PRIVATE(AdgArrow, adg_arrow, ADG_TYPE_MARKER)
 
 enum {
@@ -61,6 +65,7 @@ enum {
 };
 
 
+static void             _adg_finalize           (GObject        *object);
 static void             _adg_get_property       (GObject        *object,
                                                  guint           prop_id,
                                                  GValue         *value,
@@ -72,7 +77,11 @@ static void             _adg_set_property       (GObject        *object,
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_memory_size        (AdgEntity      *entity,
+                                                 AdgMemoryStats *stats);
 static AdgModel *       _adg_create_model       (AdgMarker      *marker);
+static cairo_path_t *   _adg_model_callback     (AdgTrail       *trail,
+                                                 gpointer        user_data);
 
 
 static void
@@ -87,11 +96,13 @@ adg_arrow_class_init(AdgArrowClass *klass)
     entity_class = (AdgEntityClass *) klass;
     marker_class = (AdgMarkerClass *) klass;
 
+    gobject_class->finalize = _adg_finalize;
     gobject_class->set_property = _adg_set_property;
     gobject_class->get_property = _adg_get_property;
 
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_size = _adg_memory_size;
 
     marker_class->create_model = _adg_create_model;
 
@@ -109,10 +120,26 @@ adg_arrow_init(AdgArrow *arrow)
     AdgArrowPrivate *data = adg_arrow_get_instance_private(arrow);
 
     data->angle = G_PI/6;
+    data->model = NULL;
+    _adg_arena_path_init(&data->model_path);
 
     adg_entity_set_local_mix((AdgEntity *) arrow, ADG_MIX_PARENT);
 }
 
+static void
+_adg_finalize(GObject *object)
+{
+    AdgArrowPrivate *data = adg_arrow_get_instance_private((AdgArrow *) object);
+
+    if (data->model != NULL)
+        g_object_unref(data->model);
+
+    _adg_arena_path_dispose(&data->model_path);
+
+    if (_ADG_OLD_OBJECT_CLASS->finalize)
+        _ADG_OLD_OBJECT_CLASS->finalize(object);
+}
+
 static void
 _adg_get_property(GObject *object, guint prop_id,
                   GValue *value, GParamSpec *pspec)
@@ -141,8 +168,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -269,23 +298,63 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     }
 }
 
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgArrowPrivate *data = adg_arrow_get_instance_private((AdgArrow *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    stats->paths += _adg_arena_path_get_size(&data->model_path);
+}
+
 static AdgModel *
 _adg_create_model(AdgMarker *marker)
 {
-    AdgArrowPrivate *data;
-    AdgPath *path;
-    CpmlPair p1, p2;
+    AdgArrowPrivate *data = adg_arrow_get_instance_private((AdgArrow *) marker);
 
-    data = adg_arrow_get_instance_private((AdgArrow *) marker);
-    path = adg_path_new();
-    cpml_vector_from_angle(&p1, data->angle / 2);
-    p2.x = p1.x;
-    p2.y = -p1.y;
+    /* The model is a lightweight trail whose data is built on the
+     * arena of the canvas, if any: it is rebuilt on every request
+     * after the arena has been rewound. The same trail is reused
+     * on every invalidation, just clearing its caches. */
+    _adg_arena_path_invalidate(&data->model_path);
 
-    adg_path_move_to_explicit(path, 0, 0);
-    adg_path_line_to(path, &p1);
-    adg_path_line_to(path, &p2);
-    adg_path_close(path);
+    if (data->model == NULL)
+        data->model = adg_trail_new(_adg_model_callback, marker);
+    else
+        adg_model_clear((AdgModel *) data->model);
 
-    return (AdgModel *) path;
+    return (AdgModel *) data->model;
+}
+
+static cairo_path_t *
+_adg_model_callback(AdgTrail *trail, gpointer user_data)
+{
+    AdgArrowPrivate *data = adg_arrow_get_instance_private((AdgArrow *) user_data);
+    cairo_path_data_t *path_data;
+    CpmlPair pair;
+
+    if (_adg_arena_path_is_valid(&data->model_path))
+        return &data->model_path.path;
+
+    cpml_vector_from_angle(&pair, data->angle / 2);
+    path_data = _adg_arena_path_alloc(&data->model_path, 7);
+
+    path_data[0].header.type = CPML_MOVE;
+    path_data[0].header.length = 2;
+    path_data[1].point.x = 0;
+    path_data[1].point.y = 0;
+    path_data[2].header.type = CPML_LINE;
+    path_data[2].header.length = 2;
+    path_data[3].point.x = pair.x;
+    path_data[3].point.y = pair.y;
+    path_data[4].header.type = CPML_LINE;
+    path_data[4].header.length = 2;
+    path_data[5].point.x = pair.x;
+    path_data[5].point.y = -pair.y;
+    path_data[6].header.type = CPML_CLOSE;
+    path_data[6].header.length = 1;
+
+    return &data->model_path.path;
 }
@@ -36,6 +36,9 @@ struct _AdgCanvasPrivate {
     gdouble        top_margin, right_margin, bottom_margin, left_margin;
     gboolean       has_frame;
     gdouble        top_padding, right_padding, bottom_padding, left_padding;
+    guint          cache_budget;
+    gdouble        lod_proxy_size, lod_hide_size;
+    AdgArena      *arena;
 };
 
 G_END_DECLS
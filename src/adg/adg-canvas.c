@@ -102,6 +102,7 @@
 #include "adg-param-dress.h"
 
 #include <adg-canvas.h>
+#include "adg-arena-private.h"
 #include "adg-canvas-private.h"
 
 #ifdef CAIRO_HAS_PS_SURFACE
@@ -137,7 +138,11 @@ enum {
     PROP_TOP_PADDING,
     PROP_RIGHT_PADDING,
     PROP_BOTTOM_PADDING,
-    PROP_LEFT_PADDING
+    PROP_LEFT_PADDING,
+    PROP_CACHE_BUDGET,
+    PROP_LOD_PROXY_SIZE,
+    PROP_LOD_HIDE_SIZE,
+    PROP_HAS_ARENA
 };
 
 
@@ -156,6 +161,8 @@ static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_memory_size        (AdgEntity      *entity,
+                                                 AdgMemoryStats *stats);
 static void             _adg_apply_paddings     (AdgCanvas      *canvas,
                                                  CpmlExtents    *extents);
 static void             _adg_update_margin      (AdgCanvas      *canvas,
@@ -203,6 +210,7 @@ adg_canvas_class_init(AdgCanvasClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_size = _adg_memory_size;
 
     param = g_param_spec_boxed("size",
                                P_("Canvas Size"),
@@ -308,6 +316,34 @@ adg_canvas_class_init(AdgCanvasClass *klass)
                                 -G_MAXDOUBLE, G_MAXDOUBLE, 15,
                                 G_PARAM_READWRITE);
     g_object_class_install_property(gobject_class, PROP_LEFT_PADDING, param);
+
+    param = g_param_spec_uint("cache-budget",
+                              P_("Cache Budget"),
+                              P_("The memory (in bytes) available for retaining the rendered entities: 0 disables the cache"),
+                              0, G_MAXUINT, 0,
+                              G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_CACHE_BUDGET, param);
+
+    param = g_param_spec_double("lod-proxy-size",
+                                P_("LOD Proxy Size"),
+                                P_("The size (in device space) below which an entity is rendered with its cheaper proxy: 0 disables the proxies"),
+                                0, G_MAXDOUBLE, 0,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_LOD_PROXY_SIZE, param);
+
+    param = g_param_spec_double("lod-hide-size",
+                                P_("LOD Hide Size"),
+                                P_("The size (in device space) below which an entity is not rendered at all: 0 renders every entity"),
+                                0, G_MAXDOUBLE, 0,
+                                G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_LOD_HIDE_SIZE, param);
+
+    param = g_param_spec_boolean("has-arena",
+                                 P_("Has Arena Flag"),
+                                 P_("If enabled, the transient path data built while arranging and rendering the canvas is allocated from a per-canvas arena"),
+                                 FALSE,
+                                 G_PARAM_READWRITE);
+    g_object_class_install_property(gobject_class, PROP_HAS_ARENA, param);
 }
 
 static void
@@ -335,6 +371,10 @@ adg_canvas_init(AdgCanvas *canvas)
     data->right_padding = 15;
     data->bottom_padding = 15;
     data->left_padding = 15;
+    data->cache_budget = 0;
+    data->lod_proxy_size = 0;
+    data->lod_hide_size = 0;
+    data->arena = NULL;
 }
 
 static void
@@ -353,6 +393,11 @@ _adg_dispose(GObject *object)
         data->scales = NULL;
     }
 
+    if (data->arena != NULL) {
+        _adg_arena_free(data->arena);
+        data->arena = NULL;
+    }
+
     if (_ADG_OLD_OBJECT_CLASS->dispose)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
 }
@@ -410,6 +455,18 @@ _adg_get_property(GObject *object, guint prop_id,
     case PROP_LEFT_PADDING:
         g_value_set_double(value, data->left_padding);
         break;
+    case PROP_CACHE_BUDGET:
+        g_value_set_uint(value, data->cache_budget);
+        break;
+    case PROP_LOD_PROXY_SIZE:
+        g_value_set_double(value, data->lod_proxy_size);
+        break;
+    case PROP_LOD_HIDE_SIZE:
+        g_value_set_double(value, data->lod_hide_size);
+        break;
+    case PROP_HAS_ARENA:
+        g_value_set_boolean(value, data->arena != NULL);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
         break;
@@ -486,10 +543,29 @@ _adg_set_property(GObject *object, guint prop_id,
     case PROP_LEFT_PADDING:
         data->left_padding = g_value_get_double(value);
         break;
+    case PROP_CACHE_BUDGET:
+        data->cache_budget = g_value_get_uint(value);
+        break;
+    case PROP_LOD_PROXY_SIZE:
+        data->lod_proxy_size = g_value_get_double(value);
+        break;
+    case PROP_LOD_HIDE_SIZE:
+        data->lod_hide_size = g_value_get_double(value);
+        break;
+    case PROP_HAS_ARENA:
+        if (! g_value_get_boolean(value)) {
+            _adg_arena_free(data->arena);
+            data->arena = NULL;
+        } else if (data->arena == NULL) {
+            data->arena = _adg_arena_new();
+        }
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -1435,6 +1511,183 @@ adg_canvas_get_paddings(AdgCanvas *canvas,
     }
 }
 
+/**
+ * adg_canvas_set_cache_budget:
+ * @canvas: an #AdgCanvas
+ * @budget: the new budget, in bytes
+ *
+ * Sets the amount of memory the entities of @canvas can use for
+ * retaining their rendered output. Any entity that did not change
+ * since the last rendering on a raster surface with the same
+ * transformation will be painted from its retained output instead of
+ * being rendered again. When @budget is exceeded, the least recently
+ * used outputs are released.
+ *
+ * The cache is disabled by default: use 0 for @budget to disable it.
+ *
+ * Since: 1.0
+ **/
+void
+adg_canvas_set_cache_budget(AdgCanvas *canvas, guint budget)
+{
+    g_return_if_fail(ADG_IS_CANVAS(canvas));
+    g_object_set(canvas, "cache-budget", budget, NULL);
+}
+
+/**
+ * adg_canvas_get_cache_budget:
+ * @canvas: an #AdgCanvas
+ *
+ * Gets the memory budget for the retained rendering of @canvas. See
+ * adg_canvas_set_cache_budget() for details.
+ *
+ * Returns: the cache budget in bytes or 0 if the cache is disabled.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_canvas_get_cache_budget(AdgCanvas *canvas)
+{
+    AdgCanvasPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), 0);
+
+    data = adg_canvas_get_instance_private(canvas);
+    return data->cache_budget;
+}
+
+/**
+ * adg_canvas_set_lod_sizes:
+ * @canvas: an #AdgCanvas
+ * @proxy_size: the size below which the proxies are used
+ * @hide_size: the size below which the entities are skipped
+ *
+ * Sets the level of detail policy of @canvas. When rendering on a raster
+ * surface, the extents of every entity are projected in device space
+ * and the bigger side is compared against these thresholds: entities
+ * smaller than @hide_size are not rendered at all while entities smaller
+ * than @proxy_size are rendered with their cheaper proxy, if any (e.g.
+ * a box instead of the glyphs of a text).
+ *
+ * Both thresholds are expressed in device units (pixels) and default to
+ * 0, that is the policy is disabled. Vector outputs are always rendered
+ * in full.
+ *
+ * Since: 1.0
+ **/
+void
+adg_canvas_set_lod_sizes(AdgCanvas *canvas,
+                         gdouble proxy_size, gdouble hide_size)
+{
+    g_return_if_fail(ADG_IS_CANVAS(canvas));
+    g_object_set(canvas,
+                 "lod-proxy-size", proxy_size,
+                 "lod-hide-size", hide_size,
+                 NULL);
+}
+
+/**
+ * adg_canvas_get_lod_sizes:
+ * @canvas: an #AdgCanvas
+ * @proxy_size: (out) (nullable): where to store the proxy threshold or NULL
+ * @hide_size: (out) (nullable):  where to store the hide threshold or NULL
+ *
+ * Convenient function to get the level of detail thresholds of @canvas
+ * with a single call. @proxy_size and/or @hide_size can be
+ * <constant>NULL</constant>, in which case the value is not returned.
+ * See adg_canvas_set_lod_sizes() for details.
+ *
+ * Since: 1.0
+ **/
+void
+adg_canvas_get_lod_sizes(AdgCanvas *canvas,
+                         gdouble *proxy_size, gdouble *hide_size)
+{
+    AdgCanvasPrivate *data;
+
+    g_return_if_fail(ADG_IS_CANVAS(canvas));
+
+    data = adg_canvas_get_instance_private(canvas);
+
+    if (proxy_size != NULL) {
+        *proxy_size = data->lod_proxy_size;
+    }
+    if (hide_size != NULL) {
+        *hide_size = data->lod_hide_size;
+    }
+}
+
+/**
+ * adg_canvas_switch_arena:
+ * @canvas:    an #AdgCanvas
+ * @new_state: the new flag status
+ *
+ * Sets a new status on the #AdgCanvas:has-arena property. When
+ * enabled, the transient path data built by the entities while
+ * @canvas is arranged and rendered (e.g. the curves approximating
+ * the arcs of the trails, the models of the markers and the grids
+ * of the tables) is carved out of a single block owned by @canvas,
+ * instead of being allocated and released every time. The block
+ * is rewound at every arrange pass: the data built on the previous
+ * pass is rebuilt when needed.
+ *
+ * The arena is disabled by default.
+ *
+ * Since: 1.0
+ **/
+void
+adg_canvas_switch_arena(AdgCanvas *canvas, gboolean new_state)
+{
+    g_return_if_fail(ADG_IS_CANVAS(canvas));
+    g_object_set(canvas, "has-arena", new_state, NULL);
+}
+
+/**
+ * adg_canvas_has_arena:
+ * @canvas: an #AdgCanvas
+ *
+ * Gets the current status of the #AdgCanvas:has-arena property. See
+ * adg_canvas_switch_arena() for details.
+ *
+ * Returns: the current status of the arena flag.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_canvas_has_arena(AdgCanvas *canvas)
+{
+    AdgCanvasPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), FALSE);
+
+    data = adg_canvas_get_instance_private(canvas);
+    return data->arena != NULL;
+}
+
+/**
+ * adg_canvas_get_memory_stats:
+ * @canvas: an #AdgCanvas
+ * @n_stats: (out): where to store the number of returned items
+ *
+ * Computes an estimate of the memory used by @canvas and by all the
+ * entities it contains, title block included. The result is broken
+ * down by entity type and, inside every #AdgMemoryStats item, by
+ * category (instances, path data, text, fill patterns and retained
+ * snapshots). Check adg_entity_get_memory_stats() for details.
+ *
+ * Returns: (transfer full) (array length=n_stats): a newly allocated array of statistics to be freed with g_free() or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgMemoryStats *
+adg_canvas_get_memory_stats(AdgCanvas *canvas, guint *n_stats)
+{
+    g_return_val_if_fail(ADG_IS_CANVAS(canvas), NULL);
+    g_return_val_if_fail(n_stats != NULL, NULL);
+
+    return adg_entity_get_memory_stats((AdgEntity *) canvas, n_stats);
+}
+
 
 static void
 _adg_global_changed(AdgEntity *entity)
@@ -1490,18 +1743,28 @@ _adg_arrange(AdgEntity *entity)
     AdgCanvas *canvas;
     AdgCanvasPrivate *data;
     CpmlExtents extents;
+    AdgArena *old_arena;
+
+    canvas = (AdgCanvas *) entity;
+    data = adg_canvas_get_instance_private(canvas);
+
+    /* A new arrange pass starts a new arena generation: the data
+     * built on the previous one is rebuilt by its owners on demand */
+    if (data->arena != NULL && _adg_arena_get_current() != data->arena)
+        _adg_arena_reset(data->arena);
+
+    old_arena = _adg_arena_set_current(data->arena);
 
     if (_ADG_OLD_ENTITY_CLASS->arrange)
         _ADG_OLD_ENTITY_CLASS->arrange(entity);
 
+    _adg_arena_set_current(old_arena);
+
     cpml_extents_copy(&extents, adg_entity_get_extents(entity));
 
     /* The extents should be defined, otherwise there is no drawing */
     g_return_if_fail(extents.is_defined);
 
-    canvas = (AdgCanvas *) entity;
-    data = adg_canvas_get_instance_private(canvas);
-
     _adg_apply_paddings(canvas, &extents);
 
     if (data->size.x > 0 || data->size.y > 0) {
@@ -1563,11 +1826,26 @@ _adg_arrange(AdgEntity *entity)
     adg_entity_set_extents(entity, &extents);
 }
 
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgCanvasPrivate *data = adg_canvas_get_instance_private((AdgCanvas *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    if (data->title_block != NULL)
+        adg_entity_account_memory((AdgEntity *) data->title_block);
+
+    stats->paths += _adg_arena_get_size(data->arena);
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
     AdgCanvasPrivate *data = adg_canvas_get_instance_private((AdgCanvas *) entity);
     const CpmlExtents *extents = adg_entity_get_extents(entity);
+    AdgArena *old_arena;
 
     cairo_save(cr);
 
@@ -1590,11 +1868,17 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
 
     cairo_restore(cr);
 
+    /* The path conversions are usually performed while rendering,
+     * so the arena is kept current also here, without rewinding it */
+    old_arena = _adg_arena_set_current(data->arena);
+
     if (data->title_block)
         adg_entity_render((AdgEntity *) data->title_block, cr);
 
     if (_ADG_OLD_ENTITY_CLASS->render)
         _ADG_OLD_ENTITY_CLASS->render(entity, cr);
+
+    _adg_arena_set_current(old_arena);
 }
 
 static void
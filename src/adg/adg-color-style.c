@@ -48,6 +48,9 @@
 #include "adg-color-style-private.h"
 
 
+#define _ADG_OLD_STYLE_CLASS   ((AdgStyleClass *) adg_color_style_parent_class)
+
+
 G_DEFINE_TYPE_WITH_PRIVATE(AdgColorStyle, adg_color_style, ADG_TYPE_STYLE)
 
 enum {
@@ -67,9 +70,12 @@ static void             _adg_set_property       (GObject        *object,
                                                  guint           prop_id,
                                                  const GValue   *value,
                                                  GParamSpec     *pspec);
+static AdgStyle *       _adg_clone              (AdgStyle       *style);
 static void             _adg_apply              (AdgStyle       *style,
                                                  AdgEntity      *entity,
                                                  cairo_t        *cr);
+static gboolean         _adg_is_source          (AdgColorStylePrivate *data,
+                                                 cairo_t        *cr);
 
 
 static void
@@ -85,6 +91,7 @@ adg_color_style_class_init(AdgColorStyleClass *klass)
     gobject_class->get_property = _adg_get_property;
     gobject_class->set_property = _adg_set_property;
 
+    style_class->clone = _adg_clone;
     style_class->apply = _adg_apply;
 
     param = g_param_spec_double("red",
@@ -172,8 +179,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_style_invalidate((AdgStyle *) object);
 }
 
 
@@ -401,14 +410,48 @@ adg_color_style_get_alpha(AdgColorStyle *color_style)
 }
 
 
+static AdgStyle *
+_adg_clone(AdgStyle *style)
+{
+    AdgStyle *clone = _ADG_OLD_STYLE_CLASS->clone(style);
+    AdgColorStylePrivate *data = adg_color_style_get_instance_private((AdgColorStyle *) style);
+    AdgColorStylePrivate *clone_data = adg_color_style_get_instance_private((AdgColorStyle *) clone);
+
+    clone_data->red = data->red;
+    clone_data->green = data->green;
+    clone_data->blue = data->blue;
+    clone_data->alpha = data->alpha;
+
+    return clone;
+}
+
 static void
 _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
 {
     AdgColorStylePrivate *data = adg_color_style_get_instance_private((AdgColorStyle *) style);
 
+    _adg_container_track_style(style, entity, cr);
+
+    /* Setting a source allocates a new pattern: avoid it if possible */
+    if (_adg_is_source(data, cr))
+        return;
+
     if (data->alpha == 1.)
         cairo_set_source_rgb(cr, data->red, data->green, data->blue);
     else
         cairo_set_source_rgba(cr, data->red, data->green, data->blue,
                               data->alpha);
 }
+
+static gboolean
+_adg_is_source(AdgColorStylePrivate *data, cairo_t *cr)
+{
+    gdouble red, green, blue, alpha;
+
+    if (cairo_pattern_get_rgba(cairo_get_source(cr), &red, &green,
+                               &blue, &alpha) != CAIRO_STATUS_SUCCESS)
+        return FALSE;
+
+    return red == data->red && green == data->green &&
+           blue == data->blue && alpha == data->alpha;
+}
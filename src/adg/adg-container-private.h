@@ -27,7 +27,9 @@ G_BEGIN_DECLS
 typedef struct _AdgContainerPrivate AdgContainerPrivate;
 
 struct _AdgContainerPrivate {
-    GSList      *children;
+    GPtrArray   *children;
+    guint        n_removed;
+    guint        iterating;
 };
 
 G_END_DECLS
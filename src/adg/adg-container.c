@@ -32,6 +32,17 @@
  * when destroyed and it will be able to update its children when an entity
  * is destroyed.
  *
+ * When rendering, the children whose extents do not overlap the clip
+ * area of the cairo context are skipped. This culling can be disabled
+ * with adg_switch_culling(), e.g. for debugging purposes.
+ *
+ * Consecutive #AdgStroke children sharing the same styles and the same
+ * global matrix can also be stroked at once: see adg_switch_batching().
+ *
+ * The line and color styles last applied by a child are applied again
+ * by the container once that child has been rendered, so the following
+ * children using the same styles find the cairo state already set.
+ *
  * Since: 1.0
  **/
 
@@ -51,8 +62,9 @@
  * @add:      signal that adds a new entity to the container.
  * @remove:   signal that removes a specific entity from the container.
  *
- * #AdgContainer effectively stores a #GSList of children into its
- * private data and keeps a reference to every child it owns.
+ * #AdgContainer effectively stores an array of children into its
+ * private data and keeps a reference to every child it owns. The
+ * children are kept in the order they have been added.
  *
  * Since: 1.0
  **/
@@ -60,6 +72,14 @@
 
 #include "adg-internal.h"
 
+#include "adg-style.h"
+#include "adg-color-style.h"
+#include "adg-dash.h"
+#include "adg-line-style.h"
+#include "adg-model.h"
+#include "adg-trail.h"
+#include "adg-stroke.h"
+
 #include "adg-container.h"
 #include "adg-container-private.h"
 
@@ -67,6 +87,35 @@
 #define _ADG_PARENT_OBJECT_CLASS  ((GObjectClass *) adg_container_parent_class)
 #define _ADG_PARENT_ENTITY_CLASS  ((AdgEntityClass *) adg_container_parent_class)
 
+/* Extents do not take into account the line width, so the clip area
+ * is enlarged by this amount (in global space) before culling */
+#define _ADG_CULLING_MARGIN       10.
+
+
+/* Tracks a kind of style on the cairo context of a container render:
+ * @shared is applied at the container level, so it is in effect at the
+ * start of every child rendering, while @last is the last one applied
+ * by the children, together with the @entity that applied it */
+typedef struct {
+    AdgStyle          *shared;
+    AdgStyle          *last;
+    AdgEntity         *entity;
+} AdgRenderStyle;
+
+typedef struct _AdgRenderData AdgRenderData;
+
+struct _AdgRenderData {
+    AdgRenderData     *parent;
+    cairo_t           *cr;
+    const CpmlExtents *clip;
+    AdgEntity         *batch;
+    AdgStyle          *line_style;
+    AdgStyle          *color_style;
+    AdgRenderStyle     line;
+    AdgRenderStyle     color;
+    cairo_antialias_t  antialias;
+};
+
 
 G_DEFINE_TYPE_WITH_PRIVATE(AdgContainer, adg_container, ADG_TYPE_ENTITY)
 
@@ -83,6 +132,7 @@ enum {
 
 
 static void             _adg_dispose            (GObject        *object);
+static void             _adg_finalize           (GObject        *object);
 static void             _adg_set_property       (GObject        *object,
                                                  guint           prop_id,
                                                  const GValue   *value,
@@ -96,6 +146,8 @@ static void             _adg_add_extents        (AdgEntity      *entity,
                                                  CpmlExtents    *extents);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_memory_size        (AdgEntity      *entity,
+                                                 AdgMemoryStats *stats);
 static GSList *         _adg_children           (AdgContainer   *container);
 static void             _adg_add                (AdgContainer   *container,
                                                  AdgEntity      *entity);
@@ -103,8 +155,31 @@ static void             _adg_remove             (AdgContainer   *container,
                                                  AdgEntity      *entity);
 static void             _adg_remove_from_list   (gpointer        container,
                                                  GObject        *entity);
+static gboolean         _adg_is_visible         (AdgEntity      *entity,
+                                                 const CpmlExtents
+                                                                *clip);
+static gboolean         _adg_is_direct          (AdgContainer   *container);
+static gint             _adg_index              (AdgContainerPrivate
+                                                                *data,
+                                                 AdgEntity      *entity);
+static void             _adg_drop               (AdgContainerPrivate
+                                                                *data,
+                                                 gint            index);
+static void             _adg_compact            (AdgContainerPrivate
+                                                                *data);
+static void             _adg_render_child       (AdgEntity      *entity,
+                                                 AdgRenderData  *render_data);
+static gboolean         _adg_batch_add          (AdgRenderData  *render_data,
+                                                 AdgEntity      *entity);
+static void             _adg_batch_flush        (AdgRenderData  *render_data);
+static void             _adg_share_styles       (AdgRenderData  *render_data);
 
 static guint            _adg_signals[LAST_SIGNAL] = { 0 };
+static gboolean         _adg_culling = TRUE;
+static gboolean         _adg_batching = FALSE;
+static guint            _adg_render_signal = 0;
+static AdgRenderData *  _adg_render_data = NULL;
+static GQuark           _adg_index_quark = 0;
 
 
 static void
@@ -118,6 +193,7 @@ adg_container_class_init(AdgContainerClass *klass)
     entity_class = (AdgEntityClass *) klass;
 
     gobject_class->dispose = _adg_dispose;
+    gobject_class->finalize = _adg_finalize;
     gobject_class->set_property = _adg_set_property;
 
     entity_class->destroy = _adg_destroy;
@@ -126,11 +202,15 @@ adg_container_class_init(AdgContainerClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_size = _adg_memory_size;
 
     klass->children = _adg_children;
     klass->add = _adg_add;
     klass->remove = _adg_remove;
 
+    _adg_index_quark = g_quark_from_static_string("adg-container-index");
+    _adg_render_signal = g_signal_lookup("render", ADG_TYPE_ENTITY);
+
     param = g_param_spec_object("child",
                                 P_("Child"),
                                 P_("Can be used to add a new child to the container"),
@@ -178,7 +258,9 @@ static void
 adg_container_init(AdgContainer *container)
 {
     AdgContainerPrivate *data = adg_container_get_instance_private(container);
-    data->children = NULL;
+    data->children = g_ptr_array_new();
+    data->n_removed = 0;
+    data->iterating = 0;
 }
 
 static void
@@ -186,18 +268,37 @@ _adg_dispose(GObject *object)
 {
     AdgContainer *container = (AdgContainer *) object;
     AdgContainerPrivate *data = adg_container_get_instance_private(container);
+    AdgEntity *entity;
+    guint n;
 
     /* Remove all the children from the container: these will emit
      * a "remove" signal for every child and will drop all the
      * references from the children to this container (and, obviously,
      * from the container to the children). */
-    while (data->children != NULL)
-        adg_container_remove(container, (AdgEntity *) data->children->data);
+    ++data->iterating;
+    for (n = data->children->len; n > 0; --n) {
+        entity = g_ptr_array_index(data->children, n - 1);
+        if (entity != NULL)
+            adg_container_remove(container, entity);
+    }
+    --data->iterating;
+    _adg_compact(data);
 
     if (_ADG_PARENT_OBJECT_CLASS->dispose)
         _ADG_PARENT_OBJECT_CLASS->dispose(object);
 }
 
+static void
+_adg_finalize(GObject *object)
+{
+    AdgContainerPrivate *data = adg_container_get_instance_private((AdgContainer *) object);
+
+    g_ptr_array_free(data->children, TRUE);
+
+    if (_ADG_PARENT_OBJECT_CLASS->finalize)
+        _ADG_PARENT_OBJECT_CLASS->finalize(object);
+}
+
 static void
 _adg_set_property(GObject *object,
                   guint prop_id, const GValue *value, GParamSpec *pspec)
@@ -210,7 +311,10 @@ _adg_set_property(GObject *object,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -297,8 +401,9 @@ adg_container_remove(AdgContainer *container, AdgEntity *entity)
  * Gets the children list of @container. This list must be manually
  * freed with g_slist_free() when no longer user.
  *
- * The returned list is ordered from the most recently added child
- * to the oldest one.
+ * The returned list is ordered from the oldest child to the most
+ * recently added one. Use adg_container_foreach() to browse the
+ * children without allocating memory.
  *
  * Returns: (element-type AdgEntity) (transfer container): a newly allocated #GSList of #AdgEntity or <constant>NULL</constant> on no children or errors
  *
@@ -325,13 +430,17 @@ adg_container_children(AdgContainer *container)
  * @callback: (scope call): a callback
  * @user_data: callback user data
  *
- * Invokes @callback on each child of @container.
- * The callback should be declared as:
+ * Invokes @callback on each child of @container, in the order they
+ * have been added. The callback should be declared as:
  *
  * <informalexample><programlisting language="C">
  * void callback(AdgEntity *entity, gpointer user_data);
  * </programlisting></informalexample>
  *
+ * Children can be added or removed from within @callback: the
+ * removed ones are not visited anymore while the added ones will
+ * be visited at the end.
+ *
  * Since: 1.0
  **/
 void
@@ -343,6 +452,24 @@ adg_container_foreach(AdgContainer *container,
     g_return_if_fail(ADG_IS_CONTAINER(container));
     g_return_if_fail(callback != NULL);
 
+    if (_adg_is_direct(container)) {
+        AdgContainerPrivate *data = adg_container_get_instance_private(container);
+        AdgEntity *entity;
+        guint n;
+
+        /* Browse the array directly: removed children are left as
+         * NULL holes until the end of the iteration */
+        ++data->iterating;
+        for (n = 0; n < data->children->len; ++n) {
+            entity = g_ptr_array_index(data->children, n);
+            if (entity != NULL)
+                ((void (*) (gpointer, gpointer)) callback) (entity, user_data);
+        }
+        --data->iterating;
+        _adg_compact(data);
+        return;
+    }
+
     children = adg_container_children(container);
 
     while (children != NULL) {
@@ -437,6 +564,24 @@ adg_container_propagate_valist(AdgContainer *container,
 
     g_return_if_fail(ADG_IS_CONTAINER(container));
 
+    if (_adg_is_direct(container)) {
+        AdgContainerPrivate *data = adg_container_get_instance_private(container);
+        AdgEntity *entity;
+        guint n;
+
+        ++data->iterating;
+        for (n = 0; n < data->children->len; ++n) {
+            entity = g_ptr_array_index(data->children, n);
+            if (entity != NULL) {
+                G_VA_COPY(var_copy, var_args);
+                g_signal_emit_valist(entity, signal_id, detail, var_copy);
+            }
+        }
+        --data->iterating;
+        _adg_compact(data);
+        return;
+    }
+
     children = adg_container_children(container);
 
     while (children != NULL) {
@@ -449,11 +594,80 @@ adg_container_propagate_valist(AdgContainer *container,
     }
 }
 
+/**
+ * adg_switch_culling:
+ * @state: new culling state
+ *
+ * Enables (if @state is <constant>TRUE</constant>, the default) or
+ * disables the culling of the children of every #AdgContainer: when
+ * enabled, the entities outside the clip area are not rendered.
+ * Disabling it is useful for debugging purposes.
+ *
+ * Since: 1.0
+ **/
+void
+adg_switch_culling(gboolean state)
+{
+    _adg_culling = state;
+}
+
+/**
+ * adg_switch_batching:
+ * @state: new batching state
+ *
+ * Enables (if @state is <constant>TRUE</constant>) or disables (the
+ * default) the batching of strokes. When enabled, consecutive #AdgStroke
+ * children of an #AdgContainer that resolve to the same line and color
+ * styles and have the same global matrix are collected in a single path
+ * and stroked with one cairo_stroke() call.
+ *
+ * Strokes with a #AdgEntity::render handler connected or with a
+ * translucent color are always rendered on their own. Subclasses of
+ * #AdgStroke (e.g. #AdgHatch) are never batched. The same applies to
+ * the strokes that would be simplified by the level of detail policy
+ * or retained by the render cache of their canvas, and to any stroke
+ * while profiling or showing the extents (see adg_switch_extents()).
+ *
+ * Since: 1.0
+ **/
+void
+adg_switch_batching(gboolean state)
+{
+    _adg_batching = state;
+}
+
 
 static void
 _adg_destroy(AdgEntity *entity)
 {
-    adg_container_propagate_by_name((AdgContainer *) entity, "destroy");
+    AdgContainer *container = (AdgContainer *) entity;
+    AdgContainerPrivate *data = adg_container_get_instance_private(container);
+    GPtrArray *children;
+    AdgEntity *child;
+    guint n;
+
+    if (! _adg_is_direct(container) || data->iterating > 0) {
+        adg_container_propagate_by_name(container, "destroy");
+    } else {
+        /* Detach all the children at once, so destroying them does
+         * not leave holes to be compacted nor weak references to be
+         * notified: the container reference of each child is the one
+         * dropped by the "destroy" default handler */
+        children = data->children;
+        data->children = g_ptr_array_new();
+        data->n_removed = 0;
+
+        for (n = 0; n < children->len; ++n) {
+            child = g_ptr_array_index(children, n);
+            if (child == NULL)
+                continue;
+            g_object_weak_unref((GObject *) child, _adg_remove_from_list, container);
+            g_object_set_qdata((GObject *) child, _adg_index_quark, NULL);
+            adg_entity_destroy(child);
+        }
+
+        g_ptr_array_free(children, TRUE);
+    }
 
     if (_ADG_PARENT_ENTITY_CLASS->destroy)
         _ADG_PARENT_ENTITY_CLASS->destroy(entity);
@@ -465,7 +679,8 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_PARENT_ENTITY_CLASS->global_changed)
         _ADG_PARENT_ENTITY_CLASS->global_changed(entity);
 
-    adg_container_propagate_by_name((AdgContainer *) entity, "global-changed");
+    adg_container_foreach((AdgContainer *) entity,
+                          G_CALLBACK(adg_entity_global_changed), NULL);
 }
 
 static void
@@ -474,13 +689,15 @@ _adg_local_changed(AdgEntity *entity)
     if (_ADG_PARENT_ENTITY_CLASS->local_changed)
         _ADG_PARENT_ENTITY_CLASS->local_changed(entity);
 
-    adg_container_propagate_by_name((AdgContainer *) entity, "local-changed");
+    adg_container_foreach((AdgContainer *) entity,
+                          G_CALLBACK(adg_entity_local_changed), NULL);
 }
 
 static void
 _adg_invalidate(AdgEntity *entity)
 {
-    adg_container_propagate_by_name((AdgContainer *) entity, "invalidate");
+    adg_container_foreach((AdgContainer *) entity,
+                          G_CALLBACK(adg_entity_invalidate), NULL);
 }
 
 static void
@@ -489,7 +706,7 @@ _adg_arrange(AdgEntity *entity)
     AdgContainer *container = (AdgContainer *) entity;
     CpmlExtents extents = { 0 };
 
-    adg_container_propagate_by_name(container, "arrange", NULL);
+    adg_container_foreach(container, G_CALLBACK(adg_entity_arrange), NULL);
     adg_container_foreach(container, G_CALLBACK(_adg_add_extents), &extents);
     adg_entity_set_extents(entity, &extents);
 }
@@ -502,10 +719,66 @@ _adg_add_extents(AdgEntity *entity, CpmlExtents *extents)
     }
 }
 
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgContainerPrivate *data = adg_container_get_instance_private((AdgContainer *) entity);
+
+    if (_ADG_PARENT_ENTITY_CLASS->memory_size)
+        _ADG_PARENT_ENTITY_CLASS->memory_size(entity, stats);
+
+    stats->instance += data->children->len * sizeof(gpointer);
+
+    adg_container_foreach((AdgContainer *) entity,
+                          G_CALLBACK(adg_entity_account_memory), NULL);
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
-    adg_container_propagate_by_name((AdgContainer *) entity, "render", cr);
+    CpmlExtents clip;
+    gdouble x1, y1, x2, y2;
+    AdgRenderData render_data;
+    AdgRenderData *parent;
+
+    render_data.parent = _adg_render_data;
+    render_data.cr = cr;
+    render_data.clip = NULL;
+    render_data.batch = NULL;
+    render_data.line.shared = NULL;
+    render_data.line.last = NULL;
+    render_data.color.shared = NULL;
+    render_data.color.last = NULL;
+    render_data.antialias = cairo_get_antialias(cr);
+
+    if (_adg_culling) {
+        cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+        clip.is_defined = 1;
+        clip.org.x = x1 - _ADG_CULLING_MARGIN;
+        clip.org.y = y1 - _ADG_CULLING_MARGIN;
+        clip.size.x = x2 - x1 + _ADG_CULLING_MARGIN * 2;
+        clip.size.y = y2 - y1 + _ADG_CULLING_MARGIN * 2;
+        render_data.clip = &clip;
+    }
+
+    _adg_render_data = &render_data;
+    adg_container_foreach((AdgContainer *) entity,
+                          G_CALLBACK(_adg_render_child), &render_data);
+    _adg_batch_flush(&render_data);
+    _adg_render_data = render_data.parent;
+
+    /* The parent container can share the styles of this subtree too */
+    parent = render_data.parent;
+    if (parent != NULL && parent->cr == cr) {
+        if (render_data.line.last != NULL) {
+            parent->line.last = render_data.line.last;
+            parent->line.entity = render_data.line.entity;
+        }
+        if (render_data.color.last != NULL) {
+            parent->color.last = render_data.color.last;
+            parent->color.entity = render_data.color.entity;
+        }
+    }
 }
 
 
@@ -513,9 +786,18 @@ static GSList *
 _adg_children(AdgContainer *container)
 {
     AdgContainerPrivate *data = adg_container_get_instance_private(container);
+    GSList *children = NULL;
+    AdgEntity *entity;
+    guint n;
+
+    /* Prepend from the end to get the list in the proper order */
+    for (n = data->children->len; n > 0; --n) {
+        entity = g_ptr_array_index(data->children, n - 1);
+        if (entity != NULL)
+            children = g_slist_prepend(children, entity);
+    }
 
-    /* The NULL case is already managed by GLib */
-    return g_slist_copy(data->children);
+    return children;
 }
 
 static void
@@ -536,7 +818,9 @@ _adg_add(AdgContainer *container, AdgEntity *entity)
     }
 
     data = adg_container_get_instance_private(container);
-    data->children = g_slist_prepend(data->children, entity);
+    g_object_set_qdata((GObject *) entity, _adg_index_quark,
+                       GUINT_TO_POINTER(data->children->len + 1));
+    g_ptr_array_add(data->children, entity);
 
     g_object_ref_sink(entity);
     adg_entity_set_parent(entity, (AdgEntity *) container);
@@ -547,16 +831,21 @@ static void
 _adg_remove_from_list(gpointer container, GObject *entity)
 {
     AdgContainerPrivate *data = adg_container_get_instance_private((AdgContainer *) container);
-    data->children = g_slist_remove(data->children, entity);
+    gint index = _adg_index(data, (AdgEntity *) entity);
+
+    if (index >= 0) {
+        _adg_drop(data, index);
+        _adg_compact(data);
+    }
 }
 
 static void
 _adg_remove(AdgContainer *container, AdgEntity *entity)
 {
     AdgContainerPrivate *data = adg_container_get_instance_private(container);
-    GSList *node = g_slist_find(data->children, entity);
+    gint index = _adg_index(data, entity);
 
-    if (node == NULL) {
+    if (index < 0) {
         g_warning(_("Attempting to remove an entity with type %s from a "
                     "container of type %s, but the entity is not present"),
                   g_type_name(G_OBJECT_TYPE(entity)),
@@ -565,7 +854,248 @@ _adg_remove(AdgContainer *container, AdgEntity *entity)
     }
 
     g_object_weak_unref((GObject *) entity, _adg_remove_from_list, container);
-    data->children = g_slist_delete_link(data->children, node);
+    _adg_drop(data, index);
+    _adg_compact(data);
     adg_entity_set_parent(entity, NULL);
     g_object_unref(entity);
 }
+
+static gboolean
+_adg_is_visible(AdgEntity *entity, const CpmlExtents *clip)
+{
+    const CpmlExtents *extents = adg_entity_get_extents(entity);
+
+    /* Without extents there is no way to know: render it anyway */
+    if (! extents->is_defined)
+        return TRUE;
+
+    return extents->org.x <= clip->org.x + clip->size.x &&
+           extents->org.y <= clip->org.y + clip->size.y &&
+           extents->org.x + extents->size.x >= clip->org.x &&
+           extents->org.y + extents->size.y >= clip->org.y;
+}
+
+static gboolean
+_adg_is_direct(AdgContainer *container)
+{
+    /* The children array can be browsed directly only
+     * if the children() method has not been overriden */
+    return ADG_CONTAINER_GET_CLASS(container)->children == _adg_children;
+}
+
+static gint
+_adg_index(AdgContainerPrivate *data, AdgEntity *entity)
+{
+    guint n;
+
+    /* Fast path: the index of every child is stored in the child */
+    n = GPOINTER_TO_UINT(g_object_get_qdata((GObject *) entity,
+                                            _adg_index_quark));
+    if (n > 0 && n <= data->children->len &&
+        g_ptr_array_index(data->children, n - 1) == entity)
+        return n - 1;
+
+    for (n = 0; n < data->children->len; ++n) {
+        if (g_ptr_array_index(data->children, n) == entity)
+            return n;
+    }
+
+    return -1;
+}
+
+static void
+_adg_drop(AdgContainerPrivate *data, gint index)
+{
+    AdgEntity *entity = g_ptr_array_index(data->children, index);
+
+    /* Leave a hole: the array is compacted later on */
+    g_object_set_qdata((GObject *) entity, _adg_index_quark, NULL);
+    g_ptr_array_index(data->children, index) = NULL;
+    ++data->n_removed;
+}
+
+static void
+_adg_compact(AdgContainerPrivate *data)
+{
+    GPtrArray *children = data->children;
+    AdgEntity *entity;
+    guint n, len;
+
+    /* Do not move children while someone is browsing the array
+     * and wait for enough holes to amortize the compaction */
+    if (data->iterating > 0 || data->n_removed * 2 < children->len)
+        return;
+
+    len = 0;
+    for (n = 0; n < children->len; ++n) {
+        entity = g_ptr_array_index(children, n);
+        if (entity == NULL)
+            continue;
+        if (n != len) {
+            g_ptr_array_index(children, len) = entity;
+            g_object_set_qdata((GObject *) entity, _adg_index_quark,
+                               GUINT_TO_POINTER(len + 1));
+        }
+        ++len;
+    }
+
+    g_ptr_array_set_size(children, len);
+    data->n_removed = 0;
+}
+
+static void
+_adg_render_child(AdgEntity *entity, AdgRenderData *render_data)
+{
+    if (render_data->clip != NULL &&
+        ! _adg_is_visible(entity, render_data->clip))
+        return;
+
+    if (_adg_batching && _adg_batch_add(render_data, entity))
+        return;
+
+    /* Keep the rendering order: the pending strokes go first */
+    _adg_batch_flush(render_data);
+    adg_entity_render(entity, render_data->cr);
+    _adg_share_styles(render_data);
+}
+
+/* Appends the path of @entity to the current batch, opening a new one
+ * if needed. Returns FALSE if @entity cannot be batched. */
+static gboolean
+_adg_batch_add(AdgRenderData *render_data, AdgEntity *entity)
+{
+    cairo_t *cr = render_data->cr;
+    AdgStroke *stroke;
+    AdgTrail *trail;
+    AdgStyle *line_style, *color_style;
+    const cairo_matrix_t *global;
+    const cairo_path_t *cairo_path;
+
+    /* Only plain strokes: derived types can render something else
+     * and connected handlers expect the signal to be emitted */
+    if (G_OBJECT_TYPE(entity) != ADG_TYPE_STROKE ||
+        g_signal_has_handler_pending(entity, _adg_render_signal, 0, FALSE))
+        return FALSE;
+
+    stroke = (AdgStroke *) entity;
+    trail = adg_stroke_get_trail(stroke);
+    if (trail == NULL)
+        return FALSE;
+
+    line_style = adg_entity_style(entity, adg_stroke_get_line_dress(stroke));
+    if (! ADG_IS_LINE_STYLE(line_style))
+        return FALSE;
+
+    /* Overlapping translucent strokes would look different */
+    color_style = adg_entity_style(entity,
+                                   adg_line_style_get_color_dress((AdgLineStyle *) line_style));
+    if (! ADG_IS_COLOR_STYLE(color_style) ||
+        adg_color_style_get_alpha((AdgColorStyle *) color_style) != 1.)
+        return FALSE;
+
+    /* Level of detail, retained snapshots, profiling and the extents
+     * overlay are all handled by adg_entity_render() */
+    adg_entity_arrange(entity);
+    if (! _adg_entity_is_plain_render(entity, cr))
+        return FALSE;
+
+    cairo_path = adg_trail_get_cairo_path(trail);
+    if (cairo_path == NULL)
+        return FALSE;
+
+    global = adg_entity_get_global_matrix(entity);
+
+    if (render_data->batch != NULL &&
+        (render_data->line_style != line_style ||
+         render_data->color_style != color_style ||
+         ! adg_matrix_equal(global, adg_entity_get_global_matrix(render_data->batch))))
+        _adg_batch_flush(render_data);
+
+    if (render_data->batch == NULL) {
+        render_data->batch = entity;
+        render_data->line_style = line_style;
+        render_data->color_style = color_style;
+        cairo_save(cr);
+        cairo_transform(cr, global);
+        cairo_new_path(cr);
+    }
+
+    /* The same transformations performed by AdgStroke */
+    cairo_save(cr);
+    cairo_transform(cr, adg_entity_get_local_matrix(entity));
+    cairo_append_path(cr, cairo_path);
+    cairo_restore(cr);
+
+    return TRUE;
+}
+
+static void
+_adg_batch_flush(AdgRenderData *render_data)
+{
+    AdgEntity *entity = render_data->batch;
+    cairo_t *cr = render_data->cr;
+
+    if (entity == NULL)
+        return;
+
+    adg_entity_apply_dress(entity,
+                           adg_stroke_get_line_dress((AdgStroke *) entity),
+                           cr);
+    cairo_stroke(cr);
+    cairo_restore(cr);
+
+    render_data->batch = NULL;
+    _adg_share_styles(render_data);
+}
+
+/* Applies again at the container level the styles last applied by the
+ * children, so they survive the cairo_restore() closing every child
+ * rendering and the following children using them find the cairo state
+ * already set. The style application itself skips what is unchanged. */
+static void
+_adg_share_styles(AdgRenderData *render_data)
+{
+    AdgStyle *color = render_data->color.last;
+    AdgEntity *color_entity = render_data->color.entity;
+
+    /* The antialiasing mode affects fills too, so a line style
+     * changing it is not shared: the other settings affect only
+     * the strokes and every stroke applies its own line style */
+    if (render_data->line.last != render_data->line.shared &&
+        adg_line_style_get_antialias((AdgLineStyle *) render_data->line.last) ==
+        render_data->antialias) {
+        render_data->line.shared = render_data->line.last;
+        adg_style_apply(render_data->line.last, render_data->line.entity,
+                        render_data->cr);
+    }
+
+    /* Applying the line style applies its color too: the color applied
+     * last by the children must prevail anyway */
+    render_data->color.last = color;
+    render_data->color.entity = color_entity;
+
+    if (color != render_data->color.shared) {
+        render_data->color.shared = color;
+        adg_style_apply(color, color_entity, render_data->cr);
+    }
+}
+
+/* Called by the line and color styles whenever they are applied */
+void
+_adg_container_track_style(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
+{
+    AdgRenderStyle *tracked;
+
+    if (_adg_render_data == NULL || _adg_render_data->cr != cr)
+        return;
+
+    if (ADG_IS_LINE_STYLE(style))
+        tracked = &_adg_render_data->line;
+    else if (ADG_IS_COLOR_STYLE(style))
+        tracked = &_adg_render_data->color;
+    else
+        return;
+
+    tracked->last = style;
+    tracked->entity = entity;
+}
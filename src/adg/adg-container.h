@@ -84,6 +84,8 @@ void            adg_container_propagate_valist  (AdgContainer    *container,
                                                  guint            signal_id,
                                                  GQuark           detail,
                                                  va_list          var_args);
+void            adg_switch_culling              (gboolean         state);
+void            adg_switch_batching             (gboolean         state);
 
 G_END_DECLS
 
@@ -55,10 +55,14 @@
 
 #include "adg-dash.h"
 #include "adg-dash-private.h"
+#include "adg-pool-private.h"
 
 #include <string.h>
 
 
+static AdgPool          _adg_dash_pool = ADG_POOL_INIT(AdgDash);
+
+
 GType
 adg_dash_get_type(void)
 {
@@ -90,7 +94,7 @@ adg_dash_dup(const AdgDash *src)
 
     g_return_val_if_fail(src != NULL, NULL);
 
-    dash = cpml_memdup(src, sizeof(AdgDash));
+    dash = _adg_pool_dup(&_adg_dash_pool, src);
     dash->dashes = cpml_memdup(src->dashes, sizeof(gdouble) * src->num_dashes);
 
     return dash;
@@ -108,7 +112,7 @@ adg_dash_dup(const AdgDash *src)
 AdgDash *
 adg_dash_new(void)
 {
-    AdgDash *dash = g_new(AdgDash, 1);
+    AdgDash *dash = _adg_pool_alloc(&_adg_dash_pool);
 
     dash->dashes = NULL;
     dash->num_dashes = 0;
@@ -369,5 +373,5 @@ adg_dash_destroy(AdgDash *dash)
     g_return_if_fail(dash != NULL);
 
     g_free(dash->dashes);
-    g_free(dash);
+    _adg_pool_free(&_adg_dash_pool, dash);
 }
@@ -85,6 +85,9 @@
 #define VALID_FORMATS "aieDdMmSs"
 
 
+#define _ADG_OLD_STYLE_CLASS   ((AdgStyleClass *) adg_dim_style_parent_class)
+
+
 G_DEFINE_TYPE_WITH_PRIVATE(AdgDimStyle, adg_dim_style, ADG_TYPE_STYLE)
 
 enum {
@@ -129,6 +132,8 @@ static AdgMarker *      _adg_marker_new         (const AdgMarkerData
 static void             _adg_marker_data_set    (AdgMarkerData  *marker_data,
                                                  AdgMarker      *marker);
 static void             _adg_marker_data_unset  (AdgMarkerData  *marker_data);
+static void             _adg_marker_data_copy   (AdgMarkerData  *marker_data,
+                                                 const AdgMarkerData *src);
 
 
 static void
@@ -473,8 +478,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_style_invalidate((AdgStyle *) object);
 }
 
 
@@ -1399,22 +1406,39 @@ adg_dim_style_convert(AdgDimStyle *dim_style, gdouble *value, gchar format)
 static AdgStyle *
 _adg_clone(AdgStyle *style)
 {
-    AdgDimStyle *dim_style;
-    AdgMarker *marker;
-
-    dim_style = (AdgDimStyle *) adg_object_clone(G_OBJECT(style));
-
-    /* Manually clone the marker because the underlying properties are
-     * writable only */
-    marker = adg_dim_style_marker1_new((AdgDimStyle *) style);
-    adg_dim_style_set_marker1(dim_style, marker);
-    g_object_unref(marker);
-
-    marker = adg_dim_style_marker2_new((AdgDimStyle *) style);
-    adg_dim_style_set_marker2(dim_style, marker);
-    g_object_unref(marker);
-
-    return (AdgStyle *) dim_style;
+    AdgStyle *clone = _ADG_OLD_STYLE_CLASS->clone(style);
+    AdgDimStylePrivate *data = adg_dim_style_get_instance_private((AdgDimStyle *) style);
+    AdgDimStylePrivate *clone_data = adg_dim_style_get_instance_private((AdgDimStyle *) clone);
+
+    /* The marker properties are writable only, so the marker data
+     * is copied directly instead of instantiating the markers */
+    _adg_marker_data_copy(&clone_data->marker1, &data->marker1);
+    _adg_marker_data_copy(&clone_data->marker2, &data->marker2);
+
+    clone_data->color_dress = data->color_dress;
+    clone_data->value_dress = data->value_dress;
+    clone_data->min_dress = data->min_dress;
+    clone_data->max_dress = data->max_dress;
+    clone_data->line_dress = data->line_dress;
+    clone_data->marker_dress = data->marker_dress;
+    clone_data->from_offset = data->from_offset;
+    clone_data->to_offset = data->to_offset;
+    clone_data->beyond = data->beyond;
+    clone_data->baseline_spacing = data->baseline_spacing;
+    clone_data->limits_spacing = data->limits_spacing;
+    clone_data->quote_shift = data->quote_shift;
+    clone_data->limits_shift = data->limits_shift;
+    clone_data->decimals = data->decimals;
+    clone_data->rounding = data->rounding;
+
+    g_free(clone_data->number_format);
+    clone_data->number_format = g_strdup(data->number_format);
+    g_free(clone_data->number_arguments);
+    clone_data->number_arguments = g_strdup(data->number_arguments);
+    g_free(clone_data->number_tag);
+    clone_data->number_tag = g_strdup(data->number_tag);
+
+    return clone;
 }
 
 static void
@@ -1493,3 +1517,27 @@ _adg_marker_data_unset(AdgMarkerData *marker_data)
     marker_data->names = NULL;
     marker_data->values = NULL;
 }
+
+static void
+_adg_marker_data_copy(AdgMarkerData *marker_data, const AdgMarkerData *src)
+{
+    guint n;
+
+    _adg_marker_data_unset(marker_data);
+
+    if (src->type == 0)
+        return;
+
+    marker_data->type = src->type;
+    marker_data->n_properties = src->n_properties;
+
+    /* The names are interned strings, so they can be shared */
+    marker_data->names = cpml_memdup(src->names,
+                                     src->n_properties * sizeof(const gchar *));
+    marker_data->values = g_new0(GValue, src->n_properties);
+
+    for (n = 0; n < src->n_properties; ++n) {
+        g_value_init(&marker_data->values[n], G_VALUE_TYPE(&src->values[n]));
+        g_value_copy(&src->values[n], &marker_data->values[n]);
+    }
+}
@@ -119,6 +119,10 @@ static void     _adg_global_changed     (AdgEntity          *entity);
 static void     _adg_local_changed      (AdgEntity          *entity);
 static void     _adg_invalidate         (AdgEntity          *entity);
 static void     _adg_arrange            (AdgEntity          *entity);
+static void     _adg_memory_size        (AdgEntity          *entity,
+                                         AdgMemoryStats     *stats);
+static AdgEntity *
+                _adg_clone              (AdgEntity          *entity);
 static gboolean _adg_compute_geometry   (AdgDim             *dim);
 static gchar *  _adg_default_value      (AdgDim             *dim);
 static gdouble  _adg_quote_angle        (gdouble             angle);
@@ -157,6 +161,8 @@ adg_dim_class_init(AdgDimClass *klass)
     entity_class->local_changed = _adg_local_changed;
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
+    entity_class->memory_size = _adg_memory_size;
+    entity_class->clone = _adg_clone;
 
     klass->compute_geometry = _adg_compute_geometry;
     klass->quote_angle = _adg_quote_angle;
@@ -377,8 +383,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -826,6 +834,7 @@ adg_dim_set_level(AdgDim *dim, gdouble level)
 
     data = adg_dim_get_instance_private(dim);
     data->level = level;
+    adg_entity_mark_dirty((AdgEntity *) dim);
     g_object_notify((GObject *) dim, "level");
 }
 
@@ -865,8 +874,10 @@ adg_dim_set_outside(AdgDim *dim, AdgThreeState outside)
 {
     g_return_if_fail(ADG_IS_DIM(dim));
 
-    if (_adg_set_outside(dim, outside))
+    if (_adg_set_outside(dim, outside)) {
+        adg_entity_mark_dirty((AdgEntity *) dim);
         g_object_notify((GObject *) dim, "outside");
+    }
 }
 
 /**
@@ -910,8 +921,10 @@ adg_dim_set_detached(AdgDim *dim, AdgThreeState detached)
 {
     g_return_if_fail(ADG_IS_DIM(dim));
 
-    if (_adg_set_detached(dim, detached))
+    if (_adg_set_detached(dim, detached)) {
+        adg_entity_mark_dirty((AdgEntity *) dim);
         g_object_notify((GObject *) dim, "detached");
+    }
 }
 
 /**
@@ -958,8 +971,10 @@ adg_dim_set_value(AdgDim *dim, const gchar *value)
 {
     g_return_if_fail(ADG_IS_DIM(dim));
 
-    if (_adg_set_value(dim, value))
+    if (_adg_set_value(dim, value)) {
+        adg_entity_mark_dirty((AdgEntity *) dim);
         g_object_notify((GObject *) dim, "value");
+    }
 }
 
 /**
@@ -1090,8 +1105,10 @@ adg_dim_set_min(AdgDim *dim, const gchar *min)
 {
     g_return_if_fail(ADG_IS_DIM(dim));
 
-    if (_adg_set_min(dim, min))
+    if (_adg_set_min(dim, min)) {
+        adg_entity_mark_dirty((AdgEntity *) dim);
         g_object_notify((GObject *) dim, "min");
+    }
 }
 
 /**
@@ -1133,8 +1150,10 @@ adg_dim_set_max(AdgDim *dim, const gchar *max)
 {
     g_return_if_fail(ADG_IS_DIM(dim));
 
-    if (_adg_set_max(dim, max))
+    if (_adg_set_max(dim, max)) {
+        adg_entity_mark_dirty((AdgEntity *) dim);
         g_object_notify((GObject *) dim, "max");
+    }
 }
 
 /**
@@ -1479,6 +1498,52 @@ _adg_invalidate(AdgEntity *entity)
         _ADG_OLD_ENTITY_CLASS->invalidate(entity);
 }
 
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgDimPrivate *data = adg_dim_get_instance_private((AdgDim *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    /* The quote is not a child of any container */
+    if (data->quote.entity != NULL)
+        adg_entity_account_memory((AdgEntity *) data->quote.entity);
+}
+
+static AdgEntity *
+_adg_clone(AdgEntity *entity)
+{
+    AdgDim *dim, *clone_dim;
+    AdgDimPrivate *data, *clone_data;
+    AdgEntity *clone;
+
+    clone = _ADG_OLD_ENTITY_CLASS->clone(entity);
+    dim = (AdgDim *) entity;
+    clone_dim = (AdgDim *) clone;
+    data = adg_dim_get_instance_private(dim);
+    clone_data = adg_dim_get_instance_private(clone_dim);
+
+    clone_data->dim_dress = data->dim_dress;
+    clone_data->level = data->level;
+
+    /* The points are copied but their models are shared */
+    if (clone_data->ref1 == NULL)
+        clone_data->ref1 = adg_entity_point(clone, NULL, data->ref1);
+    if (clone_data->ref2 == NULL)
+        clone_data->ref2 = adg_entity_point(clone, NULL, data->ref2);
+    if (clone_data->pos == NULL)
+        clone_data->pos = adg_entity_point(clone, NULL, data->pos);
+
+    _adg_set_outside(clone_dim, data->outside);
+    _adg_set_detached(clone_dim, data->detached);
+    _adg_set_value(clone_dim, data->value);
+    _adg_set_min(clone_dim, data->min);
+    _adg_set_max(clone_dim, data->max);
+
+    return clone;
+}
+
 static void
 _adg_arrange(AdgEntity *entity)
 {
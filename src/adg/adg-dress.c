@@ -190,6 +190,7 @@ static void             _adg_data_register          (AdgDress    dress,
                                                      GType       ancestor_type);
 static void             _adg_data_register_builtins (void);
 static AdgDressPrivate *_adg_data_lookup            (AdgDress    dress);
+static guint            _adg_generation = 0;
 
 
 /**
@@ -346,6 +347,7 @@ adg_dress_set_fallback(AdgDress dress, AdgStyle *fallback)
         g_object_unref(data->fallback);
 
     data->fallback = fallback;
+    ++_adg_generation;
 
     if (data->fallback != NULL)
         g_object_ref(data->fallback);
@@ -370,6 +372,27 @@ adg_dress_get_fallback(AdgDress dress)
     return data != NULL ? data->fallback : NULL;
 }
 
+/**
+ * adg_dress_get_generation:
+ *
+ * <note><para>
+ * This function is only useful in entity implementations.
+ * </para></note>
+ *
+ * Gets a counter that is incremented whenever the fallback style of
+ * any dress changes. It can be used to check whether a style resolved
+ * in the past is still valid.
+ *
+ * Returns: the current generation of the fallback styles.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_dress_get_generation(void)
+{
+    return _adg_generation;
+}
+
 /**
  * adg_dress_style_is_compatible:
  * @dress:                  an #AdgDress
@@ -42,6 +42,7 @@ GType           adg_dress_get_ancestor_type     (AdgDress        dress);
 void            adg_dress_set_fallback          (AdgDress        dress,
                                                  AdgStyle       *fallback);
 AdgStyle *      adg_dress_get_fallback          (AdgDress        dress);
+guint           adg_dress_get_generation        (void);
 gboolean        adg_dress_style_is_compatible   (AdgDress        dress,
                                                  AdgStyle       *style);
 
@@ -55,10 +55,12 @@
 
 #include "adg-edges.h"
 #include "adg-edges-private.h"
+#include "adg-pool-private.h"
 
 
 #define _ADG_OLD_OBJECT_CLASS   ((GObjectClass *) adg_edges_parent_class)
 #define _ADG_OLD_MODEL_CLASS    ((AdgModelClass *) adg_edges_parent_class)
+#define _ADG_OLD_TRAIL_CLASS    ((AdgTrailClass *) adg_edges_parent_class)
 #define DEFAULT_CRITICAL_ANGLE  (G_PI / 180)
 
 
@@ -84,15 +86,21 @@ static void             _adg_set_property       (GObject        *object,
                                                  GParamSpec     *pspec);
 static void             _adg_clear              (AdgModel       *model);
 static cairo_path_t *   _adg_get_cairo_path     (AdgTrail       *trail);
+static gsize            _adg_memory_size        (AdgTrail       *trail);
 static void             _adg_unset_source       (AdgEdges       *edges);
 static void             _adg_clear_cairo_path   (AdgEdges       *edges);
 static GSList *         _adg_get_vertices       (GSList         *vertices,
                                                  CpmlSegment    *segment,
                                                  gdouble         threshold);
 static GSList *         _adg_optimize_vertices  (GSList         *vertices);
-static GArray *         _adg_path_build         (const GSList   *vertices);
+static GArray *         _adg_path_build         (GArray         *array,
+                                                 const GSList   *vertices);
 static void             _adg_path_transform     (GArray         *path_data,
                                                  const cairo_matrix_t*map);
+static void             _adg_free_vertex        (gpointer        vertex,
+                                                 gpointer        user_data);
+
+static AdgPool          _adg_vertex_pool = ADG_POOL_INIT(CpmlPair);
 
 
 static void
@@ -115,6 +123,7 @@ adg_edges_class_init(AdgEdgesClass *klass)
     model_class->clear = _adg_clear;
 
     trail_class->get_cairo_path = _adg_get_cairo_path;
+    trail_class->memory_size = _adg_memory_size;
 
     param = g_param_spec_object("source",
                                 P_("Source"),
@@ -163,7 +172,10 @@ _adg_dispose(GObject *object)
 static void
 _adg_finalize(GObject *object)
 {
-    _adg_clear_cairo_path((AdgEdges *) object);
+    AdgEdgesPrivate *data = adg_edges_get_instance_private((AdgEdges *) object);
+
+    if (data->cairo.array != NULL)
+        g_array_free(data->cairo.array, TRUE);
 
     if (_ADG_OLD_OBJECT_CLASS->finalize != NULL)
         _ADG_OLD_OBJECT_CLASS->finalize(object);
@@ -450,9 +462,9 @@ _adg_get_cairo_path(AdgTrail *trail)
         g_slist_foreach(vertices, (GFunc) cpml_pair_transform, &map);
 
         vertices = _adg_optimize_vertices(vertices);
-        data->cairo.array = _adg_path_build(vertices);
+        data->cairo.array = _adg_path_build(data->cairo.array, vertices);
 
-        g_slist_foreach(vertices, (GFunc) g_free, NULL);
+        g_slist_foreach(vertices, _adg_free_vertex, NULL);
         g_slist_free(vertices);
 
         /* Reapply the inverse of the previous transformation to
@@ -468,6 +480,21 @@ _adg_get_cairo_path(AdgTrail *trail)
     return &data->cairo.path;
 }
 
+static gsize
+_adg_memory_size(AdgTrail *trail)
+{
+    AdgEdgesPrivate *data = adg_edges_get_instance_private((AdgEdges *) trail);
+    gsize size = 0;
+
+    if (data->cairo.array != NULL)
+        size += data->cairo.array->len * sizeof(cairo_path_data_t);
+
+    if (_ADG_OLD_TRAIL_CLASS->memory_size != NULL)
+        size += _ADG_OLD_TRAIL_CLASS->memory_size(trail);
+
+    return size;
+}
+
 static void
 _adg_unset_source(AdgEdges *edges)
 {
@@ -480,10 +507,10 @@ _adg_clear_cairo_path(AdgEdges *edges)
 {
     AdgEdgesPrivate *data = adg_edges_get_instance_private(edges);
 
-    if (data->cairo.array != NULL) {
-        g_array_free(data->cairo.array, TRUE);
-        data->cairo.array = NULL;
-    }
+    /* Keep the array around: the next rebuild will likely need
+     * the same amount of memory */
+    if (data->cairo.array != NULL)
+        g_array_set_size(data->cairo.array, 0);
 
     data->cairo.path.status = CAIRO_STATUS_INVALID_PATH_DATA;
     data->cairo.path.data = NULL;
@@ -529,7 +556,8 @@ _adg_get_vertices(GSList *vertices, CpmlSegment *segment, gdouble threshold)
         if (new.x == 0 ||
             cpml_pair_squared_distance(&old, &new) > threshold) {
             cpml_primitive_put_pair_at(&primitive, 0, &pair);
-            vertices = g_slist_append(vertices, cpml_pair_dup(&pair));
+            vertices = g_slist_append(vertices,
+                                      _adg_pool_dup(&_adg_vertex_pool, &pair));
         }
 
         cpml_primitive_put_vector_at(&primitive, 1, &old);
@@ -562,11 +590,11 @@ _adg_optimize_vertices(GSList *vertices)
 
         if (old_pair->y < pair->y) {
             /* Preserve the old vertex and remove the current one */
-            g_free(pair);
+            _adg_pool_free(&_adg_vertex_pool, pair);
             vertices = g_slist_delete_link(vertices, vertex);
         } else {
             /* Preserve the current vertex and remove the old one */
-            g_free(old_pair);
+            _adg_pool_free(&_adg_vertex_pool, old_pair);
             vertices = g_slist_delete_link(vertices, old_vertex);
             old_vertex = vertex;
         }
@@ -576,10 +604,9 @@ _adg_optimize_vertices(GSList *vertices)
 }
 
 static GArray *
-_adg_path_build(const GSList *vertices)
+_adg_path_build(GArray *array, const GSList *vertices)
 {
     cairo_path_data_t line[4];
-    GArray *array;
     const GSList *vertex, *vertex2;
     const CpmlPair *pair, *pair2;
 
@@ -588,7 +615,8 @@ _adg_path_build(const GSList *vertices)
     line[2].header.type = CPML_LINE;
     line[2].header.length = 2;
 
-    array = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+    if (array == NULL)
+        array = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
     vertex = vertices;
 
     while (vertex != NULL) {
@@ -628,3 +656,9 @@ _adg_path_transform(GArray *path_data, const cairo_matrix_t *map)
         cairo_matrix_transform_point(map, &data->point.x, &data->point.y);
     }
 }
+
+static void
+_adg_free_vertex(gpointer vertex, gpointer user_data)
+{
+    _adg_pool_free(&_adg_vertex_pool, vertex);
+}
@@ -24,27 +24,78 @@
 
 G_BEGIN_DECLS
 
+typedef enum   _AdgMatrixKind    AdgMatrixKind;
 typedef struct _AdgEntityPrivate AdgEntityPrivate;
+typedef struct _AdgRenderCache   AdgRenderCache;
+typedef struct _AdgCompactMatrix AdgCompactMatrix;
+
+enum _AdgMatrixKind {
+    ADG_MATRIX_NULL,
+    ADG_MATRIX_IDENTITY,
+    ADG_MATRIX_TRANSLATION,
+    ADG_MATRIX_GENERIC
+};
+
+/* Null and identity matrices resolve to the shared instances returned
+ * by adg_matrix_null() and adg_matrix_identity() and translations keep
+ * their offset inline in @x0 and @y0. Only generic matrices need the
+ * whole matrix, taken from a pool and kept in @storage: @storage is also
+ * used to expand a translation when its full matrix is requested. The
+ * kind allows to skip the full multiplication when composing. */
+struct _AdgCompactMatrix {
+    AdgMatrixKind        kind;
+    gdouble              x0, y0;
+    cairo_matrix_t      *storage;
+};
+
+struct _AdgRenderCache {
+    guint                used;
+    GQueue               lru;
+};
 
 struct _AdgEntityPrivate {
     gboolean             floating;
     AdgEntity           *parent;
-    cairo_matrix_t       global_map;
-    cairo_matrix_t       local_map;
+    AdgCompactMatrix     global_map;
+    AdgCompactMatrix     local_map;
     AdgMix               local_mix;
     GHashTable          *hash_styles;
 
+    struct {
+        guint            generation;
+        guint            dress_generation;
+        guint            n_slots;
+        guint            next_slot;
+        struct {
+            AdgDress     dress;
+            AdgStyle    *style;
+        }                slots[4];
+    }                    styles;
+
     struct {
         gboolean         is_defined;
-        cairo_matrix_t   matrix;
+        AdgCompactMatrix matrix;
     }                    global;
 
     struct {
         gboolean         is_defined;
-        cairo_matrix_t   matrix;
+        AdgCompactMatrix matrix;
     }                    local;
 
     CpmlExtents          extents;
+    gboolean             dirty;
+    gboolean             arranging;
+    GPtrArray           *pending;
+
+    struct {
+        cairo_surface_t *surface;
+        cairo_matrix_t   ctm;
+        gdouble          x, y;
+        guint            size;
+        guint            serial;
+        AdgRenderCache  *cache;
+        GList            link;
+    }                    snapshot;
 };
 
 G_END_DECLS
@@ -58,11 +58,49 @@
  * @invalidate:     invalidating callback, used to clear the internal cache
  * @arrange:        prepare the layout and fill the extents struct
  * @render:         rendering callback, it must be implemented by every entity
+ * @render_proxy:   cheap rendering used when the entity is too small to be
+ *                  worth its details, or %NULL to always use @render
+ * @memory_size:    adds the memory owned by the entity to an
+ *                  #AdgMemoryStats struct
+ * @clone:          creates a detached copy of the entity
  *
  * Any entity (if not abstract) must implement at least the @render method.
  * The other signal handlers can be overriden to provide custom behaviors
  * and usually must chain up the original handler.
  *
+ * When no handler is connected to #AdgEntity::global-changed,
+ * #AdgEntity::local-changed, #AdgEntity::invalidate,
+ * #AdgEntity::arrange or #AdgEntity::render, the class handler is
+ * called directly without emitting the signal, so emission hooks are
+ * not run in that case.
+ *
+ * The default @memory_size accounts the instance and its retained
+ * snapshot: entities owning other data should chain up and add their
+ * own figures, calling adg_entity_account_memory() on the entities
+ * they own that are not children of a container.
+ *
+ * The default @clone copies the readable and writable properties
+ * when the class does not override it. Derived classes overriding
+ * @clone must chain up and copy their own fields on the result.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgMemoryStats:
+ * @type:       the #GType of the entities accounted by this item
+ * @n_entities: number of entities of type @type
+ * @instance:   bytes used by the instances, private data included
+ * @paths:      bytes of path data, either owned or cached
+ * @text:       bytes of glyph arrays and text layouts
+ * @patterns:   bytes of the surfaces backing fill patterns
+ * @snapshots:  bytes of retained snapshot surfaces
+ *
+ * Memory usage of a set of entities of the same type, as returned by
+ * adg_entity_get_memory_stats(). Every figure is an estimate: the
+ * overhead of the allocator and of the external libraries is not
+ * taken into account.
+ *
  * Since: 1.0
  **/
 
@@ -95,10 +133,20 @@
 #include "adg-cairo-fallback.h"
 
 #include "adg-entity-private.h"
+#include "adg-pool-private.h"
+#include "adg-profile.h"
+#include "adg-profile-private.h"
+
+#include <math.h>
+#include <stdlib.h>
 
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_entity_parent_class)
 
+/* Room left around the extents of a retained entity, in global space,
+ * to include the parts (e.g. line widths) not accounted in extents */
+#define _ADG_SNAPSHOT_MARGIN   10.
+
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE(AdgEntity, adg_entity, G_TYPE_INITIALLY_UNOWNED)
 
@@ -124,6 +172,7 @@ enum {
 
 
 static void             _adg_dispose            (GObject         *object);
+static void             _adg_finalize           (GObject         *object);
 static void             _adg_get_property       (GObject         *object,
                                                  guint            prop_id,
                                                  GValue          *value,
@@ -133,6 +182,24 @@ static void             _adg_set_property       (GObject         *object,
                                                  const GValue    *value,
                                                  GParamSpec      *pspec);
 static void             _adg_destroy            (AdgEntity       *entity);
+static AdgEntity *      _adg_clone              (AdgEntity       *entity);
+static void             _adg_dirty              (AdgEntity       *entity);
+static void             _adg_pending_add        (AdgEntity       *entity,
+                                                 AdgEntity       *child);
+static void             _adg_pending_check      (AdgEntity       *entity);
+static AdgRenderCache * _adg_render_cache       (AdgEntity       *entity,
+                                                 guint           *budget);
+static void             _adg_render_cache_free  (gpointer         cache);
+static void             _adg_render_cache_trim  (AdgRenderCache  *cache,
+                                                 guint            budget);
+static void             _adg_snapshot_drop      (AdgEntity       *entity);
+static gboolean         _adg_lod_hit            (AdgEntity       *entity,
+                                                 cairo_t         *cr,
+                                                 gboolean        *proxy);
+static gboolean         _adg_lod_render         (AdgEntity       *entity,
+                                                 cairo_t         *cr);
+static gboolean         _adg_snapshot_render    (AdgEntity       *entity,
+                                                 cairo_t         *cr);
 static void             _adg_set_parent         (AdgEntity       *entity,
                                                  AdgEntity       *parent);
 static void             _adg_global_changed     (AdgEntity       *entity);
@@ -141,8 +208,56 @@ static void             _adg_real_invalidate    (AdgEntity       *entity);
 static void             _adg_real_arrange       (AdgEntity       *entity);
 static void             _adg_real_render        (AdgEntity       *entity,
                                                  cairo_t         *cr);
+static const cairo_matrix_t *
+                        _adg_matrix_get         (AdgCompactMatrix
+                                                                 *compact);
+static const cairo_matrix_t *
+                        _adg_matrix_expand      (const AdgCompactMatrix
+                                                                 *compact,
+                                                 cairo_matrix_t  *buffer);
+static void             _adg_matrix_set         (AdgCompactMatrix
+                                                                 *compact,
+                                                 const cairo_matrix_t
+                                                                 *matrix);
+static void             _adg_matrix_translation (AdgCompactMatrix
+                                                                 *compact,
+                                                 gdouble          x0,
+                                                 gdouble          y0);
+static cairo_matrix_t * _adg_matrix_storage     (AdgCompactMatrix
+                                                                 *compact);
+static void             _adg_matrix_copy        (AdgCompactMatrix
+                                                                 *compact,
+                                                 const AdgCompactMatrix
+                                                                 *src);
+static void             _adg_matrix_compose     (AdgCompactMatrix
+                                                                 *compact,
+                                                 const AdgCompactMatrix
+                                                                 *parent,
+                                                 const AdgCompactMatrix
+                                                                 *map);
+static void             _adg_matrix_normalize   (AdgCompactMatrix
+                                                                 *compact);
+static void             _adg_emit_global_changed(AdgEntity       *entity);
+static void             _adg_emit_local_changed (AdgEntity       *entity);
+static void             _adg_emit_invalidate    (AdgEntity       *entity);
+static void             _adg_emit_arrange       (AdgEntity       *entity);
+static void             _adg_emit_render        (AdgEntity       *entity,
+                                                 cairo_t         *cr);
+static void             _adg_memory_size        (AdgEntity       *entity,
+                                                 AdgMemoryStats  *stats);
+static gsize            _adg_memory_total       (const AdgMemoryStats
+                                                                 *stats);
+static int              _adg_compare_memory     (gconstpointer    p1,
+                                                 gconstpointer    p2);
 static guint            _adg_signals[LAST_SIGNAL] = { 0 };
 static gboolean         _adg_show_extents = FALSE;
+static GQuark           _adg_render_cache_quark = 0;
+static guint            _adg_snapshot_serial = 0;
+static guint            _adg_style_generation = 0;
+static gint             _adg_snapshot_depth = 0;
+static GHashTable *     _adg_memory_stats = NULL;
+static GHashTable *     _adg_memory_shared = NULL;
+static AdgPool          _adg_matrix_pool = ADG_POOL_INIT(cairo_matrix_t);
 
 
 static void
@@ -156,9 +271,13 @@ adg_entity_class_init(AdgEntityClass *klass)
     gobject_class = (GObjectClass *) klass;
 
     gobject_class->dispose = _adg_dispose;
+    gobject_class->finalize = _adg_finalize;
     gobject_class->get_property = _adg_get_property;
     gobject_class->set_property = _adg_set_property;
 
+    _adg_render_cache_quark = g_quark_from_static_string("adg-render-cache");
+    _adg_profile_init();
+
     klass->destroy = _adg_destroy;
     klass->parent_set = NULL;
     klass->global_changed = _adg_global_changed;
@@ -166,6 +285,9 @@ adg_entity_class_init(AdgEntityClass *klass)
     klass->invalidate = NULL;
     klass->arrange= NULL;
     klass->render = NULL;
+    klass->render_proxy = NULL;
+    klass->memory_size = _adg_memory_size;
+    klass->clone = _adg_clone;
 
     param = g_param_spec_boolean("floating",
                                  P_("Floating Entity"),
@@ -350,15 +472,29 @@ adg_entity_init(AdgEntity *entity)
     AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
     data->floating = FALSE;
     data->parent = NULL;
-    cairo_matrix_init_identity(&data->global_map);
-    cairo_matrix_init_identity(&data->local_map);
+    data->global_map.kind = ADG_MATRIX_IDENTITY;
+    data->global_map.storage = NULL;
+    data->local_map.kind = ADG_MATRIX_IDENTITY;
+    data->local_map.storage = NULL;
     data->local_mix = ADG_MIX_ANCESTORS;
     data->hash_styles = NULL;
+    data->styles.n_slots = 0;
+    data->styles.next_slot = 0;
     data->global.is_defined = FALSE;
-    adg_matrix_copy(&data->global.matrix, adg_matrix_null());
+    data->global.matrix.kind = ADG_MATRIX_NULL;
+    data->global.matrix.storage = NULL;
     data->local.is_defined = FALSE;
-    adg_matrix_copy(&data->local.matrix, adg_matrix_null());
+    data->local.matrix.kind = ADG_MATRIX_NULL;
+    data->local.matrix.storage = NULL;
     data->extents.is_defined = FALSE;
+    data->dirty = TRUE;
+    data->arranging = FALSE;
+    data->pending = NULL;
+    data->snapshot.surface = NULL;
+    data->snapshot.cache = NULL;
+    data->snapshot.link.data = entity;
+    data->snapshot.link.next = NULL;
+    data->snapshot.link.prev = NULL;
 }
 
 static void
@@ -370,16 +506,36 @@ _adg_dispose(GObject *object)
     /* This call will emit a "notify" signal for parent.
      * Consequentially, the references to the old parent is dropped. */
     adg_entity_set_parent(entity, NULL);
+    _adg_snapshot_drop(entity);
 
     if (data->hash_styles != NULL) {
         g_hash_table_destroy(data->hash_styles);
         data->hash_styles = NULL;
     }
 
+    if (data->pending != NULL) {
+        g_ptr_array_free(data->pending, TRUE);
+        data->pending = NULL;
+    }
+
     if (_ADG_OLD_OBJECT_CLASS->dispose)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
 }
 
+static void
+_adg_finalize(GObject *object)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private((AdgEntity *) object);
+
+    _adg_pool_free(&_adg_matrix_pool, data->global_map.storage);
+    _adg_pool_free(&_adg_matrix_pool, data->local_map.storage);
+    _adg_pool_free(&_adg_matrix_pool, data->global.matrix.storage);
+    _adg_pool_free(&_adg_matrix_pool, data->local.matrix.storage);
+
+    if (_ADG_OLD_OBJECT_CLASS->finalize)
+        _ADG_OLD_OBJECT_CLASS->finalize(object);
+}
+
 static void
 _adg_get_property(GObject *object, guint prop_id,
                   GValue *value, GParamSpec *pspec)
@@ -395,10 +551,10 @@ _adg_get_property(GObject *object, guint prop_id,
         g_value_set_object(value, data->parent);
         break;
     case PROP_GLOBAL_MAP:
-        g_value_set_boxed(value, &data->global_map);
+        g_value_set_boxed(value, _adg_matrix_get(&data->global_map));
         break;
     case PROP_LOCAL_MAP:
-        g_value_set_boxed(value, &data->local_map);
+        g_value_set_boxed(value, _adg_matrix_get(&data->local_map));
         break;
     case PROP_LOCAL_MIX:
         g_value_set_enum(value, data->local_mix);
@@ -424,11 +580,11 @@ _adg_set_property(GObject *object, guint prop_id,
                         (AdgEntity *) g_value_get_object(value));
         break;
     case PROP_GLOBAL_MAP:
-        adg_matrix_copy(&data->global_map, g_value_get_boxed(value));
+        _adg_matrix_set(&data->global_map, g_value_get_boxed(value));
         data->global.is_defined = FALSE;
         break;
     case PROP_LOCAL_MAP:
-        adg_matrix_copy(&data->local_map, g_value_get_boxed(value));
+        _adg_matrix_set(&data->local_map, g_value_get_boxed(value));
         data->local.is_defined = FALSE;
         break;
     case PROP_LOCAL_MIX:
@@ -437,8 +593,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    _adg_dirty((AdgEntity *) object);
 }
 
 
@@ -456,6 +614,9 @@ void
 adg_switch_extents(gboolean state)
 {
     _adg_show_extents = state;
+
+    /* Retained entities could include the extents of nested entities */
+    ++_adg_snapshot_serial;
 }
 
 /**
@@ -475,6 +636,39 @@ adg_entity_destroy(AdgEntity *entity)
     g_signal_emit(entity, _adg_signals[DESTROY], 0);
 }
 
+/**
+ * adg_entity_clone:
+ * @entity: an #AdgEntity
+ *
+ * Creates a new entity of the same type of @entity with the same
+ * settings. The clone is not bound to any parent, the children of
+ * containers are not cloned and the models (e.g. the trail of an
+ * #AdgStroke or the models of the points of an #AdgDim) are shared
+ * with @entity.
+ *
+ * The core entities copy their data directly. Entities that do not
+ * provide their own #AdgEntityClass.clone method are cloned by
+ * copying their readable and writable properties.
+ *
+ * Returns: (transfer full): the newly created floating entity or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgEntity *
+adg_entity_clone(AdgEntity *entity)
+{
+    AdgEntityClass *klass;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+
+    klass = ADG_ENTITY_GET_CLASS(entity);
+
+    if (klass->clone == NULL)
+        return NULL;
+
+    return klass->clone(entity);
+}
+
 /**
  * adg_entity_switch_floating:
  * @entity: an #AdgEntity
@@ -504,6 +698,9 @@ adg_entity_switch_floating(AdgEntity  *entity, gboolean new_state)
 
     data = adg_entity_get_instance_private(entity);
     data->floating = new_state;
+
+    if (data->parent != NULL)
+        _adg_dirty(data->parent);
 }
 
 /**
@@ -653,7 +850,7 @@ adg_entity_transform_global_map(AdgEntity *entity,
 
     data = adg_entity_get_instance_private(entity);
 
-    adg_matrix_copy(&map, &data->global_map);
+    adg_matrix_copy(&map, _adg_matrix_get(&data->global_map));
     adg_matrix_transform(&map, transformation, mode);
 
     g_object_set(entity, "global-map", &map, NULL);
@@ -678,7 +875,7 @@ adg_entity_get_global_map(AdgEntity *entity)
     g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
 
     data = adg_entity_get_instance_private(entity);
-    return &data->global_map;
+    return _adg_matrix_get(&data->global_map);
 }
 
 /**
@@ -686,7 +883,8 @@ adg_entity_get_global_map(AdgEntity *entity)
  * @entity: an #AdgEntity object
  *
  * Gets the current global matrix of @entity. The returned value
- * is owned by @entity and should not be changed or freed.
+ * is owned by @entity and should not be changed or freed. It is
+ * valid only until the global matrix is computed again.
  *
  * The global matrix is computed in the arrange() phase by
  * combining all the global maps of the @entity hierarchy using
@@ -704,7 +902,7 @@ adg_entity_get_global_matrix(AdgEntity *entity)
     g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
 
     data = adg_entity_get_instance_private(entity);
-    return &data->global.matrix;
+    return _adg_matrix_get(&data->global.matrix);
 }
 
 /**
@@ -757,7 +955,7 @@ adg_entity_transform_local_map(AdgEntity *entity,
 
     data = adg_entity_get_instance_private(entity);
 
-    adg_matrix_copy(&map, &data->local_map);
+    adg_matrix_copy(&map, _adg_matrix_get(&data->local_map));
     adg_matrix_transform(&map, transformation, mode);
     g_object_set(entity, "local-map", &map, NULL);
 }
@@ -781,7 +979,7 @@ adg_entity_get_local_map(AdgEntity *entity)
     g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
 
     data = adg_entity_get_instance_private(entity);
-    return &data->local_map;
+    return _adg_matrix_get(&data->local_map);
 }
 
 /**
@@ -789,7 +987,8 @@ adg_entity_get_local_map(AdgEntity *entity)
  * @entity: an #AdgEntity object
  *
  * Gets the current local matrix of @entity. The returned value
- * is owned by @entity and should not be changed or freed.
+ * is owned by @entity and should not be changed or freed. It is
+ * valid only until the local matrix is computed again.
  *
  * The local matrix is computed in the arrange() phase by
  * combining all the local maps of the @entity hierarchy using
@@ -807,7 +1006,7 @@ adg_entity_get_local_matrix(AdgEntity *entity)
     g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
 
     data = adg_entity_get_instance_private(entity);
-    return &data->local.matrix;
+    return _adg_matrix_get(&data->local.matrix);
 }
 
 /**
@@ -956,6 +1155,11 @@ adg_entity_set_style(AdgEntity *entity, AdgDress dress, AdgStyle *style)
     if (style == old_style)
         return;
 
+    /* Styles are inherited: any retained output and any
+     * resolved style in the descendants could be affected */
+    ++_adg_snapshot_serial;
+    ++_adg_style_generation;
+
     if (style == NULL) {
         g_hash_table_remove(data->hash_styles, p_dress);
         return;
@@ -1033,21 +1237,46 @@ adg_entity_get_style(AdgEntity *entity, AdgDress dress)
 AdgStyle *
 adg_entity_style(AdgEntity *entity, AdgDress dress)
 {
+    AdgEntityPrivate *data;
     AdgStyle *style;
+    guint dress_generation, n;
 
     g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
 
+    data = adg_entity_get_instance_private(entity);
+    dress_generation = adg_dress_get_generation();
+
+    /* Drop the resolved styles if something changed in the meantime */
+    if (data->styles.generation != _adg_style_generation ||
+        data->styles.dress_generation != dress_generation) {
+        data->styles.generation = _adg_style_generation;
+        data->styles.dress_generation = dress_generation;
+        data->styles.n_slots = 0;
+        data->styles.next_slot = 0;
+    }
+
+    for (n = 0; n < data->styles.n_slots; ++n) {
+        if (data->styles.slots[n].dress == dress)
+            return data->styles.slots[n].style;
+    }
+
     style = adg_entity_get_style(entity, dress);
 
     if (style == NULL) {
-        AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
-
         if (data->parent != NULL)
             style = adg_entity_style(data->parent, dress);
         else
             style = adg_dress_get_fallback(dress);
     }
 
+    /* Cache the result, replacing the oldest slot when full */
+    n = data->styles.next_slot;
+    data->styles.slots[n].dress = dress;
+    data->styles.slots[n].style = style;
+    data->styles.next_slot = (n + 1) % G_N_ELEMENTS(data->styles.slots);
+    if (data->styles.n_slots < G_N_ELEMENTS(data->styles.slots))
+        ++data->styles.n_slots;
+
     return style;
 }
 
@@ -1090,7 +1319,7 @@ adg_entity_global_changed(AdgEntity *entity)
 {
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
-    g_signal_emit(entity, _adg_signals[GLOBAL_CHANGED], 0);
+    _adg_emit_global_changed(entity);
 }
 
 /**
@@ -1107,7 +1336,7 @@ adg_entity_local_changed(AdgEntity *entity)
 {
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
-    g_signal_emit(entity, _adg_signals[LOCAL_CHANGED], 0);
+    _adg_emit_local_changed(entity);
 }
 
 /**
@@ -1126,7 +1355,27 @@ adg_entity_invalidate(AdgEntity *entity)
 {
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
-    g_signal_emit(entity, _adg_signals[INVALIDATE], 0);
+    _adg_emit_invalidate(entity);
+}
+
+/**
+ * adg_entity_mark_dirty:
+ * @entity: an #AdgEntity
+ *
+ * Marks @entity and its ancestors as needing a new arrange phase. An
+ * entity not marked is not arranged again by adg_entity_arrange(), so
+ * derived types must call this function from the setter of any
+ * property affecting their arrangement. Differently from
+ * adg_entity_invalidate(), the cache of @entity is left untouched.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_mark_dirty(AdgEntity *entity)
+{
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+
+    _adg_dirty(entity);
 }
 
 /**
@@ -1144,7 +1393,7 @@ adg_entity_arrange(AdgEntity *entity)
 {
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
-    g_signal_emit(entity, _adg_signals[ARRANGE], 0);
+    _adg_emit_arrange(entity);
 }
 
 /**
@@ -1162,7 +1411,7 @@ adg_entity_render(AdgEntity *entity, cairo_t *cr)
 {
     g_return_if_fail(ADG_IS_ENTITY(entity));
 
-    g_signal_emit(entity, _adg_signals[RENDER], 0, cr);
+    _adg_emit_render(entity, cr);
 }
 
 /**
@@ -1227,6 +1476,139 @@ adg_entity_point(AdgEntity *entity, AdgPoint *old_point, const AdgPoint *new_poi
     return point;
 }
 
+/**
+ * adg_entity_get_memory_stats:
+ * @entity: an #AdgEntity
+ * @n_stats: (out): where to store the number of returned items
+ *
+ * Walks the tree of entities rooted at @entity and computes an estimate
+ * of the memory used by them, one item per #GType. The items are sorted
+ * by decreasing total size, so the most expensive types come first.
+ *
+ * Data shared between entities, such as models referenced by more
+ * strokes or the fill patterns cached by styles, is accounted only
+ * once, by the first entity found using it.
+ *
+ * Returns: (transfer full) (array length=n_stats): a newly allocated array of statistics to be freed with g_free() or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgMemoryStats *
+adg_entity_get_memory_stats(AdgEntity *entity, guint *n_stats)
+{
+    AdgMemoryStats *array;
+    GHashTableIter iter;
+    gpointer stats;
+    guint n;
+
+    g_return_val_if_fail(ADG_IS_ENTITY(entity), NULL);
+    g_return_val_if_fail(n_stats != NULL, NULL);
+
+    *n_stats = 0;
+
+    /* Reports cannot be nested */
+    g_return_val_if_fail(_adg_memory_stats == NULL, NULL);
+
+    _adg_memory_stats = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+    _adg_memory_shared = g_hash_table_new(NULL, NULL);
+
+    adg_entity_account_memory(entity);
+
+    *n_stats = g_hash_table_size(_adg_memory_stats);
+    array = g_new(AdgMemoryStats, *n_stats);
+    n = 0;
+    g_hash_table_iter_init(&iter, _adg_memory_stats);
+    while (g_hash_table_iter_next(&iter, NULL, &stats))
+        array[n++] = * (AdgMemoryStats *) stats;
+
+    qsort(array, n, sizeof(AdgMemoryStats), _adg_compare_memory);
+
+    g_hash_table_destroy(_adg_memory_stats);
+    g_hash_table_destroy(_adg_memory_shared);
+    _adg_memory_stats = NULL;
+    _adg_memory_shared = NULL;
+
+    return array;
+}
+
+/**
+ * adg_entity_account_memory:
+ * @entity: an #AdgEntity
+ *
+ * <note><para>
+ * This function is only useful in entity implementations.
+ * </para></note>
+ *
+ * Accounts the memory used by @entity in the report being built by
+ * adg_entity_get_memory_stats(), by calling its
+ * #AdgEntityClass.memory_size method. Composite entities must call
+ * this function on every entity they own, so the walk can reach it.
+ *
+ * Outside of a report this function does nothing. Any entity is
+ * accounted at most once per report.
+ *
+ * Since: 1.0
+ **/
+void
+adg_entity_account_memory(AdgEntity *entity)
+{
+    AdgEntityClass *klass;
+    AdgMemoryStats *stats;
+    GType type;
+
+    g_return_if_fail(ADG_IS_ENTITY(entity));
+
+    if (_adg_memory_stats == NULL || ! adg_entity_account_shared(entity))
+        return;
+
+    type = G_OBJECT_TYPE(entity);
+    stats = g_hash_table_lookup(_adg_memory_stats, GSIZE_TO_POINTER(type));
+    if (stats == NULL) {
+        stats = g_new0(AdgMemoryStats, 1);
+        stats->type = type;
+        g_hash_table_insert(_adg_memory_stats, GSIZE_TO_POINTER(type), stats);
+    }
+
+    ++stats->n_entities;
+
+    klass = ADG_ENTITY_GET_CLASS(entity);
+    if (klass->memory_size != NULL)
+        klass->memory_size(entity, stats);
+}
+
+/**
+ * adg_entity_account_shared:
+ * @object: the address of a block of data
+ *
+ * <note><para>
+ * This function is only useful in entity implementations.
+ * </para></note>
+ *
+ * Checks if @object must be accounted by the report being built by
+ * adg_entity_get_memory_stats(). Implementations of
+ * #AdgEntityClass.memory_size use this function to account data
+ * shared between entities, e.g. models, only once:
+ *
+ * <informalexample><programlisting language="C">
+ * if (adg_entity_account_shared(trail))
+ *     stats->paths += adg_trail_get_memory_size(trail);
+ * </programlisting></informalexample>
+ *
+ * Returns: <constant>TRUE</constant> the first time @object is checked in the current report, <constant>FALSE</constant> afterward or outside of a report.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_entity_account_shared(gpointer object)
+{
+    if (_adg_memory_shared == NULL || object == NULL ||
+        g_hash_table_contains(_adg_memory_shared, object))
+        return FALSE;
+
+    g_hash_table_add(_adg_memory_shared, object);
+    return TRUE;
+}
+
 
 static void
 _adg_destroy(AdgEntity *entity)
@@ -1237,6 +1619,50 @@ _adg_destroy(AdgEntity *entity)
     g_object_unref(object);
 }
 
+static AdgEntity *
+_adg_clone(AdgEntity *entity)
+{
+    AdgEntityClass *klass, *parent_class;
+    AdgEntityPrivate *data, *clone_data;
+    AdgEntity *clone;
+
+    klass = ADG_ENTITY_GET_CLASS(entity);
+    parent_class = g_type_class_peek_parent(klass);
+
+    if (klass->clone != parent_class->clone) {
+        /* The type of entity has a typed clone method chaining up
+         * here: the properties will be copied by the callers */
+        clone = g_object_new(G_OBJECT_TYPE(entity), NULL);
+    } else {
+        /* Unknown type: copy every property but the ones handled below */
+        clone = (AdgEntity *) _adg_object_clone_except((GObject *) entity,
+                                                       ADG_TYPE_ENTITY);
+    }
+
+    data = adg_entity_get_instance_private(entity);
+    clone_data = adg_entity_get_instance_private(clone);
+
+    clone_data->floating = data->floating;
+    _adg_matrix_copy(&clone_data->global_map, &data->global_map);
+    _adg_matrix_copy(&clone_data->local_map, &data->local_map);
+    clone_data->local_mix = data->local_mix;
+
+    /* Styles are shared, not copied */
+    if (data->hash_styles != NULL) {
+        GHashTableIter iter;
+        gpointer dress, style;
+
+        clone_data->hash_styles = g_hash_table_new_full(NULL, NULL,
+                                                        NULL, g_object_unref);
+        g_hash_table_iter_init(&iter, data->hash_styles);
+        while (g_hash_table_iter_next(&iter, &dress, &style))
+            g_hash_table_insert(clone_data->hash_styles, dress,
+                                g_object_ref(style));
+    }
+
+    return clone;
+}
+
 static void
 _adg_set_parent(AdgEntity *entity, AdgEntity *parent)
 {
@@ -1247,21 +1673,98 @@ _adg_set_parent(AdgEntity *entity, AdgEntity *parent)
     data->global.is_defined = FALSE;
     data->local.is_defined = FALSE;
 
+    /* The styles inherited by the whole subtree can be different */
+    ++_adg_style_generation;
+
+    /* The old parent lost a child, so its extents must be recomputed */
+    if (old_parent != NULL) {
+        AdgEntityPrivate *old_data = adg_entity_get_instance_private(old_parent);
+        if (old_data->pending != NULL)
+            g_ptr_array_remove(old_data->pending, entity);
+        _adg_dirty(old_parent);
+    }
+    _adg_dirty(entity);
+
     g_signal_emit(entity, _adg_signals[PARENT_SET], 0, old_parent);
 }
 
+/* Marks @entity and its ancestors as needing a new arrange phase.
+ * The walk stops at the first entity that is arranging right now:
+ * the child on the path could have been already arranged in that
+ * phase, so it is recorded and checked again when the phase ends. */
+static void
+_adg_dirty(AdgEntity *entity)
+{
+    AdgEntityPrivate *data;
+    AdgEntity *child = NULL;
+
+    while (entity != NULL) {
+        _adg_snapshot_drop(entity);
+        data = adg_entity_get_instance_private(entity);
+        if (data->arranging) {
+            if (child != NULL)
+                _adg_pending_add(entity, child);
+            return;
+        }
+        data->dirty = TRUE;
+        child = entity;
+        entity = data->parent;
+    }
+}
+
+static void
+_adg_pending_add(AdgEntity *entity, AdgEntity *child)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    guint n;
+
+    if (data->pending == NULL)
+        data->pending = g_ptr_array_new();
+
+    for (n = 0; n < data->pending->len; ++n)
+        if (g_ptr_array_index(data->pending, n) == child)
+            return;
+
+    g_ptr_array_add(data->pending, child);
+}
+
+/* Called at the end of the arrange phase of @entity: a child dirtied
+ * during that phase and not arranged again afterwards requires a new
+ * arrange phase, so the dirty state is propagated upward */
+static void
+_adg_pending_check(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    AdgEntityPrivate *child_data;
+    gboolean dirty;
+    guint n;
+
+    dirty = FALSE;
+    for (n = 0; n < data->pending->len; ++n) {
+        child_data = adg_entity_get_instance_private(g_ptr_array_index(data->pending, n));
+        if (child_data->dirty)
+            dirty = TRUE;
+    }
+    g_ptr_array_set_size(data->pending, 0);
+
+    if (dirty)
+        _adg_dirty(entity);
+}
+
 static void
 _adg_global_changed(AdgEntity *entity)
 {
     AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
-    const cairo_matrix_t *map = &data->global_map;
-    cairo_matrix_t *matrix = &data->global.matrix;
+    AdgEntityPrivate *parent_data;
+
+    _adg_dirty(entity);
 
     if (data->parent) {
-        adg_matrix_copy(matrix, adg_entity_get_global_matrix(data->parent));
-        adg_matrix_transform(matrix, map, ADG_TRANSFORM_BEFORE);
+        parent_data = adg_entity_get_instance_private(data->parent);
+        _adg_matrix_compose(&data->global.matrix,
+                            &parent_data->global.matrix, &data->global_map);
     } else {
-        adg_matrix_copy(matrix, map);
+        _adg_matrix_copy(&data->global.matrix, &data->global_map);
     }
 }
 
@@ -1269,49 +1772,51 @@ static void
 _adg_local_changed(AdgEntity *entity)
 {
     AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
-    const cairo_matrix_t *map = &data->local_map;
-    cairo_matrix_t *matrix = &data->local.matrix;
+    AdgCompactMatrix *matrix = &data->local.matrix;
+    const AdgCompactMatrix *map = &data->local_map;
+    AdgEntityPrivate *parent_data;
+
+    _adg_dirty(entity);
+
+    parent_data = data->parent ?
+        adg_entity_get_instance_private(data->parent) : NULL;
 
     switch (data->local_mix) {
     case ADG_MIX_DISABLED:
-        adg_matrix_copy(matrix, adg_matrix_identity());
+        matrix->kind = ADG_MATRIX_IDENTITY;
         break;
     case ADG_MIX_NONE:
-        adg_matrix_copy(matrix, map);
+        _adg_matrix_copy(matrix, map);
         break;
     case ADG_MIX_ANCESTORS:
-        if (data->parent) {
-            adg_matrix_copy(matrix, adg_entity_get_local_matrix(data->parent));
-            adg_matrix_transform(matrix, map, ADG_TRANSFORM_BEFORE);
+        if (parent_data) {
+            _adg_matrix_compose(matrix, &parent_data->local.matrix, map);
         } else {
-            adg_matrix_copy(matrix, map);
+            _adg_matrix_copy(matrix, map);
         }
         break;
     case ADG_MIX_ANCESTORS_NORMALIZED:
-        if (data->parent) {
-            adg_matrix_copy(matrix, adg_entity_get_local_matrix(data->parent));
-            adg_matrix_transform(matrix, map, ADG_TRANSFORM_BEFORE);
+        if (parent_data) {
+            _adg_matrix_compose(matrix, &parent_data->local.matrix, map);
         } else {
-            adg_matrix_copy(matrix, map);
+            _adg_matrix_copy(matrix, map);
         }
-        adg_matrix_normalize(matrix);
+        _adg_matrix_normalize(matrix);
         break;
     case ADG_MIX_PARENT:
-        if (data->parent) {
-            adg_matrix_copy(matrix, adg_entity_get_local_map(data->parent));
-            adg_matrix_transform(matrix, map, ADG_TRANSFORM_BEFORE);
+        if (parent_data) {
+            _adg_matrix_compose(matrix, &parent_data->local_map, map);
         } else {
-            adg_matrix_copy(matrix, map);
+            _adg_matrix_copy(matrix, map);
         }
         break;
     case ADG_MIX_PARENT_NORMALIZED:
-        if (data->parent) {
-            adg_matrix_copy(matrix, adg_entity_get_local_map(data->parent));
-            adg_matrix_transform(matrix, map, ADG_TRANSFORM_BEFORE);
+        if (parent_data) {
+            _adg_matrix_compose(matrix, &parent_data->local_map, map);
         } else {
-            adg_matrix_copy(matrix, map);
+            _adg_matrix_copy(matrix, map);
         }
-        adg_matrix_normalize(matrix);
+        _adg_matrix_normalize(matrix);
         break;
     case ADG_MIX_UNDEFINED:
         g_warning(_("%s: requested to mix the maps using an undefined mix method"),
@@ -1323,6 +1828,166 @@ _adg_local_changed(AdgEntity *entity)
     }
 }
 
+/* Returns the full matrix of @compact: translations are expanded in
+ * the storage of @compact, so the returned pointer stays valid until
+ * the matrix changes */
+static const cairo_matrix_t *
+_adg_matrix_get(AdgCompactMatrix *compact)
+{
+    cairo_matrix_t *storage;
+
+    if (compact->kind != ADG_MATRIX_TRANSLATION)
+        return _adg_matrix_expand(compact, NULL);
+
+    storage = _adg_matrix_storage(compact);
+    cairo_matrix_init_translate(storage, compact->x0, compact->y0);
+    return storage;
+}
+
+/* Same as _adg_matrix_get() but a translation is expanded in @buffer,
+ * so @compact is left untouched */
+static const cairo_matrix_t *
+_adg_matrix_expand(const AdgCompactMatrix *compact, cairo_matrix_t *buffer)
+{
+    switch (compact->kind) {
+    case ADG_MATRIX_NULL:
+        return adg_matrix_null();
+    case ADG_MATRIX_IDENTITY:
+        return adg_matrix_identity();
+    case ADG_MATRIX_TRANSLATION:
+        cairo_matrix_init_translate(buffer, compact->x0, compact->y0);
+        return buffer;
+    default:
+        return compact->storage;
+    }
+}
+
+static void
+_adg_matrix_set(AdgCompactMatrix *compact, const cairo_matrix_t *matrix)
+{
+    cairo_matrix_t *storage;
+
+    g_return_if_fail(matrix != NULL);
+
+    if (matrix->xx == 1 && matrix->yy == 1 &&
+        matrix->xy == 0 && matrix->yx == 0) {
+        _adg_matrix_translation(compact, matrix->x0, matrix->y0);
+        return;
+    }
+
+    /* @matrix can be the storage itself, e.g. from a getter */
+    storage = _adg_matrix_storage(compact);
+    if (storage != matrix)
+        adg_matrix_copy(storage, matrix);
+
+    compact->kind = ADG_MATRIX_GENERIC;
+}
+
+static void
+_adg_matrix_translation(AdgCompactMatrix *compact, gdouble x0, gdouble y0)
+{
+    if (x0 == 0 && y0 == 0) {
+        compact->kind = ADG_MATRIX_IDENTITY;
+        return;
+    }
+
+    compact->kind = ADG_MATRIX_TRANSLATION;
+    compact->x0 = x0;
+    compact->y0 = y0;
+}
+
+/* The storage is taken from the pool the first time it is needed and
+ * kept afterward: the matrices are computed again on every change, so
+ * releasing it would just move the block back and forth */
+static cairo_matrix_t *
+_adg_matrix_storage(AdgCompactMatrix *compact)
+{
+    if (compact->storage == NULL)
+        compact->storage = _adg_pool_alloc(&_adg_matrix_pool);
+
+    return compact->storage;
+}
+
+static void
+_adg_matrix_copy(AdgCompactMatrix *compact, const AdgCompactMatrix *src)
+{
+    switch (src->kind) {
+    case ADG_MATRIX_TRANSLATION:
+        compact->x0 = src->x0;
+        compact->y0 = src->y0;
+        break;
+    case ADG_MATRIX_GENERIC:
+        adg_matrix_copy(_adg_matrix_storage(compact), src->storage);
+        break;
+    default:
+        break;
+    }
+
+    compact->kind = src->kind;
+}
+
+/* Computes @map followed by @parent, that is what
+ * adg_matrix_transform() does with ADG_TRANSFORM_BEFORE, avoiding
+ * the full multiplication when identities or translations are involved */
+static void
+_adg_matrix_compose(AdgCompactMatrix *compact,
+                    const AdgCompactMatrix *parent,
+                    const AdgCompactMatrix *map)
+{
+    cairo_matrix_t p_buffer, m_buffer, result;
+    const cairo_matrix_t *p, *m;
+
+    if (map->kind == ADG_MATRIX_IDENTITY) {
+        _adg_matrix_copy(compact, parent);
+        return;
+    }
+
+    if (parent->kind == ADG_MATRIX_IDENTITY) {
+        _adg_matrix_copy(compact, map);
+        return;
+    }
+
+    if (map->kind == ADG_MATRIX_TRANSLATION &&
+        parent->kind == ADG_MATRIX_TRANSLATION) {
+        _adg_matrix_translation(compact, parent->x0 + map->x0,
+                                parent->y0 + map->y0);
+        return;
+    }
+
+    p = _adg_matrix_expand(parent, &p_buffer);
+    m = _adg_matrix_expand(map, &m_buffer);
+
+    if (map->kind == ADG_MATRIX_TRANSLATION) {
+        /* Translating before @parent just moves its origin */
+        adg_matrix_copy(&result, p);
+        result.x0 += p->xx * m->x0 + p->xy * m->y0;
+        result.y0 += p->yx * m->x0 + p->yy * m->y0;
+    } else if (parent->kind == ADG_MATRIX_TRANSLATION) {
+        adg_matrix_copy(&result, m);
+        result.x0 += p->x0;
+        result.y0 += p->y0;
+    } else {
+        cairo_matrix_multiply(&result, m, p);
+    }
+
+    _adg_matrix_set(compact, &result);
+}
+
+static void
+_adg_matrix_normalize(AdgCompactMatrix *compact)
+{
+    cairo_matrix_t buffer, matrix;
+
+    /* Identities and translations have no scaling component */
+    if (compact->kind == ADG_MATRIX_IDENTITY ||
+        compact->kind == ADG_MATRIX_TRANSLATION)
+        return;
+
+    adg_matrix_copy(&matrix, _adg_matrix_expand(compact, &buffer));
+    adg_matrix_normalize(&matrix);
+    _adg_matrix_set(compact, &matrix);
+}
+
 static void
 _adg_real_invalidate(AdgEntity *entity)
 {
@@ -1335,6 +2000,7 @@ _adg_real_invalidate(AdgEntity *entity)
         klass->invalidate(entity);
 
     data->extents.is_defined = FALSE;
+    _adg_dirty(entity);
 }
 
 static void
@@ -1342,17 +2008,26 @@ _adg_real_arrange(AdgEntity *entity)
 {
     AdgEntityClass *klass = ADG_ENTITY_GET_CLASS(entity);
     AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    gint64 start;
+
+    /* Nothing changed in this subtree since the last arrange phase */
+    if (!data->dirty && data->extents.is_defined)
+        return;
+
+    start = _adg_profiling ? _adg_profile_begin() : -1;
+    data->dirty = FALSE;
+    data->arranging = TRUE;
 
     /* Update the global matrix, if required */
     if (!data->global.is_defined) {
         data->global.is_defined = TRUE;
-        g_signal_emit(entity, _adg_signals[GLOBAL_CHANGED], 0);
+        _adg_emit_global_changed(entity);
     }
 
     /* Update the local matrix, if required */
     if (!data->local.is_defined) {
         data->local.is_defined = TRUE;
-        g_signal_emit(entity, _adg_signals[LOCAL_CHANGED], 0);
+        _adg_emit_local_changed(entity);
     }
 
     /* The arrange() method must be defined */
@@ -1360,16 +2035,24 @@ _adg_real_arrange(AdgEntity *entity)
         g_warning(_("%s: 'arrange' method not implemented for type '%s'"),
                   G_STRLOC, g_type_name(G_OBJECT_TYPE(entity)));
         data->extents.is_defined = FALSE;
-        return;
+    } else {
+        klass->arrange(entity);
     }
 
-    klass->arrange(entity);
+    data->arranging = FALSE;
+
+    if (data->pending != NULL && data->pending->len > 0)
+        _adg_pending_check(entity);
+
+    if (start >= 0)
+        _adg_profile_end(entity, ADG_PROFILE_ARRANGE, start);
 }
 
 static void
 _adg_real_render(AdgEntity *entity, cairo_t *cr)
 {
     AdgEntityClass *klass = ADG_ENTITY_GET_CLASS(entity);
+    gint64 start;
 
     /* The render method must be defined */
     if (klass->render == NULL) {
@@ -1379,12 +2062,18 @@ _adg_real_render(AdgEntity *entity, cairo_t *cr)
     }
 
     /* Before the rendering, the entity should be arranged */
-    g_signal_emit(entity, _adg_signals[ARRANGE], 0);
+    _adg_emit_arrange(entity);
+
+    start = _adg_profiling ? _adg_profile_begin() : -1;
 
     cairo_save(cr);
-    klass->render(entity, cr);
+    if (! _adg_lod_render(entity, cr) && ! _adg_snapshot_render(entity, cr))
+        klass->render(entity, cr);
     cairo_restore(cr);
 
+    if (start >= 0)
+        _adg_profile_end(entity, ADG_PROFILE_RENDER, start);
+
     if (_adg_show_extents) {
         AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
         CpmlExtents *extents = &data->extents;
@@ -1399,3 +2088,419 @@ _adg_real_render(AdgEntity *entity, cairo_t *cr)
         }
     }
 }
+
+/* Gets the render cache of the canvas @entity belongs to, creating it
+ * if needed. Returns NULL if @entity is not in a canvas or if the
+ * canvas has the cache disabled. */
+static AdgRenderCache *
+_adg_render_cache(AdgEntity *entity, guint *budget)
+{
+    AdgEntityPrivate *data;
+    AdgRenderCache *cache;
+
+    for (;;) {
+        data = adg_entity_get_instance_private(entity);
+        if (data->parent == NULL)
+            break;
+        entity = data->parent;
+    }
+
+    if (! ADG_IS_CANVAS(entity))
+        return NULL;
+
+    *budget = adg_canvas_get_cache_budget((AdgCanvas *) entity);
+    cache = g_object_get_qdata((GObject *) entity, _adg_render_cache_quark);
+
+    if (*budget == 0) {
+        /* Release the memory retained by a previously enabled cache */
+        if (cache != NULL)
+            g_object_set_qdata((GObject *) entity,
+                               _adg_render_cache_quark, NULL);
+        return NULL;
+    }
+
+    if (cache == NULL) {
+        cache = g_new(AdgRenderCache, 1);
+        cache->used = 0;
+        g_queue_init(&cache->lru);
+        g_object_set_qdata_full((GObject *) entity, _adg_render_cache_quark,
+                                cache, _adg_render_cache_free);
+    }
+
+    return cache;
+}
+
+static void
+_adg_render_cache_free(gpointer cache)
+{
+    _adg_render_cache_trim(cache, 0);
+    g_free(cache);
+}
+
+/* Releases the least recently used snapshots until @budget is met */
+static void
+_adg_render_cache_trim(AdgRenderCache *cache, guint budget)
+{
+    while (cache->used > budget && cache->lru.tail != NULL)
+        _adg_snapshot_drop(cache->lru.tail->data);
+}
+
+static void
+_adg_snapshot_drop(AdgEntity *entity)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    AdgRenderCache *cache = data->snapshot.cache;
+
+    if (data->snapshot.surface == NULL)
+        return;
+
+    g_queue_unlink(&cache->lru, &data->snapshot.link);
+    cache->used -= data->snapshot.size;
+
+    cairo_surface_destroy(data->snapshot.surface);
+    data->snapshot.surface = NULL;
+    data->snapshot.cache = NULL;
+}
+
+static gboolean
+_adg_is_raster(cairo_t *cr)
+{
+    switch (cairo_surface_get_type(cairo_get_target(cr))) {
+    case CAIRO_SURFACE_TYPE_IMAGE:
+    case CAIRO_SURFACE_TYPE_XLIB:
+    case CAIRO_SURFACE_TYPE_XCB:
+    case CAIRO_SURFACE_TYPE_WIN32:
+    case CAIRO_SURFACE_TYPE_QUARTZ:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+/* Checks the level of detail policy of the canvas @entity belongs to.
+ * Returns TRUE if @entity must be hidden (@proxy set to FALSE) or
+ * rendered with its proxy (@proxy set to TRUE), FALSE if it must be
+ * rendered in the usual way. Only raster targets are considered:
+ * vector outputs are always rendered in full. */
+static gboolean
+_adg_lod_hit(AdgEntity *entity, cairo_t *cr, gboolean *proxy)
+{
+    AdgEntityPrivate *data;
+    AdgEntityClass *klass;
+    AdgCanvas *canvas;
+    CpmlExtents extents;
+    cairo_matrix_t ctm;
+    gdouble proxy_size, hide_size, size;
+
+    data = adg_entity_get_instance_private(entity);
+    if (! data->extents.is_defined || ! _adg_is_raster(cr))
+        return FALSE;
+
+    canvas = adg_entity_get_canvas(entity);
+    if (canvas == NULL || (AdgEntity *) canvas == entity)
+        return FALSE;
+
+    adg_canvas_get_lod_sizes(canvas, &proxy_size, &hide_size);
+    if (proxy_size <= 0 && hide_size <= 0)
+        return FALSE;
+
+    /* Get the size of the entity, in device space */
+    cpml_extents_copy(&extents, &data->extents);
+    cairo_get_matrix(cr, &ctm);
+    cpml_extents_transform(&extents, &ctm);
+    size = MAX(extents.size.x, extents.size.y);
+
+    if (size < hide_size) {
+        *proxy = FALSE;
+        return TRUE;
+    }
+
+    klass = ADG_ENTITY_GET_CLASS(entity);
+    if (size < proxy_size && klass->render_proxy != NULL) {
+        *proxy = TRUE;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/* Applies the level of detail policy: see _adg_lod_hit() */
+static gboolean
+_adg_lod_render(AdgEntity *entity, cairo_t *cr)
+{
+    gboolean proxy;
+
+    if (! _adg_lod_hit(entity, cr, &proxy))
+        return FALSE;
+
+    if (proxy)
+        ADG_ENTITY_GET_CLASS(entity)->render_proxy(entity, cr);
+
+    return TRUE;
+}
+
+/* Returns TRUE if adg_entity_render() would just call the render
+ * method of the (already arranged) @entity: no level of detail,
+ * retained snapshot, profiling or extents overlay is involved.
+ * Used by the containers to decide which children can be batched. */
+gboolean
+_adg_entity_is_plain_render(AdgEntity *entity, cairo_t *cr)
+{
+    AdgEntityPrivate *data;
+    guint budget;
+    gboolean proxy;
+
+    if (_adg_profiling || _adg_show_extents)
+        return FALSE;
+
+    if (_adg_lod_hit(entity, cr, &proxy))
+        return FALSE;
+
+    data = adg_entity_get_instance_private(entity);
+    return _adg_snapshot_depth > 0 || ADG_IS_CONTAINER(entity) ||
+           ! data->extents.is_defined || ! _adg_is_raster(cr) ||
+           _adg_render_cache(entity, &budget) == NULL;
+}
+
+/* Paints @entity on @cr from its retained snapshot, building the
+ * snapshot if required. Returns FALSE if the entity must be rendered
+ * in the usual way. Containers are never retained (their children
+ * are) and entities rendered while building a snapshot are drawn
+ * straight into it, so the retained output is never duplicated. */
+static gboolean
+_adg_snapshot_render(AdgEntity *entity, cairo_t *cr)
+{
+    AdgEntityClass *klass;
+    AdgEntityPrivate *data;
+    AdgRenderCache *cache;
+    cairo_matrix_t ctm;
+    guint budget, serial;
+
+    data = adg_entity_get_instance_private(entity);
+
+    if (_adg_snapshot_depth > 0 || ADG_IS_CONTAINER(entity) ||
+        ! data->extents.is_defined || ! _adg_is_raster(cr))
+        return FALSE;
+
+    cache = _adg_render_cache(entity, &budget);
+    cairo_get_matrix(cr, &ctm);
+
+    /* All the counters only grow, so their sum changes whenever one does */
+    serial = _adg_snapshot_serial + adg_dress_get_generation() +
+             _adg_style_get_serial();
+
+    if (data->snapshot.surface != NULL &&
+        (data->snapshot.cache != cache ||
+         data->snapshot.serial != serial ||
+         ! adg_matrix_equal(&data->snapshot.ctm, &ctm)))
+        _adg_snapshot_drop(entity);
+
+    if (cache == NULL)
+        return FALSE;
+
+    if (_adg_profiling)
+        _adg_profile_cache(entity, data->snapshot.surface != NULL);
+
+    if (data->snapshot.surface != NULL) {
+        /* Move the snapshot on top of the LRU list */
+        g_queue_unlink(&cache->lru, &data->snapshot.link);
+        g_queue_push_head_link(&cache->lru, &data->snapshot.link);
+    }
+
+    _adg_render_cache_trim(cache, budget);
+
+    if (data->snapshot.surface == NULL) {
+        CpmlExtents extents;
+        cairo_surface_t *surface;
+        cairo_t *snapshot_cr;
+        gdouble sx, sy;
+        gint x, y, width, height, stride;
+
+        sx = sy = 1;
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 14, 0)
+        cairo_surface_get_device_scale(cairo_get_target(cr), &sx, &sy);
+#endif
+
+        /* Get the area covered by the entity, in device space */
+        cpml_extents_copy(&extents, &data->extents);
+        extents.org.x -= _ADG_SNAPSHOT_MARGIN;
+        extents.org.y -= _ADG_SNAPSHOT_MARGIN;
+        extents.size.x += _ADG_SNAPSHOT_MARGIN * 2;
+        extents.size.y += _ADG_SNAPSHOT_MARGIN * 2;
+        cpml_extents_transform(&extents, &ctm);
+
+        x = floor(extents.org.x * sx);
+        y = floor(extents.org.y * sy);
+        width = ceil((extents.org.x + extents.size.x) * sx) - x;
+        height = ceil((extents.org.y + extents.size.y) * sy) - y;
+        stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+
+        if (width <= 0 || height <= 0 || stride <= 0 ||
+            (guint64) stride * height > budget)
+            return FALSE;
+
+        surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32,
+                                             width, height);
+        cairo_surface_set_device_scale(surface, sx, sy);
+        snapshot_cr = cairo_create(surface);
+        cairo_translate(snapshot_cr, -x / sx, -y / sy);
+        cairo_transform(snapshot_cr, &ctm);
+
+        klass = ADG_ENTITY_GET_CLASS(entity);
+        ++_adg_snapshot_depth;
+        klass->render(entity, snapshot_cr);
+        --_adg_snapshot_depth;
+
+        if (cairo_status(snapshot_cr) != CAIRO_STATUS_SUCCESS) {
+            cairo_destroy(snapshot_cr);
+            cairo_surface_destroy(surface);
+            return FALSE;
+        }
+
+        cairo_destroy(snapshot_cr);
+
+        data->snapshot.surface = surface;
+        adg_matrix_copy(&data->snapshot.ctm, &ctm);
+        data->snapshot.x = x / sx;
+        data->snapshot.y = y / sy;
+        data->snapshot.size = stride * height;
+        data->snapshot.serial = serial;
+        data->snapshot.cache = cache;
+
+        g_queue_push_head_link(&cache->lru, &data->snapshot.link);
+        cache->used += data->snapshot.size;
+        _adg_render_cache_trim(cache, budget);
+    }
+
+    cairo_identity_matrix(cr);
+    cairo_set_source_surface(cr, data->snapshot.surface,
+                             data->snapshot.x, data->snapshot.y);
+    cairo_paint(cr);
+
+    return TRUE;
+}
+
+/* The following functions are fast paths for the most frequently
+ * emitted signals: when no handler is connected, the class closure
+ * is called directly, skipping the whole signal machinery */
+
+static void
+_adg_emit_global_changed(AdgEntity *entity)
+{
+    AdgEntityClass *klass;
+    guint event;
+
+    event = _adg_tracing ? _adg_trace_begin(entity, "global-changed") : G_MAXUINT;
+
+    if (g_signal_has_handler_pending(entity, _adg_signals[GLOBAL_CHANGED], 0, FALSE)) {
+        g_signal_emit(entity, _adg_signals[GLOBAL_CHANGED], 0);
+    } else {
+        klass = ADG_ENTITY_GET_CLASS(entity);
+        if (klass->global_changed)
+            klass->global_changed(entity);
+    }
+
+    if (event != G_MAXUINT)
+        _adg_trace_end(event);
+}
+
+static void
+_adg_emit_local_changed(AdgEntity *entity)
+{
+    AdgEntityClass *klass;
+    guint event;
+
+    event = _adg_tracing ? _adg_trace_begin(entity, "local-changed") : G_MAXUINT;
+
+    if (g_signal_has_handler_pending(entity, _adg_signals[LOCAL_CHANGED], 0, FALSE)) {
+        g_signal_emit(entity, _adg_signals[LOCAL_CHANGED], 0);
+    } else {
+        klass = ADG_ENTITY_GET_CLASS(entity);
+        if (klass->local_changed)
+            klass->local_changed(entity);
+    }
+
+    if (event != G_MAXUINT)
+        _adg_trace_end(event);
+}
+
+static void
+_adg_emit_invalidate(AdgEntity *entity)
+{
+    guint event;
+
+    event = _adg_tracing ? _adg_trace_begin(entity, "invalidate") : G_MAXUINT;
+
+    if (g_signal_has_handler_pending(entity, _adg_signals[INVALIDATE], 0, FALSE))
+        g_signal_emit(entity, _adg_signals[INVALIDATE], 0);
+    else
+        _adg_real_invalidate(entity);
+
+    if (event != G_MAXUINT)
+        _adg_trace_end(event);
+}
+
+static void
+_adg_emit_arrange(AdgEntity *entity)
+{
+    if (g_signal_has_handler_pending(entity, _adg_signals[ARRANGE], 0, FALSE))
+        g_signal_emit(entity, _adg_signals[ARRANGE], 0);
+    else
+        _adg_real_arrange(entity);
+}
+
+static void
+_adg_emit_render(AdgEntity *entity, cairo_t *cr)
+{
+    if (g_signal_has_handler_pending(entity, _adg_signals[RENDER], 0, FALSE))
+        g_signal_emit(entity, _adg_signals[RENDER], 0, cr);
+    else
+        _adg_real_render(entity, cr);
+}
+
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgEntityPrivate *data = adg_entity_get_instance_private(entity);
+    GTypeQuery query;
+
+    /* The private data is allocated just before the instance, so
+     * its size is the (negative) offset of the private struct */
+    g_type_query(G_OBJECT_TYPE(entity), &query);
+    stats->instance += query.instance_size -
+        g_type_class_get_instance_private_offset(ADG_ENTITY_GET_CLASS(entity));
+
+    /* Matrices stored out of line */
+    if (data->global_map.storage != NULL)
+        stats->instance += sizeof(cairo_matrix_t);
+    if (data->local_map.storage != NULL)
+        stats->instance += sizeof(cairo_matrix_t);
+    if (data->global.matrix.storage != NULL)
+        stats->instance += sizeof(cairo_matrix_t);
+    if (data->local.matrix.storage != NULL)
+        stats->instance += sizeof(cairo_matrix_t);
+
+    if (data->snapshot.surface != NULL)
+        stats->snapshots += data->snapshot.size;
+}
+
+static gsize
+_adg_memory_total(const AdgMemoryStats *stats)
+{
+    return stats->instance + stats->paths + stats->text +
+           stats->patterns + stats->snapshots;
+}
+
+static int
+_adg_compare_memory(gconstpointer p1, gconstpointer p2)
+{
+    gsize total1 = _adg_memory_total(p1);
+    gsize total2 = _adg_memory_total(p2);
+
+    if (total1 > total2)
+        return -1;
+    else if (total1 < total2)
+        return 1;
+
+    return 0;
+}
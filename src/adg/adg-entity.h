@@ -39,12 +39,23 @@ G_BEGIN_DECLS
 
 typedef struct _AdgEntity       AdgEntity;
 typedef struct _AdgEntityClass  AdgEntityClass;
+typedef struct _AdgMemoryStats  AdgMemoryStats;
 
 struct _AdgEntity {
     /*< private >*/
     GInitiallyUnowned   parent;
 };
 
+struct _AdgMemoryStats {
+    GType       type;
+    guint       n_entities;
+    gsize       instance;
+    gsize       paths;
+    gsize       text;
+    gsize       patterns;
+    gsize       snapshots;
+};
+
 struct _AdgEntityClass {
     /*< private >*/
     GInitiallyUnownedClass
@@ -60,6 +71,13 @@ struct _AdgEntityClass {
     void                (*arrange)              (AdgEntity       *entity);
     void                (*render)               (AdgEntity       *entity,
                                                  cairo_t         *cr);
+
+    /* Virtual table */
+    void                (*render_proxy)         (AdgEntity       *entity,
+                                                 cairo_t         *cr);
+    void                (*memory_size)          (AdgEntity       *entity,
+                                                 AdgMemoryStats  *stats);
+    AdgEntity *         (*clone)                (AdgEntity       *entity);
 };
 
 
@@ -67,6 +85,7 @@ void            adg_switch_extents              (gboolean         state);
 
 GType           adg_entity_get_type             (void);
 void            adg_entity_destroy              (AdgEntity       *entity);
+AdgEntity *     adg_entity_clone                (AdgEntity       *entity);
 void            adg_entity_switch_floating      (AdgEntity       *entity,
                                                  gboolean         new_state);
 gboolean        adg_entity_has_floating         (AdgEntity       *entity);
@@ -112,12 +131,17 @@ void            adg_entity_apply_dress          (AdgEntity       *entity,
 void            adg_entity_global_changed       (AdgEntity       *entity);
 void            adg_entity_local_changed        (AdgEntity       *entity);
 void            adg_entity_invalidate           (AdgEntity       *entity);
+void            adg_entity_mark_dirty           (AdgEntity       *entity);
 void            adg_entity_arrange              (AdgEntity       *entity);
 void            adg_entity_render               (AdgEntity       *entity,
                                                  cairo_t         *cr);
 AdgPoint *      adg_entity_point                (AdgEntity       *entity,
                                                  AdgPoint        *point,
                                                  const AdgPoint  *new_point);
+AdgMemoryStats *adg_entity_get_memory_stats     (AdgEntity       *entity,
+                                                 guint           *n_stats);
+void            adg_entity_account_memory       (AdgEntity       *entity);
+gboolean        adg_entity_account_shared       (gpointer         object);
 
 G_END_DECLS
 
@@ -48,6 +48,7 @@
 
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_font_style_parent_class)
+#define _ADG_OLD_STYLE_CLASS   ((AdgStyleClass *) adg_font_style_parent_class)
 
 
 G_DEFINE_TYPE_WITH_PRIVATE(AdgFontStyle, adg_font_style, ADG_TYPE_STYLE)
@@ -74,6 +75,7 @@ static void             _adg_set_property       (GObject        *object,
                                                  guint           prop_id,
                                                  const GValue   *value,
                                                  GParamSpec     *pspec);
+static AdgStyle *       _adg_clone              (AdgStyle       *style);
 static void             _adg_invalidate         (AdgStyle       *style);
 static void             _adg_apply              (AdgStyle       *style,
                                                  AdgEntity      *entity,
@@ -93,6 +95,7 @@ adg_font_style_class_init(AdgFontStyleClass *klass)
     gobject_class->get_property = _adg_get_property;
     gobject_class->set_property = _adg_set_property;
 
+    style_class->clone = _adg_clone;
     style_class->invalidate = _adg_invalidate;
     style_class->apply = _adg_apply;
 
@@ -229,6 +232,7 @@ _adg_set_property(GObject *object, guint prop_id,
     switch (prop_id) {
     case PROP_COLOR_DRESS:
         data->color_dress = g_value_get_enum(value);
+        adg_style_invalidate(style);
         break;
     case PROP_FAMILY:
         g_free(data->family);
@@ -734,6 +738,29 @@ adg_font_style_get_hint_metrics(AdgFontStyle *font_style)
 }
 
 
+static AdgStyle *
+_adg_clone(AdgStyle *style)
+{
+    AdgStyle *clone = _ADG_OLD_STYLE_CLASS->clone(style);
+    AdgFontStylePrivate *data = adg_font_style_get_instance_private((AdgFontStyle *) style);
+    AdgFontStylePrivate *clone_data = adg_font_style_get_instance_private((AdgFontStyle *) clone);
+
+    /* The cairo font caches are not copied: the clone
+     * will rebuild them on demand */
+    clone_data->color_dress = data->color_dress;
+    g_free(clone_data->family);
+    clone_data->family = g_strdup(data->family);
+    clone_data->slant = data->slant;
+    clone_data->weight = data->weight;
+    clone_data->size = data->size;
+    clone_data->antialias = data->antialias;
+    clone_data->subpixel_order = data->subpixel_order;
+    clone_data->hint_style = data->hint_style;
+    clone_data->hint_metrics = data->hint_metrics;
+
+    return clone;
+}
+
 static void
 _adg_invalidate(AdgStyle *style)
 {
@@ -50,6 +50,8 @@
 #include "adg-hatch.h"
 #include "adg-hatch-private.h"
 
+#define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_hatch_parent_class)
+
 
 G_DEFINE_TYPE_WITH_PRIVATE(AdgHatch, adg_hatch, ADG_TYPE_STROKE)
 
@@ -69,6 +71,11 @@ static void             _adg_set_property       (GObject        *object,
                                                  GParamSpec     *pspec);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_memory_size        (AdgEntity      *entity,
+                                                 AdgMemoryStats *stats);
+static AdgEntity *      _adg_clone              (AdgEntity      *entity);
+static void             _adg_render_proxy       (AdgEntity      *entity,
+                                                 cairo_t        *cr);
 
 
 static void
@@ -85,6 +92,9 @@ adg_hatch_class_init(AdgHatchClass *klass)
     gobject_class->set_property = _adg_set_property;
 
     entity_class->render = _adg_render;
+    entity_class->render_proxy = _adg_render_proxy;
+    entity_class->memory_size = _adg_memory_size;
+    entity_class->clone = _adg_clone;
 
     param = adg_param_spec_dress("fill-dress",
                                  P_("Fill Dress"),
@@ -130,8 +140,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -222,3 +234,64 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
         cairo_fill(cr);
     }
 }
+
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgHatchPrivate *data = adg_hatch_get_instance_private((AdgHatch *) entity);
+    AdgStyle *style;
+    cairo_pattern_t *pattern;
+    cairo_surface_t *surface;
+
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    /* The pattern is cached by the fill style, possibly shared
+     * between more hatches: only image surfaces are accounted */
+    style = adg_entity_style(entity, data->fill_dress);
+    if (! ADG_IS_FILL_STYLE(style) || ! adg_entity_account_shared(style))
+        return;
+
+    pattern = adg_fill_style_get_pattern((AdgFillStyle *) style);
+    if (pattern != NULL &&
+        cairo_pattern_get_surface(pattern, &surface) == CAIRO_STATUS_SUCCESS &&
+        cairo_surface_get_type(surface) == CAIRO_SURFACE_TYPE_IMAGE)
+        stats->patterns += cairo_image_surface_get_stride(surface) *
+                           cairo_image_surface_get_height(surface);
+}
+
+static AdgEntity *
+_adg_clone(AdgEntity *entity)
+{
+    AdgHatchPrivate *data, *clone_data;
+    AdgEntity *clone;
+
+    clone = _ADG_OLD_ENTITY_CLASS->clone(entity);
+    data = adg_hatch_get_instance_private((AdgHatch *) entity);
+    clone_data = adg_hatch_get_instance_private((AdgHatch *) clone);
+
+    clone_data->fill_dress = data->fill_dress;
+
+    return clone;
+}
+
+/* Hatch too small to show its pattern: fill the area with a tint of
+ * the fill color, roughly matching the average ink of the lines */
+static void
+_adg_render_proxy(AdgEntity *entity, cairo_t *cr)
+{
+    AdgTrail *trail = adg_stroke_get_trail((AdgStroke *) entity);
+    const cairo_path_t *cairo_path = adg_trail_get_cairo_path(trail);
+
+    if (cairo_path != NULL) {
+        cairo_save(cr);
+        cairo_transform(cr, adg_entity_get_global_matrix(entity));
+        cairo_transform(cr, adg_entity_get_local_matrix(entity));
+        cairo_append_path(cr, cairo_path);
+        cairo_restore(cr);
+
+        cairo_clip(cr);
+        adg_entity_apply_dress(entity, ADG_DRESS_COLOR_FILL, cr);
+        cairo_paint_with_alpha(cr, 0.25);
+    }
+}
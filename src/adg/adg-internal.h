@@ -92,5 +92,28 @@ const gchar *           _adg_dpgettext  (const gchar *domain,
                                          const gchar *msgctxtid,
                                          gsize        msgidoffset) G_GNUC_FORMAT(2);
 
+/* Same as adg_object_clone() but skips the properties installed by
+ * owner_type: used by the typed clone methods to copy those
+ * properties directly */
+GObject *               _adg_object_clone_except(GObject     *src,
+                                                 GType        owner_type);
+
+/* Bumped whenever a style is invalidated: used to drop the
+ * renderings retained with the old style settings */
+guint                   _adg_style_get_serial   (void);
+
+/* TRUE if rendering @entity would just call its render method,
+ * that is no per-entity rendering feature is involved */
+gboolean                _adg_entity_is_plain_render
+                                                (AdgEntity   *entity,
+                                                 cairo_t     *cr);
+
+/* Records the line or color @style applied by @entity on @cr, so the
+ * container being rendered on @cr can share it with the next children */
+void                    _adg_container_track_style
+                                                (AdgStyle    *style,
+                                                 AdgEntity   *entity,
+                                                 cairo_t     *cr);
+
 
 #endif /* __ADG_INTERNAL_H__ */
@@ -48,6 +48,9 @@
 #include "adg-line-style-private.h"
 
 
+#define _ADG_OLD_STYLE_CLASS   ((AdgStyleClass *) adg_line_style_parent_class)
+
+
 G_DEFINE_TYPE_WITH_PRIVATE(AdgLineStyle, adg_line_style, ADG_TYPE_STYLE)
 
 enum {
@@ -72,9 +75,12 @@ static void             _adg_set_property       (GObject        *object,
                                                  GParamSpec     *pspec);
 static gboolean         _adg_change_dash        (AdgLineStyle   *style,
                                                  const AdgDash  *dash);
+static AdgStyle *       _adg_clone              (AdgStyle       *style);
 static void             _adg_apply              (AdgStyle       *style,
                                                  AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_apply_dash         (const AdgDash  *dash,
+                                                 cairo_t        *cr);
 
 
 static void
@@ -90,6 +96,7 @@ adg_line_style_class_init(AdgLineStyleClass *klass)
     gobject_class->get_property = _adg_get_property;
     gobject_class->set_property = _adg_set_property;
 
+    style_class->clone = _adg_clone;
     style_class->apply = _adg_apply;
 
     param = adg_param_spec_dress("color-dress",
@@ -218,8 +225,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_style_invalidate((AdgStyle *) object);
 }
 
 
@@ -583,22 +592,74 @@ _adg_change_dash(AdgLineStyle *line_style, const AdgDash *dash)
     return TRUE;
 }
 
+static AdgStyle *
+_adg_clone(AdgStyle *style)
+{
+    AdgStyle *clone = _ADG_OLD_STYLE_CLASS->clone(style);
+    AdgLineStylePrivate *data = adg_line_style_get_instance_private((AdgLineStyle *) style);
+    AdgLineStylePrivate *clone_data = adg_line_style_get_instance_private((AdgLineStyle *) clone);
+
+    clone_data->color_dress = data->color_dress;
+    clone_data->width = data->width;
+    clone_data->cap = data->cap;
+    clone_data->join = data->join;
+    clone_data->miter_limit = data->miter_limit;
+    clone_data->antialias = data->antialias;
+    _adg_change_dash((AdgLineStyle *) clone, data->dash);
+
+    return clone;
+}
+
 static void
 _adg_apply(AdgStyle *style, AdgEntity *entity, cairo_t *cr)
 {
     AdgLineStylePrivate *data = adg_line_style_get_instance_private((AdgLineStyle *) style);
 
     adg_entity_apply_dress(entity, data->color_dress, cr);
-    cairo_set_line_width(cr, data->width);
-    cairo_set_line_cap(cr, data->cap);
-    cairo_set_line_join(cr, data->join);
-    cairo_set_miter_limit(cr, data->miter_limit);
-    cairo_set_antialias(cr, data->antialias);
+    _adg_container_track_style(style, entity, cr);
+
+    /* Skip redundant changes: the same line style is usually applied
+     * many times in a row and the containers keep it on the cairo
+     * context between their children (see AdgContainer) */
+    if (cairo_get_line_width(cr) != data->width)
+        cairo_set_line_width(cr, data->width);
+    if (cairo_get_line_cap(cr) != data->cap)
+        cairo_set_line_cap(cr, data->cap);
+    if (cairo_get_line_join(cr) != data->join)
+        cairo_set_line_join(cr, data->join);
+    if (cairo_get_miter_limit(cr) != data->miter_limit)
+        cairo_set_miter_limit(cr, data->miter_limit);
+    if (cairo_get_antialias(cr) != data->antialias)
+        cairo_set_antialias(cr, data->antialias);
+
+    /* A dash left by a previous style must be reset */
+    if (data->dash != NULL)
+        _adg_apply_dash(data->dash, cr);
+    else if (cairo_get_dash_count(cr) > 0)
+        cairo_set_dash(cr, NULL, 0, 0);
+}
 
-    if (data->dash != NULL) {
-        cairo_set_dash(cr,
-                       adg_dash_get_dashes(data->dash),
-                       adg_dash_get_num_dashes(data->dash),
-                       adg_dash_get_offset(data->dash));
+static void
+_adg_apply_dash(const AdgDash *dash, cairo_t *cr)
+{
+    const gdouble *dashes = adg_dash_get_dashes(dash);
+    gint num_dashes = adg_dash_get_num_dashes(dash);
+    gdouble offset = adg_dash_get_offset(dash);
+
+    if (cairo_get_dash_count(cr) == num_dashes) {
+        gdouble *current = g_newa(gdouble, num_dashes + 1);
+        gdouble current_offset;
+        gint n;
+
+        cairo_get_dash(cr, current, &current_offset);
+
+        for (n = 0; n < num_dashes; ++n)
+            if (current[n] != dashes[n])
+                break;
+
+        if (n == num_dashes && current_offset == offset)
+            return;
     }
+
+    cairo_set_dash(cr, dashes, num_dashes, offset);
 }
@@ -104,6 +104,8 @@ static void             _adg_set_property       (GObject        *object,
                                                  GParamSpec     *pspec);
 static void             _adg_local_changed      (AdgEntity      *entity);
 static void             _adg_invalidate         (AdgEntity      *entity);
+static void             _adg_memory_size        (AdgEntity      *entity,
+                                                 AdgMemoryStats *stats);
 static void             _adg_clear_trail        (AdgMarker      *marker);
 static gboolean         _adg_set_segment        (AdgMarker      *marker,
                                                  AdgTrail       *trail,
@@ -127,6 +129,7 @@ adg_marker_class_init(AdgMarkerClass *klass)
 
     entity_class->local_changed = _adg_local_changed;
     entity_class->invalidate = _adg_invalidate;
+    entity_class->memory_size = _adg_memory_size;
 
     klass->create_model = _adg_create_model;
 
@@ -254,8 +257,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -681,6 +686,24 @@ _adg_invalidate(AdgEntity *entity)
     adg_marker_set_model((AdgMarker *) entity, NULL);
 }
 
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgMarkerPrivate *data = adg_marker_get_instance_private((AdgMarker *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    /* The trail belongs to the dimension, while the model is owned
+     * by the marker even if implementations could share it */
+    if (ADG_IS_TRAIL(data->model) && adg_entity_account_shared(data->model))
+        stats->paths += adg_trail_get_memory_size((AdgTrail *) data->model);
+
+    if (data->backup_segment != NULL)
+        stats->paths += sizeof(CpmlSegment) +
+                        data->backup_segment->num_data * sizeof(cairo_path_data_t);
+}
+
 
 static void
 _adg_clear_trail(AdgMarker *marker)
@@ -25,17 +25,37 @@
 G_BEGIN_DECLS
 
 typedef struct _AdgModelPrivate  AdgModelPrivate;
-typedef struct _AdgWrapperHelper AdgWrapperHelper;
+typedef struct _AdgNamedEntry    AdgNamedEntry;
+typedef struct _AdgDependency    AdgDependency;
 
-struct _AdgModelPrivate {
-    GSList     *dependencies;
-    GHashTable *named_pairs;
+struct _AdgNamedEntry {
+    GQuark       name;
+    CpmlPair     pair;
+};
+
+/* An entity can be added more than once (e.g. when more points of
+ * the same entity refer to the same model): it is kept only once in
+ * the list and the number of references held is tracked by count */
+struct _AdgDependency {
+    GSList      *link;
+    guint        count;
 };
 
-struct _AdgWrapperHelper {
-    AdgNamedPairFunc callback;
-    AdgModel        *model;
-    gpointer         user_data;
+struct _AdgModelPrivate {
+    GSList      *dependencies;
+    GHashTable  *dependency_table;
+
+    /* Named pairs are kept in a dense array (in insertion order)
+     * indexed by an open addressing table of (entry index + 1)
+     * values, where 0 marks an empty slot */
+    struct {
+        AdgNamedEntry   *entries;
+        guint            n_entries;
+        guint            n_allocated;
+        guint           *slots;
+        guint            n_slots;
+        guint            generation;
+    }            named_pairs;
 };
 
 G_END_DECLS
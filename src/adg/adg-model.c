@@ -63,20 +63,23 @@
  * @add_dependency:    signal for adding a new dependency.
  * @remove_dependency: signal used to remove an old dependency.
  * @changed:           signal for emitting an #AdgModel::changed signal.
+ * @clone:             virtual method that duplicates a model.
  *
  *
  * The default @named_pair implementation looks up the #CpmlPair in an internal
- * #GHashTable that uses the pair name as key and the #CpmlPair struct as value.
+ * open addressing table that uses the #GQuark of the pair name as key and
+ * stores the #CpmlPair struct inline.
  *
  * The default @set_named_pair implementation can be used for either adding
  * (if the #CpmlPair is not <constant>NULL</constant>) or removing (if #CpmlPair
- * is <constant>NULL</constant>) an item from the named pairs hash table.
+ * is <constant>NULL</constant>) an item from the named pairs table.
  *
  * The default handler for @clear signals does not do anything.
  *
  * The default @reset involves the clearing of the internal cache data
- * (done by emitting the #AdgModel::clear signal) and the destruction of the
- * internal named pair hash table.
+ * (done by emitting the #AdgModel::clear signal) and the removal of all
+ * the named pairs. The memory of the named pair table is retained, so
+ * redefining a model with the same names does not allocate anything.
  *
  * The default @add_dependency and @remove_dependency implementations add and
  * remove items from an internal #GSList of #AdgEntity.
@@ -84,6 +87,9 @@
  * The default handler of the @changed signal calls adg_entity_invalidate()
  * on every dependency by using adg_model_foreach_dependency().
  *
+ * The default @clone copies the named pairs and, when the class does
+ * not override it, the readable and writable properties.
+ *
  * Since: 1.0
  **/
 
@@ -115,10 +121,17 @@
 
 #include "adg-model.h"
 #include "adg-model-private.h"
+#include "adg-profile.h"
+#include "adg-profile-private.h"
+
+#include <string.h>
 
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_model_parent_class)
 
+/* Fibonacci hashing: quarks are small sequential integers */
+#define _ADG_NAMED_HASH(name, mask)  (((guint) (name) * 2654435769U) & (mask))
+
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE(AdgModel, adg_model, G_TYPE_OBJECT)
 
@@ -139,6 +152,7 @@ enum {
 
 
 static void             _adg_dispose            (GObject        *object);
+static void             _adg_finalize           (GObject        *object);
 static void             _adg_set_property       (GObject        *object,
                                                  guint           prop_id,
                                                  const GValue   *value,
@@ -147,16 +161,32 @@ static void             _adg_add_dependency     (AdgModel       *model,
                                                  AdgEntity      *entity);
 static void             _adg_remove_dependency  (AdgModel       *model,
                                                  AdgEntity      *entity);
+static gboolean         _adg_release_dependencies
+                                                (AdgModel       *model);
 static const CpmlPair * _adg_named_pair         (AdgModel       *model,
                                                  const gchar    *name);
+static AdgModel *       _adg_clone              (AdgModel       *model);
 static void             _adg_reset              (AdgModel       *model);
 static void             _adg_set_named_pair     (AdgModel       *model,
                                                  const gchar    *name,
                                                  const CpmlPair *pair);
 static void             _adg_changed            (AdgModel       *model);
-static void             _adg_named_pair_wrapper (gpointer        key,
-                                                 gpointer        value,
-                                                 gpointer        user_data);
+static guint            _adg_named_slot         (const AdgModelPrivate
+                                                                *data,
+                                                 GQuark          name);
+static AdgNamedEntry *  _adg_named_lookup       (AdgModelPrivate
+                                                                *data,
+                                                 GQuark          name);
+static void             _adg_named_rehash       (AdgModelPrivate
+                                                                *data,
+                                                 guint           n_slots);
+static void             _adg_named_insert       (AdgModelPrivate
+                                                                *data,
+                                                 GQuark          name,
+                                                 const CpmlPair *pair);
+static gboolean         _adg_named_remove       (AdgModelPrivate
+                                                                *data,
+                                                 GQuark          name);
 static void             _adg_invalidate_wrapper (AdgModel       *model,
                                                  AdgEntity      *entity,
                                                  gpointer        user_data);
@@ -172,11 +202,13 @@ adg_model_class_init(AdgModelClass *klass)
     gobject_class = (GObjectClass *) klass;
 
     gobject_class->dispose = _adg_dispose;
+    gobject_class->finalize = _adg_finalize;
     gobject_class->set_property = _adg_set_property;
 
     klass->add_dependency = _adg_add_dependency;
     klass->remove_dependency = _adg_remove_dependency;
     klass->named_pair = _adg_named_pair;
+    klass->clone = _adg_clone;
     klass->set_named_pair = _adg_set_named_pair;
     klass->clear = NULL;
     klass->reset = _adg_reset;
@@ -329,6 +361,13 @@ adg_model_init(AdgModel *model)
 {
     AdgModelPrivate *data = adg_model_get_instance_private(model);
     data->dependencies = NULL;
+    data->dependency_table = NULL;
+    data->named_pairs.entries = NULL;
+    data->named_pairs.n_entries = 0;
+    data->named_pairs.n_allocated = 0;
+    data->named_pairs.slots = NULL;
+    data->named_pairs.n_slots = 0;
+    data->named_pairs.generation = 1;
 }
 
 static void
@@ -341,12 +380,14 @@ _adg_dispose(GObject *object)
         AdgModelPrivate *data = adg_model_get_instance_private(model);
         AdgEntity *entity;
 
-        /* Remove all the dependencies: this will emit a
-         * "remove-dependency" signal for every dependency, dropping
-         * all references from entities to this model */
-        while (data->dependencies != NULL) {
-            entity = (AdgEntity *) data->dependencies->data;
-            adg_model_remove_dependency(model, entity);
+        /* Remove all the dependencies: if nobody is interested in
+         * the "remove-dependency" signal they are released in bulk,
+         * otherwise the signal is emitted for every dependency */
+        if (! _adg_release_dependencies(model)) {
+            while (data->dependencies != NULL) {
+                entity = (AdgEntity *) data->dependencies->data;
+                adg_model_remove_dependency(model, entity);
+            }
         }
 
         g_signal_emit(model, _adg_signals[RESET], 0);
@@ -356,6 +397,20 @@ _adg_dispose(GObject *object)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
 }
 
+static void
+_adg_finalize(GObject *object)
+{
+    AdgModelPrivate *data = adg_model_get_instance_private((AdgModel *) object);
+
+    if (data->dependency_table != NULL)
+        g_hash_table_destroy(data->dependency_table);
+    g_free(data->named_pairs.entries);
+    g_free(data->named_pairs.slots);
+
+    if (_ADG_OLD_OBJECT_CLASS->finalize)
+        _ADG_OLD_OBJECT_CLASS->finalize(object);
+}
+
 static void
 _adg_set_property(GObject *object, guint prop_id,
                   const GValue *value, GParamSpec *pspec)
@@ -371,6 +426,36 @@ _adg_set_property(GObject *object, guint prop_id,
 }
 
 
+/**
+ * adg_model_clone:
+ * @model: an #AdgModel
+ *
+ * Creates a new model of the same type of @model with the same
+ * data, named pairs included. The dependencies are not cloned.
+ *
+ * The core models copy their data directly. Models that do not
+ * provide their own #AdgModelClass.clone method are cloned by
+ * copying their readable and writable properties.
+ *
+ * Returns: (transfer full): the newly created model or <constant>NULL</constant> on errors.
+ *
+ * Since: 1.0
+ **/
+AdgModel *
+adg_model_clone(AdgModel *model)
+{
+    AdgModelClass *klass;
+
+    g_return_val_if_fail(ADG_IS_MODEL(model), NULL);
+
+    klass = ADG_MODEL_GET_CLASS(model);
+
+    if (klass->clone == NULL)
+        return NULL;
+
+    return klass->clone(model);
+}
+
 /**
  * adg_model_add_dependency:
  * @model: an #AdgModel
@@ -533,6 +618,48 @@ adg_model_set_named_pair_explicit(AdgModel *model, const gchar *name,
     adg_model_set_named_pair(model, name, &pair);
 }
 
+/**
+ * adg_model_set_named_pair_quark:
+ * @model: an #AdgModel
+ * @name: the #GQuark of the name to associate to the pair
+ * @pair: the #CpmlPair
+ *
+ * Works in the same way of adg_model_set_named_pair() but accepts an
+ * already interned name. When no handler is connected to
+ * #AdgModel::set-named-pair and the default implementation is in use,
+ * the signal emission is skipped and the named pair is stored directly.
+ *
+ * Since: 1.0
+ **/
+void
+adg_model_set_named_pair_quark(AdgModel *model, GQuark name,
+                               const CpmlPair *pair)
+{
+    AdgModelClass *klass;
+    AdgModelPrivate *data;
+
+    g_return_if_fail(ADG_IS_MODEL(model));
+    g_return_if_fail(name != 0);
+
+    klass = ADG_MODEL_GET_CLASS(model);
+
+    if (klass->set_named_pair != _adg_set_named_pair ||
+        g_signal_has_handler_pending(model, _adg_signals[SET_NAMED_PAIR],
+                                     0, TRUE)) {
+        g_signal_emit(model, _adg_signals[SET_NAMED_PAIR], 0,
+                      g_quark_to_string(name), pair);
+        return;
+    }
+
+    data = adg_model_get_instance_private(model);
+
+    if (pair != NULL)
+        _adg_named_insert(data, name, pair);
+    else if (! _adg_named_remove(data, name))
+        g_warning(_("%s: attempting to remove nonexistent '%s' named pair"),
+                  G_STRLOC, g_quark_to_string(name));
+}
+
 /**
  * adg_model_get_named_pair:
  * @model: an #AdgModel
@@ -540,6 +667,8 @@ adg_model_set_named_pair_explicit(AdgModel *model, const gchar *name,
  *
  * Gets the @name named pair associated to @model. The returned
  * pair is owned by @model and must not be modified or freed.
+ * It is valid only up to the next change of the named pairs
+ * of @model.
  *
  * Returns: the requested #CpmlPair or <constant>NULL</constant> if not found.
  *
@@ -561,15 +690,59 @@ adg_model_get_named_pair(AdgModel *model, const gchar *name)
     return klass->named_pair(model, name);
 }
 
+/**
+ * adg_model_get_named_pair_quark:
+ * @model: an #AdgModel
+ * @name: the #GQuark of the name of the pair to get
+ *
+ * Works in the same way of adg_model_get_named_pair() but accepts an
+ * already interned name. With the default implementation, the lookup
+ * does not need to hash any string.
+ *
+ * Returns: the requested #CpmlPair or <constant>NULL</constant> if not found.
+ *
+ * Since: 1.0
+ **/
+const CpmlPair *
+adg_model_get_named_pair_quark(AdgModel *model, GQuark name)
+{
+    AdgModelClass *klass;
+    AdgNamedEntry *entry;
+
+    g_return_val_if_fail(ADG_IS_MODEL(model), NULL);
+
+    if (name == 0)
+        return NULL;
+
+    klass = ADG_MODEL_GET_CLASS(model);
+
+    if (klass->named_pair == NULL)
+        return NULL;
+
+    if (klass->named_pair != _adg_named_pair)
+        return klass->named_pair(model, g_quark_to_string(name));
+
+    entry = _adg_named_lookup(adg_model_get_instance_private(model), name);
+    return entry != NULL ? &entry->pair : NULL;
+}
+
 /**
  * adg_model_foreach_named_pair:
  * @model: an #AdgModel
  * @callback: (scope call): the named pair callback
  * @user_data: general purpose user data passed "as is" to @callback
  *
- * Invokes @callback for each named pair set on @model. This can
- * be used, for example, to retrieve all the named pairs of a @model
- * or to duplicate a transformed version of every named pair.
+ * Invokes @callback for each named pair set on @model. This can be
+ * used, for example, to retrieve all the named pairs of a @model or to
+ * duplicate a transformed version of every named pair.
+ *
+ * The pairs are visited in the order they have been defined only as
+ * long as none of them has been removed: a removal moves the last
+ * defined pair in place of the removed one.
+ *
+ * @callback is allowed to add new named pairs to @model: they will
+ * not be visited by the current iteration. The @pair passed to
+ * @callback is valid only until the next named pair change.
  *
  * Since: 1.0
  **/
@@ -578,21 +751,55 @@ adg_model_foreach_named_pair(AdgModel *model, AdgNamedPairFunc callback,
                              gpointer user_data)
 {
     AdgModelPrivate *data;
-    AdgWrapperHelper helper;
+    AdgNamedEntry *entry;
+    guint n, n_entries;
 
     g_return_if_fail(ADG_IS_MODEL(model));
     g_return_if_fail(callback != NULL);
 
     data = adg_model_get_instance_private(model);
+    n_entries = data->named_pairs.n_entries;
+
+    /* The entries array could be relocated by callback,
+     * so do not cache its address between iterations */
+    for (n = 0; n < n_entries && n < data->named_pairs.n_entries; ++n) {
+        entry = &data->named_pairs.entries[n];
+        callback(model, g_quark_to_string(entry->name),
+                 &entry->pair, user_data);
+    }
+}
 
-    if (data->named_pairs == NULL)
-        return;
+/**
+ * adg_model_get_generation:
+ * @model: an #AdgModel
+ *
+ * Gets the named pair generation of @model, that is a counter
+ * incremented whenever a named pair is added, updated or removed.
+ * Any pointer returned by adg_model_get_named_pair() (or its quark
+ * counterpart) is guaranteed to be still valid, and to point to the
+ * same value, as long as the generation does not change: this can be
+ * used to cache named pair lookups.
+ *
+ * When the <function>named_pair</function> method has been overriden
+ * by a subclass, the named pairs are not necessarily stored by #AdgModel
+ * and 0 is returned, meaning the lookups should not be cached at all.
+ *
+ * Returns: the current generation or 0 if the lookups are not cacheable.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_model_get_generation(AdgModel *model)
+{
+    AdgModelPrivate *data;
+
+    g_return_val_if_fail(ADG_IS_MODEL(model), 0);
 
-    helper.callback = callback;
-    helper.model = model;
-    helper.user_data = user_data;
+    if (ADG_MODEL_GET_CLASS(model)->named_pair != _adg_named_pair)
+        return 0;
 
-    g_hash_table_foreach(data->named_pairs, _adg_named_pair_wrapper, &helper);
+    data = adg_model_get_instance_private(model);
+    return data->named_pairs.generation;
 }
 
 /**
@@ -646,16 +853,71 @@ adg_model_reset(AdgModel *model)
 void
 adg_model_changed(AdgModel *model)
 {
+    guint event;
+
     g_return_if_fail(ADG_IS_MODEL(model));
 
+    event = _adg_tracing ? _adg_trace_begin(model, "changed") : G_MAXUINT;
+
     g_signal_emit(model, _adg_signals[CHANGED], 0);
+
+    if (event != G_MAXUINT)
+        _adg_trace_end(event);
 }
 
 
+static AdgModel *
+_adg_clone(AdgModel *model)
+{
+    AdgModelClass *klass, *parent_class;
+    AdgModelPrivate *data, *clone_data;
+    AdgModel *clone;
+    guint n_entries, n_slots;
+
+    klass = ADG_MODEL_GET_CLASS(model);
+    parent_class = g_type_class_peek_parent(klass);
+
+    if (klass->clone != parent_class->clone) {
+        /* The type of model has a typed clone method chaining up
+         * here: the properties will be copied by the callers */
+        clone = g_object_new(G_OBJECT_TYPE(model), NULL);
+    } else {
+        clone = (AdgModel *) _adg_object_clone_except((GObject *) model,
+                                                      ADG_TYPE_MODEL);
+    }
+
+    data = adg_model_get_instance_private(model);
+    clone_data = adg_model_get_instance_private(clone);
+    n_entries = data->named_pairs.n_entries;
+    n_slots = data->named_pairs.n_slots;
+
+    /* The named pairs table does not contain pointers:
+     * a plain copy of the arrays is enough */
+    g_free(clone_data->named_pairs.entries);
+    g_free(clone_data->named_pairs.slots);
+    clone_data->named_pairs.entries = n_entries > 0 ?
+        g_new(AdgNamedEntry, n_entries) : NULL;
+    clone_data->named_pairs.n_entries = n_entries;
+    clone_data->named_pairs.n_allocated = n_entries;
+    clone_data->named_pairs.slots = n_slots > 0 ?
+        g_new(guint, n_slots) : NULL;
+    clone_data->named_pairs.n_slots = n_slots;
+
+    if (n_entries > 0)
+        memcpy(clone_data->named_pairs.entries, data->named_pairs.entries,
+               n_entries * sizeof(AdgNamedEntry));
+    if (n_slots > 0)
+        memcpy(clone_data->named_pairs.slots, data->named_pairs.slots,
+               n_slots * sizeof(guint));
+
+    return clone;
+}
+
 static void
 _adg_add_dependency(AdgModel *model, AdgEntity *entity)
 {
     AdgModelPrivate *data;
+    AdgDependency *dependency;
 
     /* Do not add NULL values */
     if (entity == NULL)
@@ -663,9 +925,22 @@ _adg_add_dependency(AdgModel *model, AdgEntity *entity)
 
     data = adg_model_get_instance_private(model);
 
-    /* The prepend operation is more efficient */
-    data->dependencies = g_slist_prepend(data->dependencies, entity);
+    if (data->dependency_table == NULL)
+        data->dependency_table = g_hash_table_new_full(NULL, NULL,
+                                                       NULL, g_free);
+
+    dependency = g_hash_table_lookup(data->dependency_table, entity);
+    if (dependency == NULL) {
+        /* The prepend operation is more efficient */
+        data->dependencies = g_slist_prepend(data->dependencies, entity);
+
+        dependency = g_new(AdgDependency, 1);
+        dependency->link = data->dependencies;
+        dependency->count = 0;
+        g_hash_table_insert(data->dependency_table, entity, dependency);
+    }
 
+    ++dependency->count;
     g_object_ref(entity);
 }
 
@@ -673,9 +948,13 @@ static void
 _adg_remove_dependency(AdgModel *model, AdgEntity *entity)
 {
     AdgModelPrivate *data = adg_model_get_instance_private(model);
-    GSList *node = g_slist_find(data->dependencies, entity);
+    AdgDependency *dependency, *head_dependency;
+    GSList *head;
 
-    if (node == NULL) {
+    dependency = data->dependency_table != NULL ?
+        g_hash_table_lookup(data->dependency_table, entity) : NULL;
+
+    if (dependency == NULL) {
         g_warning(_("%s: attempting to remove the nonexistent dependency "
                     "on the entity with type %s from a model of type %s"),
                   G_STRLOC,
@@ -684,10 +963,62 @@ _adg_remove_dependency(AdgModel *model, AdgEntity *entity)
         return;
     }
 
-    data->dependencies = g_slist_delete_link(data->dependencies, node);
+    if (--dependency->count == 0) {
+        /* A singly linked list cannot drop an inner link in constant
+         * time: move the head entity into the link to remove and drop
+         * the head instead. The order of the list is not relevant. */
+        head = data->dependencies;
+        if (dependency->link != head) {
+            head_dependency = g_hash_table_lookup(data->dependency_table,
+                                                  head->data);
+            dependency->link->data = head->data;
+            head_dependency->link = dependency->link;
+        }
+
+        data->dependencies = g_slist_delete_link(head, head);
+        g_hash_table_remove(data->dependency_table, entity);
+    }
+
     g_object_unref(entity);
 }
 
+static gboolean
+_adg_release_dependencies(AdgModel *model)
+{
+    AdgModelPrivate *data = adg_model_get_instance_private(model);
+    GSList *dependencies;
+    GHashTable *dependency_table;
+    AdgDependency *dependency;
+    AdgEntity *entity;
+
+    /* The bulk release is possible only when no one would notice
+     * the missing "remove-dependency" emissions */
+    if (ADG_MODEL_GET_CLASS(model)->remove_dependency != _adg_remove_dependency ||
+        g_signal_has_handler_pending(model, _adg_signals[REMOVE_DEPENDENCY],
+                                     0, FALSE))
+        return FALSE;
+
+    /* Detach everything before dropping the references: releasing
+     * an entity can trigger further requests on this model */
+    dependencies = data->dependencies;
+    dependency_table = data->dependency_table;
+    data->dependencies = NULL;
+    data->dependency_table = NULL;
+
+    while (dependencies != NULL) {
+        entity = dependencies->data;
+        dependency = g_hash_table_lookup(dependency_table, entity);
+        while (dependency->count-- > 0)
+            g_object_unref(entity);
+        dependencies = g_slist_delete_link(dependencies, dependencies);
+    }
+
+    if (dependency_table != NULL)
+        g_hash_table_destroy(dependency_table);
+
+    return TRUE;
+}
+
 static void
 _adg_reset(AdgModel *model)
 {
@@ -695,23 +1026,24 @@ _adg_reset(AdgModel *model)
 
     adg_model_clear(model);
 
-    if (data->named_pairs) {
-        g_hash_table_destroy(data->named_pairs);
-        data->named_pairs = NULL;
-    }
+    /* Keep the allocated memory around for the next definition */
+    if (data->named_pairs.n_entries > 0)
+        ++data->named_pairs.generation;
+    data->named_pairs.n_entries = 0;
+    if (data->named_pairs.slots != NULL)
+        memset(data->named_pairs.slots, 0,
+               data->named_pairs.n_slots * sizeof(guint));
 }
 
 static void
 _adg_set_named_pair(AdgModel *model, const gchar *name, const CpmlPair *pair)
 {
     AdgModelPrivate *data = adg_model_get_instance_private(model);
-    GHashTable **hash = &data->named_pairs;
-    gchar *key;
-    CpmlPair *value;
 
     if (pair == NULL) {
-        /* Delete mode: raise a warning if @name is not found */
-        if (*hash == NULL || !g_hash_table_remove(*hash, name))
+        /* Delete mode: raise a warning if @name is not found.
+         * g_quark_try_string() avoids interning unknown names */
+        if (! _adg_named_remove(data, g_quark_try_string(name)))
             g_warning(_("%s: attempting to remove nonexistent '%s' named pair"),
                       G_STRLOC, name);
 
@@ -719,24 +1051,16 @@ _adg_set_named_pair(AdgModel *model, const gchar *name, const CpmlPair *pair)
     }
 
     /* Insert or update mode */
-    key = g_strdup(name);
-    value = cpml_pair_dup(pair);
-
-    if (*hash == NULL)
-        *hash = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
-
-    g_hash_table_insert(*hash, key, value);
+    _adg_named_insert(data, g_quark_from_string(name), pair);
 }
 
 static const CpmlPair *
 _adg_named_pair(AdgModel *model, const gchar *name)
 {
     AdgModelPrivate *data = adg_model_get_instance_private(model);
+    AdgNamedEntry *entry = _adg_named_lookup(data, g_quark_try_string(name));
 
-    if (data->named_pairs == NULL)
-        return NULL;
-
-    return g_hash_table_lookup(data->named_pairs, name);
+    return entry != NULL ? &entry->pair : NULL;
 }
 
 static void
@@ -746,18 +1070,124 @@ _adg_changed(AdgModel *model)
     adg_model_foreach_dependency(model, _adg_invalidate_wrapper, NULL);
 }
 
+static guint
+_adg_named_slot(const AdgModelPrivate *data, GQuark name)
+{
+    guint mask = data->named_pairs.n_slots - 1;
+    guint slot = _ADG_NAMED_HASH(name, mask);
+    guint index;
+
+    /* Linear probing: stop on the matching entry or on the first
+     * empty slot, that is where @name should be inserted */
+    while ((index = data->named_pairs.slots[slot]) != 0 &&
+           data->named_pairs.entries[index - 1].name != name)
+        slot = (slot + 1) & mask;
+
+    return slot;
+}
+
+static AdgNamedEntry *
+_adg_named_lookup(AdgModelPrivate *data, GQuark name)
+{
+    guint index;
+
+    if (name == 0 || data->named_pairs.n_entries == 0)
+        return NULL;
+
+    index = data->named_pairs.slots[_adg_named_slot(data, name)];
+    return index == 0 ? NULL : &data->named_pairs.entries[index - 1];
+}
+
+static void
+_adg_named_rehash(AdgModelPrivate *data, guint n_slots)
+{
+    guint n;
+
+    g_free(data->named_pairs.slots);
+    data->named_pairs.slots = g_new0(guint, n_slots);
+    data->named_pairs.n_slots = n_slots;
+
+    for (n = 0; n < data->named_pairs.n_entries; ++n)
+        data->named_pairs.slots[_adg_named_slot(data, data->named_pairs.entries[n].name)] = n + 1;
+}
+
 static void
-_adg_named_pair_wrapper(gpointer key, gpointer value, gpointer user_data)
+_adg_named_insert(AdgModelPrivate *data, GQuark name, const CpmlPair *pair)
 {
-    const gchar *name;
-    CpmlPair *pair;
-    AdgWrapperHelper *helper;
+    /* @pair could point inside the entries array that is going
+     * to be relocated, so work on a copy */
+    CpmlPair value = *pair;
+    AdgNamedEntry *entry;
+    guint slot;
+
+    ++data->named_pairs.generation;
+
+    entry = _adg_named_lookup(data, name);
+    if (entry != NULL) {
+        /* Update mode */
+        entry->pair = value;
+        return;
+    }
 
-    name = key;
-    pair = value;
-    helper = user_data;
+    /* Keep the load factor of the slots table under 3/4 */
+    if ((data->named_pairs.n_entries + 1) * 4 > data->named_pairs.n_slots * 3)
+        _adg_named_rehash(data, MAX(data->named_pairs.n_slots * 2, 16));
+
+    if (data->named_pairs.n_entries == data->named_pairs.n_allocated) {
+        data->named_pairs.n_allocated = MAX(data->named_pairs.n_allocated * 2, 8);
+        data->named_pairs.entries = g_renew(AdgNamedEntry,
+                                            data->named_pairs.entries,
+                                            data->named_pairs.n_allocated);
+    }
+
+    slot = _adg_named_slot(data, name);
+    entry = &data->named_pairs.entries[data->named_pairs.n_entries];
+    entry->name = name;
+    entry->pair = value;
+    data->named_pairs.slots[slot] = ++data->named_pairs.n_entries;
+}
+
+static gboolean
+_adg_named_remove(AdgModelPrivate *data, GQuark name)
+{
+    guint *slots = data->named_pairs.slots;
+    AdgNamedEntry *entries = data->named_pairs.entries;
+    guint mask, hole, slot, home, index, last;
+
+    if (name == 0 || data->named_pairs.n_entries == 0)
+        return FALSE;
+
+    hole = _adg_named_slot(data, name);
+    index = slots[hole];
+    if (index == 0)
+        return FALSE;
+
+    /* Backward shift deletion: move back any following entry whose
+     * probe sequence passes through the hole, so no tombstone is needed */
+    mask = data->named_pairs.n_slots - 1;
+    slot = hole;
+    for (;;) {
+        slot = (slot + 1) & mask;
+        if (slots[slot] == 0)
+            break;
+
+        home = _ADG_NAMED_HASH(entries[slots[slot] - 1].name, mask);
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            slots[hole] = slots[slot];
+            hole = slot;
+        }
+    }
+    slots[hole] = 0;
+    ++data->named_pairs.generation;
+
+    /* Fill the gap in the dense array with the last entry */
+    last = data->named_pairs.n_entries--;
+    if (index != last) {
+        entries[index - 1] = entries[last - 1];
+        slots[_adg_named_slot(data, entries[index - 1].name)] = index;
+    }
 
-    helper->callback(helper->model, name, pair, helper->user_data);
+    return TRUE;
 }
 
 static void
@@ -60,6 +60,7 @@ struct _AdgModelClass {
     /* Virtual table */
     const CpmlPair *    (*named_pair)           (AdgModel         *model,
                                                  const gchar      *name);
+    AdgModel *          (*clone)                (AdgModel         *model);
 
     /* Signals */
     void                (*set_named_pair)       (AdgModel         *model,
@@ -76,6 +77,7 @@ struct _AdgModelClass {
 
 
 GType           adg_model_get_type              (void);
+AdgModel *      adg_model_clone                 (AdgModel         *model);
 
 void            adg_model_add_dependency        (AdgModel         *model,
                                                  AdgEntity        *entity);
@@ -93,11 +95,17 @@ void            adg_model_set_named_pair_explicit
                                                  const gchar      *name,
                                                  gdouble           x,
                                                  gdouble           y);
+void            adg_model_set_named_pair_quark  (AdgModel         *model,
+                                                 GQuark            name,
+                                                 const CpmlPair   *pair);
 const CpmlPair *adg_model_get_named_pair        (AdgModel         *model,
                                                  const gchar      *name);
+const CpmlPair *adg_model_get_named_pair_quark  (AdgModel         *model,
+                                                 GQuark            name);
 void            adg_model_foreach_named_pair    (AdgModel         *model,
                                                  AdgNamedPairFunc  callback,
                                                  gpointer          user_data);
+guint           adg_model_get_generation        (AdgModel         *model);
 void            adg_model_clear                 (AdgModel         *model);
 void            adg_model_reset                 (AdgModel         *model);
 void            adg_model_changed               (AdgModel         *model);
@@ -24,15 +24,10 @@
 
 G_BEGIN_DECLS
 
-typedef struct _AdgNamedPair     AdgNamedPair;
 typedef enum   _AdgAction        AdgAction;
 typedef struct _AdgOperation     AdgOperation;
 typedef struct _AdgPathPrivate   AdgPathPrivate;
-
-struct _AdgNamedPair {
-    const gchar *name;
-    CpmlPair     pair;
-};
+typedef struct _AdgPrimitiveOffset AdgPrimitiveOffset;
 
 enum _AdgAction {
     ADG_ACTION_NONE,
@@ -54,6 +49,23 @@ struct _AdgOperation{
 
 };
 
+/* Position of a primitive inside the path data array:
+ * org is -1 when the primitive has no origin */
+struct _AdgPrimitiveOffset {
+    gint                 org;
+    gint                 data;
+};
+
+struct _AdgPathSnapshot {
+    gint                 refcount;
+    AdgPathSnapshot     *parent;
+    gint                 n_data;
+    cairo_path_data_t   *chunk;
+    gboolean             cp_is_valid;
+    CpmlPair             cp;
+    AdgOperation         operation;
+};
+
 struct _AdgPathPrivate {
     gboolean             cp_is_valid;
     CpmlPair             cp;
@@ -65,7 +77,13 @@ struct _AdgPathPrivate {
 
     CpmlPrimitive        last;
     CpmlPrimitive        over;
+    GArray              *history;
     AdgOperation         operation;
+
+    struct {
+        AdgPathSnapshot *last;
+        gint             clean;
+    }                    snapshot;
 };
 
 G_END_DECLS
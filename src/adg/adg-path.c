@@ -47,6 +47,20 @@
  * the starting point of the segment is automatically added by cairo;
  * in ADG, after an adg_path_close() the current point is unset.
  *
+ * The state of a path can be saved with adg_path_snapshot() and
+ * brought back later with adg_path_restore(). Snapshots of the same
+ * path share the data they have in common, so they can be used to
+ * implement undo steps or to generate variants of the same path.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgPathSnapshot:
+ *
+ * An opaque, immutable and reference counted state of an #AdgPath.
+ * Use adg_path_snapshot() to create it.
+ *
  * Since: 1.0
  **/
 
@@ -68,13 +82,12 @@
 #include "adg-path.h"
 #include "adg-path-private.h"
 
+#include <string.h>
+
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_path_parent_class)
 #define _ADG_OLD_MODEL_CLASS   ((AdgModelClass *) adg_path_parent_class)
-
-#define REMAPPED(ptr, from, to) \
-    (ptr) == NULL ? NULL : \
-        (gpointer) ((guint8 *) (ptr) - (guint8 *) (from) + (guint8 *) (to))
+#define _ADG_OLD_TRAIL_CLASS   ((AdgTrailClass *) adg_path_parent_class)
 
 
 G_DEFINE_TYPE_WITH_PRIVATE(AdgPath, adg_path, ADG_TYPE_TRAIL)
@@ -84,14 +97,22 @@ static void             _adg_finalize           (GObject        *object);
 static void             _adg_clear              (AdgModel       *model);
 static void             _adg_clear_parent       (AdgModel       *model);
 static void             _adg_changed            (AdgModel       *model);
+static AdgModel *       _adg_clone              (AdgModel       *model);
+static void             _adg_clear_from         (AdgPath        *path,
+                                                 gint            offset);
+static void             _adg_set_snapshot       (AdgPath        *path,
+                                                 AdgPathSnapshot*snapshot);
+static AdgPathSnapshot *_adg_common_snapshot    (AdgPathSnapshot*snapshot1,
+                                                 AdgPathSnapshot*snapshot2);
 static cairo_path_t *   _adg_get_cairo_path     (AdgTrail       *trail);
+static gsize            _adg_memory_size        (AdgTrail       *trail);
 static cairo_path_t *   _adg_read_cairo_path    (AdgPath        *path);
 static gint             _adg_primitive_length   (CpmlPrimitiveType type);
-static void             _adg_primitive_remap    (CpmlPrimitive  *primitive,
-                                                 gpointer        to,
-                                                 const CpmlPrimitive
-                                                                *old,
-                                                 gconstpointer   from);
+static void             _adg_history_push       (AdgPath        *path,
+                                                 const cairo_path_data_t *org,
+                                                 const cairo_path_data_t *header);
+static void             _adg_history_apply      (AdgPath        *path);
+static void             _adg_update_cp          (AdgPath        *path);
 static void             _adg_rescan             (AdgPath        *path);
 static void             _adg_append_primitive   (AdgPath        *path,
                                                  CpmlPrimitive  *primitive);
@@ -114,14 +135,14 @@ static gboolean         _adg_is_convex          (const CpmlPrimitive
                                                  const CpmlPrimitive
                                                                 *primitive2);
 static const gchar *    _adg_action_name        (AdgAction       action);
-static void             _adg_get_named_pair     (AdgModel       *model,
+static void             _adg_copy_named_pair    (AdgModel       *model,
+                                                 const gchar    *name,
+                                                 CpmlPair       *pair,
+                                                 gpointer        user_data);
+static void             _adg_reverse_named_pair (AdgModel       *model,
                                                  const gchar    *name,
                                                  CpmlPair       *pair,
                                                  gpointer        user_data);
-static void             _adg_dup_reverse_named_pairs
-                                                (AdgModel       *model,
-                                                 const cairo_matrix_t
-                                                                *matrix);
 
 
 static void
@@ -139,8 +160,10 @@ adg_path_class_init(AdgPathClass *klass)
 
     model_class->clear = _adg_clear;
     model_class->changed = _adg_changed;
+    model_class->clone = _adg_clone;
 
     trail_class->get_cairo_path = _adg_get_cairo_path;
+    trail_class->memory_size = _adg_memory_size;
 }
 
 static void
@@ -160,7 +183,10 @@ adg_path_init(AdgPath *path)
     data->over.segment = NULL;
     data->over.org = NULL;
     data->over.data = NULL;
+    data->history = g_array_new(FALSE, FALSE, sizeof(AdgPrimitiveOffset));
     data->operation.action = ADG_ACTION_NONE;
+    data->snapshot.last = NULL;
+    data->snapshot.clean = 0;
 }
 
 static void
@@ -170,7 +196,9 @@ _adg_finalize(GObject *object)
     AdgPathPrivate *data = adg_path_get_instance_private(path);
 
     g_array_free(data->cairo.array, TRUE);
+    g_array_free(data->history, TRUE);
     _adg_clear_operation(path);
+    _adg_set_snapshot(path, NULL);
 
     if (_ADG_OLD_OBJECT_CLASS->finalize)
         _ADG_OLD_OBJECT_CLASS->finalize(object);
@@ -353,31 +381,28 @@ adg_path_append(AdgPath *path, gint type, ...)
 void
 adg_path_append_valist(AdgPath *path, CpmlPrimitiveType type, va_list var_args)
 {
-    GPtrArray *array;
-    const CpmlPair *pair;
-    gint length;
+    /* Up to 3 pairs (a curve) plus the NULL terminator */
+    const CpmlPair *pairs[4];
+    gint length, n;
 
     length = _adg_primitive_length(type);
     if (length == 0)
         return;
 
-    array = g_ptr_array_sized_new(4);
-    while (-- length) {
-        pair = va_arg(var_args, const CpmlPair *);
-        if (pair == NULL) {
-            g_ptr_array_free(array, TRUE);
+    g_return_if_fail(length <= (gint) G_N_ELEMENTS(pairs));
+
+    for (n = 0; n < length - 1; ++n) {
+        pairs[n] = va_arg(var_args, const CpmlPair *);
+        if (pairs[n] == NULL) {
             g_return_if_reached();
             return;
         }
-        g_ptr_array_add(array, (gpointer) pair);
     }
 
     /* The array must be NULL terminated */
-    g_ptr_array_add(array, NULL);
+    pairs[n] = NULL;
 
-    adg_path_append_array(path, type, (const CpmlPair **) array->pdata);
-
-    g_ptr_array_free(array, TRUE);
+    adg_path_append_array(path, type, pairs);
 }
 
 /**
@@ -401,10 +426,10 @@ void
 adg_path_append_array(AdgPath *path, CpmlPrimitiveType type,
                       const CpmlPair **pairs)
 {
-    gint length;
-    GArray *array;
-    const CpmlPair **pair;
-    cairo_path_data_t path_data;
+    AdgPathPrivate *data;
+    CpmlPrimitive primitive;
+    cairo_path_data_t org, buffer[8], *path_data;
+    gint length, n_pairs, n;
 
     g_return_if_fail(ADG_IS_PATH(path));
     g_return_if_fail(pairs != NULL);
@@ -413,36 +438,40 @@ adg_path_append_array(AdgPath *path, CpmlPrimitiveType type,
     if (length == 0)
         return;
 
-    array = g_array_new(FALSE, FALSE, sizeof(path_data));
-    for (pair = pairs; *pair != NULL; ++ pair) {
-        cpml_pair_to_cairo(*pair, &path_data);
-        g_array_append_val(array, path_data);
-    }
+    for (n_pairs = 0; pairs[n_pairs] != NULL; ++n_pairs)
+        ;
 
-    if (array->len < length - 1) {
+    if (n_pairs < length - 1) {
         /* Not enough pairs have been provided */
         g_warning(_("%s: null pair caught while parsing arguments"), G_STRLOC);
-    } else {
-        AdgPathPrivate *data = adg_path_get_instance_private(path);
-        CpmlPrimitive primitive;
-        cairo_path_data_t org;
-
-        /* Save a copy of the current point as primitive origin */
-        cpml_pair_to_cairo(&data->cp, &org);
-
-        /* Prepend the cairo header */
-        path_data.header.type = type;
-        path_data.header.length = array->len + 1;
-        g_array_prepend_val(array, path_data);
-
-        /* Append a new primitive to @path */
-        primitive.segment = NULL;
-        primitive.org = &org;
-        primitive.data = (cairo_path_data_t *) array->data;
-        _adg_append_primitive(path, &primitive);
+        return;
     }
 
-    g_array_free(array, TRUE);
+    /* Appending is a hot path: the heap is used only by primitives
+     * with a lot of embedded data */
+    if (n_pairs < (gint) G_N_ELEMENTS(buffer))
+        path_data = buffer;
+    else
+        path_data = g_new(cairo_path_data_t, n_pairs + 1);
+
+    /* The cairo header followed by the pairs */
+    path_data[0].header.type = type;
+    path_data[0].header.length = n_pairs + 1;
+    for (n = 0; n < n_pairs; ++n)
+        cpml_pair_to_cairo(pairs[n], &path_data[n + 1]);
+
+    /* Save a copy of the current point as primitive origin */
+    data = adg_path_get_instance_private(path);
+    cpml_pair_to_cairo(&data->cp, &org);
+
+    /* Append a new primitive to @path */
+    primitive.segment = NULL;
+    primitive.org = &org;
+    primitive.data = path_data;
+    _adg_append_primitive(path, &primitive);
+
+    if (path_data != buffer)
+        g_free(path_data);
 }
 
 
@@ -506,7 +535,7 @@ adg_path_append_segment(AdgPath *path, const CpmlSegment *segment)
 
         data = adg_path_get_instance_private(path);
 
-        _adg_clear_parent((AdgModel *) path);
+        _adg_clear_from(path, data->cairo.array->len);
         data->cairo.array = g_array_append_vals(data->cairo.array,
                                                 segment->data, segment->num_data);
         _adg_rescan(path);
@@ -532,7 +561,7 @@ adg_path_append_cairo_path(AdgPath *path, const cairo_path_t *cairo_path)
 
     data = adg_path_get_instance_private(path);
 
-    _adg_clear_parent((AdgModel *) path);
+    _adg_clear_from(path, data->cairo.array->len);
     data->cairo.array = g_array_append_vals(data->cairo.array,
                                             cairo_path->data,
                                             cairo_path->num_data);
@@ -553,33 +582,23 @@ adg_path_append_cairo_path(AdgPath *path, const cairo_path_t *cairo_path)
 void
 adg_path_append_trail(AdgPath *path, AdgTrail *trail)
 {
-    GSList *named_pairs;
-    AdgNamedPair *named_pair;
-
     g_return_if_fail(ADG_IS_PATH(path));
     g_return_if_fail(ADG_IS_TRAIL(trail));
 
     adg_path_append_cairo_path(path, adg_trail_get_cairo_path(trail));
 
-    /* Populate named_pairs with all the named pairs of trail */
-    named_pairs = NULL;
-    adg_model_foreach_named_pair((AdgModel *)trail,
-                                 _adg_get_named_pair, &named_pairs);
-
-    /* Readd the pairs to path */
-    while (named_pairs) {
-        named_pair = (AdgNamedPair *) named_pairs->data;
-        adg_model_set_named_pair((AdgModel *) path,
-                                 named_pair->name, &named_pair->pair);
-        named_pairs = g_slist_delete_link(named_pairs, named_pairs);
-    }
+    /* Readd the named pairs of trail to path */
+    adg_model_foreach_named_pair((AdgModel *) trail,
+                                 _adg_copy_named_pair, path);
 }
 
 /**
  * adg_path_remove_primitive:
  * @path: an #AdgPath
  *
- * Removes the last primitive from @path.
+ * Removes the last primitive from @path. The previous primitives
+ * are tracked internally, so this operation does not need to scan
+ * the whole path.
  *
  * Since: 1.0
  **/
@@ -587,27 +606,35 @@ void
 adg_path_remove_primitive(AdgPath *path)
 {
     AdgPathPrivate *data;
-    const CpmlPrimitive *over;
-    guint len;
+    const AdgPrimitiveOffset *over;
+    const cairo_path_data_t *path_data;
+    guint n, len;
 
     g_return_if_fail(ADG_IS_PATH(path));
 
     data = adg_path_get_instance_private(path);
-    over = adg_path_over_primitive(path);
-
-    if (over) {
-        cairo_path_data_t *end = over->data + over->data->header.length;
-        len = end - (cairo_path_data_t *) (data->cairo.array)->data;
+    n = data->history->len;
+    over = n > 1 ? &g_array_index(data->history, AdgPrimitiveOffset, n - 2) : NULL;
+
+    /* The over primitive is kept even without an origin, e.g. when
+     * appended after a close: its data starts at over->data anyway */
+    if (over != NULL) {
+        path_data = (const cairo_path_data_t *) data->cairo.array->data;
+        len = over->data + path_data[over->data].header.length;
+        --n;
     } else {
         len = 0;
+        n = 0;
     }
 
     /* Resize the data array */
     g_array_set_size(data->cairo.array, len);
+    g_array_set_size(data->history, n);
 
-    /* Rescan path to compute the new over and last primitives */
-    _adg_clear_parent((AdgModel *) path);
-    _adg_rescan(path);
+    /* The new over and last primitives are already in the history */
+    _adg_clear_from(path, len);
+    _adg_history_apply(path);
+    _adg_update_cp(path);
 }
 
 /**
@@ -997,6 +1024,11 @@ adg_path_join(AdgPath *path)
         }
         data += data->header.length;
     }
+
+    _adg_clear_from(path, 0);
+
+    /* The old move-to primitives are now part of the history */
+    _adg_rescan(path);
 }
 
 /**
@@ -1073,7 +1105,10 @@ adg_path_reflect(AdgPath *path, const CpmlVector *vector)
         g_free(dup_segment);
     }
 
-    _adg_dup_reverse_named_pairs(model, &matrix);
+    /* Readd the named pairs applying the reversing transformation matrix
+     * to their coordinates and prepending a "-" to their name: pairs
+     * added by the callback are not visited again */
+    adg_model_foreach_named_pair(model, _adg_reverse_named_pair, &matrix);
 }
 
 /**
@@ -1098,6 +1133,180 @@ adg_path_reflect_explicit(AdgPath *path, gdouble x, gdouble y)
     adg_path_reflect(path, &vector);
 }
 
+GType
+adg_path_snapshot_get_type(void)
+{
+    static GType snapshot_type = 0;
+
+    if (G_UNLIKELY(snapshot_type == 0))
+        snapshot_type = g_boxed_type_register_static("AdgPathSnapshot",
+                                                     (GBoxedCopyFunc) adg_path_snapshot_ref,
+                                                     (GBoxedFreeFunc) adg_path_snapshot_unref);
+
+    return snapshot_type;
+}
+
+/**
+ * adg_path_snapshot_ref:
+ * @snapshot: an #AdgPathSnapshot
+ *
+ * Increases the reference count of @snapshot by one.
+ *
+ * Returns: (transfer full): @snapshot.
+ *
+ * Since: 1.0
+ **/
+AdgPathSnapshot *
+adg_path_snapshot_ref(AdgPathSnapshot *snapshot)
+{
+    g_return_val_if_fail(snapshot != NULL, NULL);
+
+    g_atomic_int_inc(&snapshot->refcount);
+    return snapshot;
+}
+
+/**
+ * adg_path_snapshot_unref:
+ * @snapshot: an #AdgPathSnapshot
+ *
+ * Decreases the reference count of @snapshot by one. When it drops
+ * to 0, @snapshot is freed and the reference it holds on the
+ * snapshot it is based upon is released.
+ *
+ * Since: 1.0
+ **/
+void
+adg_path_snapshot_unref(AdgPathSnapshot *snapshot)
+{
+    AdgPathSnapshot *parent;
+
+    g_return_if_fail(snapshot != NULL);
+
+    /* Iterate instead of recursing: undo chains can be long */
+    while (snapshot != NULL && g_atomic_int_dec_and_test(&snapshot->refcount)) {
+        parent = snapshot->parent;
+        g_free(snapshot->chunk);
+        g_free(snapshot);
+        snapshot = parent;
+    }
+}
+
+/**
+ * adg_path_snapshot:
+ * @path: an #AdgPath
+ *
+ * Saves the current state of @path, that is its data, its current
+ * point and any pending operation. The named pairs are not included.
+ *
+ * The returned snapshot is chained to the previous snapshot taken
+ * from (or restored into) @path and shares with it the data that
+ * has not been modified in the meantime: only the data appended
+ * since then is copied. If nothing changed, the previous snapshot
+ * is returned.
+ *
+ * Returns: (transfer full): a new #AdgPathSnapshot to be released with adg_path_snapshot_unref().
+ *
+ * Since: 1.0
+ **/
+AdgPathSnapshot *
+adg_path_snapshot(AdgPath *path)
+{
+    AdgPathPrivate *data;
+    AdgPathSnapshot *parent, *snapshot;
+    const cairo_path_data_t *path_data;
+    gint n_data, n_parent;
+
+    g_return_val_if_fail(ADG_IS_PATH(path), NULL);
+
+    data = adg_path_get_instance_private(path);
+    parent = data->snapshot.last;
+    n_data = data->cairo.array->len;
+
+    /* Check if the last snapshot is still up to date */
+    if (parent != NULL && parent->n_data == n_data &&
+        data->snapshot.clean >= n_data &&
+        parent->cp_is_valid == data->cp_is_valid &&
+        (! data->cp_is_valid || cpml_pair_equal(&parent->cp, &data->cp)) &&
+        parent->operation.action == ADG_ACTION_NONE &&
+        data->operation.action == ADG_ACTION_NONE)
+        return adg_path_snapshot_ref(parent);
+
+    /* Share the longest chain of data not modified in the meantime */
+    while (parent != NULL && parent->n_data > data->snapshot.clean)
+        parent = parent->parent;
+    n_parent = parent == NULL ? 0 : parent->n_data;
+
+    path_data = (const cairo_path_data_t *) data->cairo.array->data;
+
+    snapshot = g_new(AdgPathSnapshot, 1);
+    snapshot->refcount = 1;
+    snapshot->parent = parent == NULL ? NULL : adg_path_snapshot_ref(parent);
+    snapshot->n_data = n_data;
+    snapshot->chunk = n_data > n_parent ?
+        cpml_memdup(path_data + n_parent,
+                    sizeof(cairo_path_data_t) * (n_data - n_parent)) : NULL;
+    snapshot->cp_is_valid = data->cp_is_valid;
+    cpml_pair_copy(&snapshot->cp, &data->cp);
+    snapshot->operation = data->operation;
+
+    _adg_set_snapshot(path, snapshot);
+
+    return snapshot;
+}
+
+/**
+ * adg_path_restore:
+ * @path:     an #AdgPath
+ * @snapshot: the #AdgPathSnapshot to restore
+ *
+ * Brings @path back to the state saved in @snapshot. @snapshot can
+ * be taken from a different #AdgPath.
+ *
+ * Only the data not shared by @snapshot and the current state of
+ * @path is copied and the cached #cairo_path_t returned by
+ * adg_trail_get_cairo_path() is retained up to that data.
+ *
+ * Since: 1.0
+ **/
+void
+adg_path_restore(AdgPath *path, AdgPathSnapshot *snapshot)
+{
+    AdgPathPrivate *data;
+    AdgPathSnapshot *common, *chunk;
+    cairo_path_data_t *path_data;
+    gint n_common, n_parent;
+
+    g_return_if_fail(ADG_IS_PATH(path));
+    g_return_if_fail(snapshot != NULL);
+
+    data = adg_path_get_instance_private(path);
+
+    /* Find the data shared by snapshot and path */
+    common = _adg_common_snapshot(snapshot, data->snapshot.last);
+    while (common != NULL && common->n_data > data->snapshot.clean)
+        common = common->parent;
+    n_common = common == NULL ? 0 : common->n_data;
+
+    g_array_set_size(data->cairo.array, snapshot->n_data);
+    path_data = (cairo_path_data_t *) data->cairo.array->data;
+
+    for (chunk = snapshot; chunk != common; chunk = chunk->parent) {
+        n_parent = chunk->parent == NULL ? 0 : chunk->parent->n_data;
+        if (chunk->n_data > n_parent)
+            memcpy(path_data + n_parent, chunk->chunk,
+                   sizeof(cairo_path_data_t) * (chunk->n_data - n_parent));
+    }
+
+    _adg_clear_from(path, n_common);
+    _adg_rescan(path);
+
+    data->cp_is_valid = snapshot->cp_is_valid;
+    cpml_pair_copy(&data->cp, &snapshot->cp);
+    data->operation = snapshot->operation;
+
+    _adg_set_snapshot(path, snapshot);
+}
+
 
 static void
 _adg_clear(AdgModel *model)
@@ -1106,6 +1315,8 @@ _adg_clear(AdgModel *model)
     AdgPathPrivate *data = adg_path_get_instance_private(path);
 
     g_array_set_size(data->cairo.array, 0);
+    g_array_set_size(data->history, 0);
+    data->snapshot.clean = 0;
     _adg_clear_operation(path);
     _adg_clear_parent(model);
 }
@@ -1120,19 +1331,119 @@ _adg_clear_parent(AdgModel *model)
 static void
 _adg_changed(AdgModel *model)
 {
+    AdgPathPrivate *data = adg_path_get_instance_private((AdgPath *) model);
+
+    /* The data could have been modified directly: do not share it
+     * and drop anything converted from it */
+    data->snapshot.clean = 0;
     _adg_clear_parent(model);
 
     if (_ADG_OLD_MODEL_CLASS->changed)
         _ADG_OLD_MODEL_CLASS->changed(model);
 }
 
+static AdgModel *
+_adg_clone(AdgModel *model)
+{
+    AdgModel *clone = _ADG_OLD_MODEL_CLASS->clone(model);
+    AdgPath *clone_path = (AdgPath *) clone;
+    AdgPathPrivate *data = adg_path_get_instance_private((AdgPath *) model);
+    AdgPathPrivate *clone_data = adg_path_get_instance_private(clone_path);
+
+    g_array_append_vals(clone_data->cairo.array,
+                        data->cairo.array->data, data->cairo.array->len);
+    g_array_append_vals(clone_data->history,
+                        data->history->data, data->history->len);
+    _adg_history_apply(clone_path);
+
+    clone_data->cp_is_valid = data->cp_is_valid;
+    clone_data->cp = data->cp;
+    clone_data->operation = data->operation;
+
+    /* The snapshots are immutable, so the last one can be shared */
+    _adg_set_snapshot(clone_path, data->snapshot.last);
+    clone_data->snapshot.clean = data->snapshot.clean;
+
+    return clone;
+}
+
+static void
+_adg_clear_from(AdgPath *path, gint offset)
+{
+    AdgPathPrivate *data = adg_path_get_instance_private(path);
+
+    /* Data before offset can still be shared with the last snapshot */
+    if (offset < data->snapshot.clean)
+        data->snapshot.clean = offset;
+
+    adg_trail_clear_from((AdgTrail *) path, offset);
+}
+
+static void
+_adg_set_snapshot(AdgPath *path, AdgPathSnapshot *snapshot)
+{
+    AdgPathPrivate *data = adg_path_get_instance_private(path);
+
+    if (snapshot != NULL) {
+        adg_path_snapshot_ref(snapshot);
+        data->snapshot.clean = snapshot->n_data;
+    } else {
+        data->snapshot.clean = 0;
+    }
+
+    if (data->snapshot.last != NULL)
+        adg_path_snapshot_unref(data->snapshot.last);
+
+    data->snapshot.last = snapshot;
+}
+
+static AdgPathSnapshot *
+_adg_common_snapshot(AdgPathSnapshot *snapshot1, AdgPathSnapshot *snapshot2)
+{
+    /* The amount of data never increases while walking up
+     * a chain, so the deeper snapshot can be moved first */
+    while (snapshot1 != NULL && snapshot2 != NULL && snapshot1 != snapshot2) {
+        if (snapshot1->n_data >= snapshot2->n_data)
+            snapshot1 = snapshot1->parent;
+        else
+            snapshot2 = snapshot2->parent;
+    }
+
+    return snapshot1 == snapshot2 ? snapshot1 : NULL;
+}
+
 static cairo_path_t *
 _adg_get_cairo_path(AdgTrail *trail)
 {
-    _adg_clear_parent((AdgModel *) trail);
     return _adg_read_cairo_path((AdgPath *) trail);
 }
 
+static gsize
+_adg_memory_size(AdgTrail *trail)
+{
+    AdgPathPrivate *data = adg_path_get_instance_private((AdgPath *) trail);
+    AdgPathSnapshot *snapshot;
+    gsize size;
+
+    size = data->cairo.array->len * sizeof(cairo_path_data_t) +
+           data->history->len * sizeof(AdgPrimitiveOffset);
+
+    /* Every snapshot owns only the chunk not shared with its parent */
+    for (snapshot = data->snapshot.last; snapshot != NULL;
+         snapshot = snapshot->parent) {
+        size += sizeof(AdgPathSnapshot);
+        if (snapshot->chunk != NULL)
+            size += sizeof(cairo_path_data_t) *
+                (snapshot->n_data - (snapshot->parent == NULL ?
+                                     0 : snapshot->parent->n_data));
+    }
+
+    if (_ADG_OLD_TRAIL_CLASS->memory_size)
+        size += _ADG_OLD_TRAIL_CLASS->memory_size(trail);
+
+    return size;
+}
+
 static cairo_path_t *
 _adg_read_cairo_path(AdgPath *path)
 {
@@ -1165,32 +1476,71 @@ _adg_primitive_length(CpmlPrimitiveType type)
 }
 
 static void
-_adg_primitive_remap(CpmlPrimitive *primitive, gpointer to,
-                     const CpmlPrimitive *old, gconstpointer from)
+_adg_history_push(AdgPath *path, const cairo_path_data_t *org,
+                  const cairo_path_data_t *header)
 {
-    primitive->org =     REMAPPED(old->org,     from, to);
-    primitive->segment = REMAPPED(old->segment, from, to);
-    primitive->data =    REMAPPED(old->data,    from, to);
+    AdgPathPrivate *data = adg_path_get_instance_private(path);
+    const cairo_path_data_t *base = (cairo_path_data_t *) data->cairo.array->data;
+    AdgPrimitiveOffset offset;
+
+    offset.org = org == NULL ? -1 : org - base;
+    offset.data = header - base;
+    g_array_append_val(data->history, offset);
 }
 
 static void
-_adg_rescan(AdgPath *path)
+_adg_history_apply(AdgPath *path)
+{
+    AdgPathPrivate *data = adg_path_get_instance_private(path);
+    cairo_path_data_t *base = (cairo_path_data_t *) data->cairo.array->data;
+    CpmlPrimitive *primitive;
+    const AdgPrimitiveOffset *offset;
+    guint n, i;
+
+    /* The last two entries of the history are the last and over
+     * primitives: just rebuild them on the current data array */
+    n = data->history->len;
+    for (i = 0; i < 2; ++i) {
+        primitive = i == 0 ? &data->last : &data->over;
+        primitive->segment = NULL;
+        if (n > i) {
+            offset = &g_array_index(data->history, AdgPrimitiveOffset, n - i - 1);
+            primitive->org = offset->org < 0 ? NULL : base + offset->org;
+            primitive->data = base + offset->data;
+        } else {
+            primitive->org = NULL;
+            primitive->data = NULL;
+        }
+    }
+}
+
+static void
+_adg_update_cp(AdgPath *path)
 {
     AdgPathPrivate *data = adg_path_get_instance_private(path);
     CpmlPrimitive *last = &data->last;
-    CpmlPrimitive *over = &data->over;
+
+    /* Save the last point in the current point */
+    data->cp_is_valid = last->data && last->data->header.type != CPML_CLOSE;
+    if (data->cp_is_valid) {
+        CpmlPrimitiveType type = last->data->header.type;
+        size_t n = type == CPML_MOVE ? 1 : cpml_primitive_type_get_n_points(type) - 1;
+        cpml_pair_from_cairo(&data->cp, &last->data[n]);
+    }
+}
+
+static void
+_adg_rescan(AdgPath *path)
+{
+    AdgPathPrivate *data = adg_path_get_instance_private(path);
     CpmlSegment segment;
     CpmlPrimitive current;
 
-    last->segment = NULL;
-    last->org = NULL;
-    last->data = NULL;
-    over->segment = NULL;
-    over->org = NULL;
-    over->data = NULL;
+    g_array_set_size(data->history, 0);
 
     /* When no data is present, just bail out */
     if (! cpml_segment_from_cairo(&segment, _adg_read_cairo_path(path))) {
+        _adg_history_apply(path);
         data->cp_is_valid = FALSE;
         return;
     }
@@ -1198,18 +1548,12 @@ _adg_rescan(AdgPath *path)
     do {
         cpml_primitive_from_segment(&current, &segment);
         do {
-            cpml_primitive_copy(over, last);
-            cpml_primitive_copy(last, &current);
+            _adg_history_push(path, current.org, current.data);
         } while (cpml_primitive_next(&current));
     } while (cpml_segment_next(&segment));
 
-    /* Save the last point in the current point */
-    data->cp_is_valid = last->data && last->data->header.type != CPML_CLOSE;
-    if (data->cp_is_valid) {
-        CpmlPrimitiveType type = last->data->header.type;
-        size_t n = type == CPML_MOVE ? 1 : cpml_primitive_type_get_n_points(type) - 1;
-        cpml_pair_from_cairo(&data->cp, &last->data[n]);
-    }
+    _adg_history_apply(path);
+    _adg_update_cp(path);
 }
 
 static void
@@ -1219,39 +1563,39 @@ _adg_append_primitive(AdgPath *path, CpmlPrimitive *current)
     cairo_path_data_t *path_data = current->data;
     int length = path_data->header.length;
     CpmlPrimitiveType type = path_data->header.type;
-    gconstpointer old_data;
-    gpointer new_data;
+    gint offset;
+
+    /* A pending operation modifies the last primitive too, so the
+     * converted path must be retained only up to its start */
+    if (data->operation.action != ADG_ACTION_NONE && data->last.data != NULL)
+        offset = data->last.data - (cairo_path_data_t *) data->cairo.array->data;
+    else
+        offset = data->cairo.array->len;
 
     /* Execute any pending operation */
     _adg_do_operation(path, path_data);
 
     /* Append the path data to the internal path array */
-    old_data = (data->cairo.array)->data;
     data->cairo.array = g_array_append_vals(data->cairo.array,
                                             path_data, length);
-    new_data = (data->cairo.array)->data;
 
     /* Set path data to point to the recently appended cairo_path_data_t
      * primitive: the first struct is the header */
-    path_data = (cairo_path_data_t *) new_data +
+    path_data = (cairo_path_data_t *) (data->cairo.array)->data +
                 (data->cairo.array)->len - length;
 
-    if (type == CPML_MOVE) {
-        /* Remap last and over, but do not change their content */
-        _adg_primitive_remap(&data->last, new_data, &data->last, old_data);
-        _adg_primitive_remap(&data->over, new_data, &data->over, old_data);
-    } else {
-        /* Store the last primitive into over */
-        _adg_primitive_remap(&data->over, new_data, &data->last, old_data);
-
-        /* Set the last primitive for subsequent binary operations */
+    if (type != CPML_MOVE) {
+        /* Push the new last primitive for subsequent binary operations:
+         * the old last primitive becomes the over one */
         /* TODO: the assumption path_data - 1 is the last point is not true
          * e.g. when there are embedded data in primitives */
-        data->last.org = data->cp_is_valid ? path_data - 1 : NULL;
-        data->last.segment = NULL;
-        data->last.data = path_data;
+        _adg_history_push(path, data->cp_is_valid ? path_data - 1 : NULL,
+                          path_data);
     }
 
+    /* Remap last and over, as the array could have been relocated */
+    _adg_history_apply(path);
+
     data->cp_is_valid = type != CPML_CLOSE;
     if (data->cp_is_valid) {
         /* Save the last point in the current point */
@@ -1259,8 +1603,8 @@ _adg_append_primitive(AdgPath *path, CpmlPrimitive *current)
         cpml_pair_from_cairo(&data->cp, &path_data[n]);
     }
 
-    /* Invalidate cairo_path: should be recomputed */
-    _adg_clear_parent((AdgModel *) path);
+    /* Invalidate cairo_path: only the new tail should be recomputed */
+    _adg_clear_from(path, offset);
 }
 
 static void
@@ -1338,6 +1682,7 @@ _adg_append_operation(AdgPath *path, gint action, ...)
         cairo_path_data_t *path_data;
         CpmlSegment segment;
         CpmlPrimitive current;
+        gint offset;
 
         length = data->cairo.array->len;
 
@@ -1356,17 +1701,23 @@ _adg_append_operation(AdgPath *path, gint action, ...)
             ;
         cpml_primitive_from_segment(&current, &segment);
 
+        /* The action changes the first point of the segment */
+        offset = segment.data - path_data;
+
         /* Convert close path to a line-to primitive */
         ++data->cairo.array->len;
         path_data[length - 1].header.type = CPML_LINE;
         path_data[length - 1].header.length = 2;
         path_data[length] = *current.org;
 
+        /* Remap over too, as the array could have been relocated */
+        _adg_history_apply(path);
         data->last.segment = &segment;
         data->last.org = &path_data[length - 2];
         data->last.data = &path_data[length - 1];
 
         _adg_do_action(path, real_action, &current);
+        _adg_clear_from(path, offset);
     }
 
     return TRUE;
@@ -1549,44 +1900,35 @@ _adg_action_name(AdgAction action)
 }
 
 static void
-_adg_get_named_pair(AdgModel *model, const gchar *name,
-                    CpmlPair *pair, gpointer user_data)
+_adg_copy_named_pair(AdgModel *model, const gchar *name,
+                     CpmlPair *pair, gpointer user_data)
 {
-    GSList **named_pairs;
-    AdgNamedPair *named_pair;
-
-    named_pairs = user_data;
-
-    named_pair = g_new(AdgNamedPair, 1);
-    named_pair->name = name;
-    named_pair->pair = *pair;
-
-    *named_pairs = g_slist_prepend(*named_pairs, named_pair);
+    AdgModel *dst = (AdgModel *) user_data;
+    adg_model_set_named_pair_quark(dst, g_quark_from_string(name), pair);
 }
 
 static void
-_adg_dup_reverse_named_pairs(AdgModel *model, const cairo_matrix_t *matrix)
+_adg_reverse_named_pair(AdgModel *model, const gchar *name,
+                        CpmlPair *pair, gpointer user_data)
 {
-    AdgNamedPair *old_named_pair;
-    AdgNamedPair named_pair;
-    GSList *named_pairs;
-
-    /* Populate named_pairs with all the named pairs of model */
-    named_pairs = NULL;
-    adg_model_foreach_named_pair(model, _adg_get_named_pair, &named_pairs);
-
-    /* Readd the pairs applying the reversing transformation matrix to
-     * their coordinates and prepending a "-" to their name */
-    while (named_pairs) {
-        old_named_pair = named_pairs->data;
-
-        named_pair.name = g_strdup_printf("-%s", old_named_pair->name);
-        named_pair.pair = old_named_pair->pair;
-        cpml_pair_transform(&named_pair.pair, matrix);
-
-        adg_model_set_named_pair(model, named_pair.name, &named_pair.pair);
-
-        g_free((gpointer) named_pair.name);
-        named_pairs = g_slist_delete_link(named_pairs, named_pairs);
-    }
+    const cairo_matrix_t *matrix = (const cairo_matrix_t *) user_data;
+    gchar buffer[128];
+    gchar *reversed;
+    CpmlPair reversed_pair;
+
+    /* Use a stack buffer for the new name: fallback to the heap
+     * only for unreasonably long names */
+    if (g_snprintf(buffer, sizeof(buffer), "-%s", name) < (gint) sizeof(buffer))
+        reversed = buffer;
+    else
+        reversed = g_strconcat("-", name, NULL);
+
+    /* @pair is owned by model and can be relocated by the next call */
+    reversed_pair = *pair;
+    cpml_pair_transform(&reversed_pair, matrix);
+    adg_model_set_named_pair_quark(model, g_quark_from_string(reversed),
+                                   &reversed_pair);
+
+    if (reversed != buffer)
+        g_free(reversed);
 }
@@ -35,9 +35,11 @@ G_BEGIN_DECLS
 #define ADG_IS_PATH(obj)          (G_TYPE_CHECK_INSTANCE_TYPE((obj), ADG_TYPE_PATH))
 #define ADG_IS_PATH_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass), ADG_TYPE_PATH))
 #define ADG_PATH_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS((obj), ADG_TYPE_PATH, AdgPathClass))
+#define ADG_TYPE_PATH_SNAPSHOT    (adg_path_snapshot_get_type())
 
 typedef struct _AdgPath        AdgPath;
 typedef struct _AdgPathClass   AdgPathClass;
+typedef struct _AdgPathSnapshot AdgPathSnapshot;
 
 struct _AdgPath {
     /*< private >*/
@@ -134,6 +136,15 @@ void            adg_path_reflect_explicit       (AdgPath        *path,
                                                  gdouble         x,
                                                  gdouble         y);
 
+GType           adg_path_snapshot_get_type      (void);
+AdgPathSnapshot *
+                adg_path_snapshot_ref           (AdgPathSnapshot*snapshot);
+void            adg_path_snapshot_unref         (AdgPathSnapshot*snapshot);
+AdgPathSnapshot *
+                adg_path_snapshot               (AdgPath        *path);
+void            adg_path_restore                (AdgPath        *path,
+                                                 AdgPathSnapshot*snapshot);
+
 G_END_DECLS
 
 
@@ -49,16 +49,25 @@
 #include <string.h>
 
 #include "adg-point.h"
+#include "adg-pool-private.h"
 
 
 struct _AdgPoint {
-    CpmlPair     pair;
-    AdgModel    *model;
-    gchar       *name;
-    gboolean     up_to_date;
+    CpmlPair        pair;
+    AdgModel       *model;
+    GQuark          name;
+    gboolean        up_to_date;
+
+    /* Named pair lookup cache, valid while the model
+     * generation is still equal to generation */
+    const CpmlPair *cached;
+    guint           generation;
 };
 
 
+static AdgPool          _adg_point_pool = ADG_POOL_INIT(AdgPoint);
+
+
 GType
 adg_point_get_type(void)
 {
@@ -85,7 +94,7 @@ adg_point_get_type(void)
 AdgPoint *
 adg_point_new(void)
 {
-    return g_new0(AdgPoint, 1);
+    return _adg_pool_alloc0(&_adg_point_pool);
 }
 
 /**
@@ -105,17 +114,12 @@ adg_point_new(void)
 AdgPoint *
 adg_point_dup(const AdgPoint *src)
 {
-    AdgPoint *point;
-
     g_return_val_if_fail(src != NULL, NULL);
 
     if (src->model)
         g_object_ref(src->model);
 
-    point = cpml_memdup(src, sizeof(AdgPoint));
-    point->name = g_strdup(src->name);
-
-    return point;
+    return _adg_pool_dup(&_adg_point_pool, src);
 }
 
 /**
@@ -133,7 +137,7 @@ adg_point_destroy(AdgPoint *point)
     g_return_if_fail(point != NULL);
 
     adg_point_unset(point);
-    g_free(point);
+    _adg_pool_free(&_adg_point_pool, point);
 }
 
 /**
@@ -160,11 +164,7 @@ adg_point_copy(AdgPoint *point, const AdgPoint *src)
     if (point->model != NULL)
         g_object_unref(point->model);
 
-    if (point->name != NULL)
-        g_free(point->name);
-
     memcpy(point, src, sizeof(AdgPoint));
-    point->name = g_strdup(src->name);
 }
 
 /**
@@ -231,7 +231,7 @@ adg_point_set_pair_from_model(AdgPoint *point,
     g_return_if_fail(name != NULL);
 
     /* Return if the new named pair is the same of the old one */
-    if (model == point->model && strcmp(point->name, name) == 0)
+    if (model == point->model && point->name == g_quark_try_string(name))
         return;
 
     g_object_ref(model);
@@ -239,13 +239,13 @@ adg_point_set_pair_from_model(AdgPoint *point,
     if (point->model) {
         /* Remove the old named pair */
         g_object_unref(point->model);
-        g_free(point->name);
     }
 
     /* Set the new named pair */
     point->up_to_date = FALSE;
     point->model = model;
-    point->name = g_strdup(name);
+    point->name = g_quark_from_string(name);
+    point->cached = NULL;
 }
 
 /**
@@ -287,12 +287,12 @@ adg_point_unset(AdgPoint *point)
     if (point->model) {
         /* Remove the old named pair */
         g_object_unref(point->model);
-        g_free(point->name);
     }
 
     point->up_to_date = FALSE;
     point->model = NULL;
-    point->name = NULL;
+    point->name = 0;
+    point->cached = NULL;
 }
 
 /**
@@ -303,6 +303,10 @@ adg_point_unset(AdgPoint *point)
  * implementation is protected against multiple calls so it
  * can be called more times without harms.
  *
+ * The named pair lookup is cached: as long as the generation of the
+ * bound model (see adg_model_get_generation()) does not change, the
+ * update is reduced to a simple integer comparison.
+ *
  * Returns: <constant>TRUE</constant> if @point has been updated or <constant>FALSE</constant> on errors, i.e. when it is bound to a non-existent named pair.
  *
  * Since: 1.0
@@ -311,7 +315,7 @@ gboolean
 adg_point_update(AdgPoint *point)
 {
     AdgModel *model;
-    const CpmlPair *pair;
+    guint generation;
 
     g_return_val_if_fail(point != NULL, FALSE);
 
@@ -327,11 +331,16 @@ adg_point_update(AdgPoint *point)
         return FALSE;
     }
 
-    pair = adg_model_get_named_pair(model, point->name);
-    if (pair == NULL)
-        return FALSE;
+    generation = adg_model_get_generation(model);
+    if (point->cached == NULL || generation == 0 ||
+        generation != point->generation) {
+        point->cached = adg_model_get_named_pair_quark(model, point->name);
+        point->generation = generation;
+        if (point->cached == NULL)
+            return FALSE;
+    }
 
-    cpml_pair_copy(&point->pair, pair);
+    cpml_pair_copy(&point->pair, point->cached);
     point->up_to_date = TRUE;
     return TRUE;
 }
@@ -391,7 +400,7 @@ adg_point_get_model(const AdgPoint *point)
  *
  * Gets the name of the named pair bound to @point, or
  * returns <constant>NULL</constant> if @point is an explicit
- * pair. The returned value is owned by @point and should not
+ * pair. The returned value is an interned string and should not
  * be modified or freed.
  *
  * Returns: the name of the named pair or <constant>NULL</constant>.
@@ -402,7 +411,7 @@ const gchar *
 adg_point_get_name(const AdgPoint *point)
 {
     g_return_val_if_fail(point != NULL, NULL);
-    return point->name;
+    return g_quark_to_string(point->name);
 }
 
 /**
@@ -447,7 +456,7 @@ adg_point_equal(const AdgPoint *point1, const AdgPoint *point2)
 
     /* Handle points bound to named pairs */
     if (point1->model != NULL)
-        return g_strcmp0(point1->name, point2->name) == 0;
+        return point1->name == point2->name;
 
     /* Handle points with explicit coordinates */
     return cpml_pair_equal(&point1->pair, &point2->pair);
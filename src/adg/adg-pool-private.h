@@ -0,0 +1,63 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2022  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+
+#ifndef __ADG_POOL_PRIVATE_H__
+#define __ADG_POOL_PRIVATE_H__
+
+
+G_BEGIN_DECLS
+
+typedef struct _AdgPool AdgPool;
+
+/* A pool of blocks of the same size. Blocks are carved out of chunks
+ * allocated in bulk and recycled through a free list, so creating and
+ * destroying a lot of small boxed values does not hit the general
+ * allocator. Chunks are never released: a pool grows up to the peak
+ * number of blocks alive at the same time. */
+struct _AdgPool {
+    gsize       size;
+    gsize       block_size;
+    gpointer    free_list;
+    GSList     *chunks;
+    guint       n_used;
+};
+
+/* Blocks are rounded up to a multiple of gdouble, so any struct of
+ * doubles and pointers is properly aligned and has room for the link
+ * of the free list */
+#define ADG_POOL_INIT(type) \
+    { sizeof(type), \
+      ((sizeof(type) + sizeof(gdouble) - 1) / sizeof(gdouble)) * sizeof(gdouble), \
+      NULL, NULL, 0 }
+
+
+gpointer                _adg_pool_alloc         (AdgPool        *pool);
+gpointer                _adg_pool_alloc0        (AdgPool        *pool);
+gpointer                _adg_pool_dup           (AdgPool        *pool,
+                                                 gconstpointer   src);
+void                    _adg_pool_free          (AdgPool        *pool,
+                                                 gpointer        block);
+
+G_END_DECLS
+
+
+#endif /* __ADG_POOL_PRIVATE_H__ */
@@ -0,0 +1,139 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2022  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+
+
+/*
+ * Fixed size block allocator used by the small boxed types of ADG
+ * (AdgPoint, AdgDash, AdgTableRow, AdgTableCell), by the temporary
+ * pairs built while computing AdgEdges and by the generic matrices of
+ * the entities.
+ *
+ * Setting the ADG_POOL environment variable to "0" makes every pool
+ * a thin wrapper around g_malloc() and g_free(), so memory checkers
+ * can track the single blocks. The variable is read only once, before
+ * the first allocation.
+ */
+
+
+#include "adg-internal.h"
+#include <string.h>
+
+#include "adg-pool-private.h"
+
+#define _ADG_POOL_CHUNK_SIZE    4096
+
+
+G_LOCK_DEFINE_STATIC(_adg_pool);
+
+static gint             _adg_pool_enabled = -1;
+
+
+static gboolean
+_adg_pool_is_enabled(void)
+{
+    if (G_UNLIKELY(_adg_pool_enabled < 0))
+        _adg_pool_enabled = g_strcmp0(g_getenv("ADG_POOL"), "0") != 0;
+
+    return _adg_pool_enabled;
+}
+
+/* Splits a new chunk into blocks and chains them to the free list */
+static void
+_adg_pool_grow(AdgPool *pool)
+{
+    guint n_blocks = MAX(_ADG_POOL_CHUNK_SIZE / pool->block_size, 1);
+    gchar *chunk = g_malloc(pool->block_size * n_blocks);
+    gchar *block;
+    guint n;
+
+    pool->chunks = g_slist_prepend(pool->chunks, chunk);
+
+    for (n = n_blocks; n > 0; --n) {
+        block = chunk + pool->block_size * (n - 1);
+        * (gpointer *) block = pool->free_list;
+        pool->free_list = block;
+    }
+}
+
+gpointer
+_adg_pool_alloc(AdgPool *pool)
+{
+    gpointer block;
+
+    G_LOCK(_adg_pool);
+
+    if (! _adg_pool_is_enabled()) {
+        G_UNLOCK(_adg_pool);
+        return g_malloc(pool->block_size);
+    }
+
+    if (pool->free_list == NULL)
+        _adg_pool_grow(pool);
+
+    block = pool->free_list;
+    pool->free_list = * (gpointer *) block;
+    ++pool->n_used;
+
+    G_UNLOCK(_adg_pool);
+
+    return block;
+}
+
+gpointer
+_adg_pool_alloc0(AdgPool *pool)
+{
+    gpointer block = _adg_pool_alloc(pool);
+
+    memset(block, 0, pool->size);
+
+    return block;
+}
+
+gpointer
+_adg_pool_dup(AdgPool *pool, gconstpointer src)
+{
+    gpointer block = _adg_pool_alloc(pool);
+
+    memcpy(block, src, pool->size);
+
+    return block;
+}
+
+void
+_adg_pool_free(AdgPool *pool, gpointer block)
+{
+    if (block == NULL)
+        return;
+
+    G_LOCK(_adg_pool);
+
+    if (! _adg_pool_is_enabled()) {
+        G_UNLOCK(_adg_pool);
+        g_free(block);
+        return;
+    }
+
+    * (gpointer *) block = pool->free_list;
+    pool->free_list = block;
+    --pool->n_used;
+
+    G_UNLOCK(_adg_pool);
+}
@@ -0,0 +1,50 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2022  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef __ADG_PROFILE_PRIVATE_H__
+#define __ADG_PROFILE_PRIVATE_H__
+
+
+G_BEGIN_DECLS
+
+typedef enum {
+    ADG_PROFILE_ARRANGE,
+    ADG_PROFILE_RENDER
+} AdgProfileStep;
+
+
+extern gboolean         _adg_profiling;
+extern gboolean         _adg_tracing;
+
+void                    _adg_profile_init       (void);
+gint64                  _adg_profile_begin      (void);
+void                    _adg_profile_end        (AdgEntity      *entity,
+                                                 AdgProfileStep  step,
+                                                 gint64          start);
+void                    _adg_profile_cache      (AdgEntity      *entity,
+                                                 gboolean        hit);
+guint                   _adg_trace_begin        (gpointer        object,
+                                                 const gchar    *event);
+void                    _adg_trace_end          (guint           n_event);
+
+G_END_DECLS
+
+
+#endif /* __ADG_PROFILE_PRIVATE_H__ */
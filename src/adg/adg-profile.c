@@ -0,0 +1,561 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2022  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/**
+ * SECTION:adg-profile
+ * @Section_Id:profiler
+ * @title: Profiler
+ * @short_description: Per-type timing of the arrange and render phases
+ *
+ * The profiler measures the time spent by every entity in the arrange
+ * and render phases, collecting the results per #GType. It is disabled
+ * by default: enable it with adg_switch_profile() or by setting the
+ * <envar>ADG_PROFILE</envar> environment variable before the first
+ * entity is created. If the value of <envar>ADG_PROFILE</envar> is
+ * neither empty nor <literal>1</literal>, it is considered a file name
+ * and the JSON report (see adg_profile_to_json()) is saved there when
+ * the program exits.
+ *
+ * The phases of an entity usually include the phases of its children
+ * (e.g. the render phase of an #AdgContainer renders all the contained
+ * entities), so both the inclusive and the self times are collected.
+ * All the times are expressed in microseconds of monotonic clock.
+ *
+ * A separate tracer records the invalidation cascades, that is every
+ * #AdgEntity::invalidate, #AdgEntity::global-changed,
+ * #AdgEntity::local-changed and #AdgModel::changed event, together with
+ * the object that originated the cascade and its nesting depth. Enable
+ * it with adg_switch_trace() or by setting the <envar>ADG_TRACE</envar>
+ * environment variable, with the same semantic of
+ * <envar>ADG_PROFILE</envar>: when set to a file name, the trace is saved
+ * there at exit in the Chrome trace event format (see
+ * adg_trace_to_json()). Every traced event is also logged with
+ * g_debug(), so running the program with
+ * <envar>G_MESSAGES_DEBUG</envar> set to <literal>adg</literal> shows the
+ * cascades as they happen.
+ *
+ * Since: 1.0
+ **/
+
+/**
+ * AdgProfileStats:
+ * @type:              the type these statistics refer to
+ * @arrange_count:     number of arrange phases
+ * @arrange_time:      total time spent arranging, children included
+ * @arrange_self_time: total time spent arranging, children excluded
+ * @arrange_max_time:  longest arrange phase, children included
+ * @render_count:      number of render phases
+ * @render_time:       total time spent rendering, children included
+ * @render_self_time:  total time spent rendering, children excluded
+ * @render_max_time:   longest render phase, children included
+ * @cache_hits:        renderings served by the retained rendering cache
+ * @cache_misses:      renderings that had to (re)build the retained output
+ *
+ * The statistics collected by the profiler for a specific #GType.
+ * The times are expressed in microseconds.
+ *
+ * Since: 1.0
+ **/
+
+
+#include "adg-internal.h"
+#include <stdlib.h>
+
+#include "adg-profile.h"
+#include "adg-profile-private.h"
+
+
+typedef struct {
+    const gchar *name;
+    gpointer     object;
+    GType        type;
+    gpointer     origin;
+    GType        origin_type;
+    guint        depth;
+    gint64       ts;
+    gint64       dur;
+} AdgTraceEvent;
+
+
+gboolean                _adg_profiling = FALSE;
+gboolean                _adg_tracing = FALSE;
+static GHashTable *     _adg_stats = NULL;
+static GArray *         _adg_frames = NULL;
+static gchar *          _adg_report_file = NULL;
+static GArray *         _adg_events = NULL;
+static guint            _adg_trace_depth = 0;
+static gpointer         _adg_trace_origin = NULL;
+static GType            _adg_trace_origin_type = 0;
+static gchar *          _adg_trace_file = NULL;
+
+
+static AdgProfileStats *
+_adg_get_stats(GType type)
+{
+    AdgProfileStats *stats;
+
+    if (_adg_stats == NULL)
+        _adg_stats = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+
+    stats = g_hash_table_lookup(_adg_stats, GSIZE_TO_POINTER(type));
+    if (stats == NULL) {
+        stats = g_new0(AdgProfileStats, 1);
+        stats->type = type;
+        g_hash_table_insert(_adg_stats, GSIZE_TO_POINTER(type), stats);
+    }
+
+    return stats;
+}
+
+static gint
+_adg_compare_stats(gconstpointer a, gconstpointer b)
+{
+    const AdgProfileStats *stats_a = a;
+    const AdgProfileStats *stats_b = b;
+    gint64 self_a = stats_a->arrange_self_time + stats_a->render_self_time;
+    gint64 self_b = stats_b->arrange_self_time + stats_b->render_self_time;
+
+    /* Most expensive types first */
+    if (self_a != self_b)
+        return self_a > self_b ? -1 : 1;
+
+    return g_strcmp0(g_type_name(stats_a->type), g_type_name(stats_b->type));
+}
+
+static void
+_adg_append_step(GString *json, const gchar *name, guint count,
+                 gint64 time, gint64 self_time, gint64 max_time)
+{
+    g_string_append_printf(json,
+                           "\"%s\":{\"count\":%u,\"time\":%" G_GINT64_FORMAT
+                           ",\"self\":%" G_GINT64_FORMAT
+                           ",\"max\":%" G_GINT64_FORMAT "}",
+                           name, count, time, self_time, max_time);
+}
+
+static void
+_adg_save(const gchar *file, gchar *json)
+{
+    GError *error = NULL;
+
+    if (! g_file_set_contents(file, json, -1, &error)) {
+        g_warning(_("%s: unable to save '%s' (%s)"),
+                  G_STRLOC, file, error->message);
+        g_error_free(error);
+    }
+
+    g_free(json);
+}
+
+static void
+_adg_save_report(void)
+{
+    _adg_save(_adg_report_file, adg_profile_to_json());
+}
+
+static void
+_adg_save_trace(void)
+{
+    _adg_save(_adg_trace_file, adg_trace_to_json());
+}
+
+
+/**
+ * adg_switch_profile:
+ * @state: new profiler state
+ *
+ * Enables (if @state is <constant>TRUE</constant>) or disables the
+ * profiler. Disabling the profiler does not clear the statistics
+ * already collected: use adg_profile_reset() for that purpose.
+ *
+ * Since: 1.0
+ **/
+void
+adg_switch_profile(gboolean state)
+{
+    _adg_profiling = state;
+}
+
+/**
+ * adg_profile_is_enabled:
+ *
+ * Checks whether the profiler is collecting statistics.
+ *
+ * Returns: <constant>TRUE</constant> if the profiler is enabled.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_profile_is_enabled(void)
+{
+    return _adg_profiling;
+}
+
+/**
+ * adg_profile_reset:
+ *
+ * Clears all the statistics collected so far.
+ *
+ * Since: 1.0
+ **/
+void
+adg_profile_reset(void)
+{
+    if (_adg_stats != NULL)
+        g_hash_table_remove_all(_adg_stats);
+}
+
+/**
+ * adg_profile_get_stats:
+ * @n_stats: (out): where to store the number of returned items
+ *
+ * Gets a snapshot of the statistics collected so far, one item per
+ * profiled #GType. The items are sorted by decreasing self time, so
+ * the most expensive types come first.
+ *
+ * Returns: (transfer full) (array length=n_stats): a newly allocated array of statistics to be freed with g_free() or <constant>NULL</constant> if nothing has been collected.
+ *
+ * Since: 1.0
+ **/
+AdgProfileStats *
+adg_profile_get_stats(guint *n_stats)
+{
+    AdgProfileStats *array;
+    GHashTableIter iter;
+    gpointer stats;
+    guint n;
+
+    g_return_val_if_fail(n_stats != NULL, NULL);
+
+    *n_stats = _adg_stats == NULL ? 0 : g_hash_table_size(_adg_stats);
+    if (*n_stats == 0)
+        return NULL;
+
+    array = g_new(AdgProfileStats, *n_stats);
+    n = 0;
+    g_hash_table_iter_init(&iter, _adg_stats);
+    while (g_hash_table_iter_next(&iter, NULL, &stats))
+        array[n++] = * (AdgProfileStats *) stats;
+
+    qsort(array, n, sizeof(AdgProfileStats), _adg_compare_stats);
+
+    return array;
+}
+
+/**
+ * adg_profile_to_json:
+ *
+ * Builds a JSON report of the statistics collected so far. The report
+ * is an object with a <literal>types</literal> array, where every item
+ * mirrors an #AdgProfileStats struct, e.g.:
+ *
+ * <informalexample><programlisting>
+ * {"types":[{"type":"AdgLDim",
+ *   "arrange":{"count":1,"time":512,"self":140,"max":512},
+ *   "render":{"count":1,"time":830,"self":95,"max":830},
+ *   "cache":{"hits":0,"misses":0}}]}
+ * </programlisting></informalexample>
+ *
+ * Returns: (transfer full): a newly allocated string to be freed with g_free().
+ *
+ * Since: 1.0
+ **/
+gchar *
+adg_profile_to_json(void)
+{
+    AdgProfileStats *array, *stats;
+    GString *json;
+    guint n, n_stats;
+
+    array = adg_profile_get_stats(&n_stats);
+    json = g_string_new("{\"types\":[");
+
+    for (n = 0; n < n_stats; ++n) {
+        stats = &array[n];
+        if (n > 0)
+            g_string_append_c(json, ',');
+
+        /* GType names are plain identifiers: no escaping is needed */
+        g_string_append_printf(json, "{\"type\":\"%s\",",
+                               g_type_name(stats->type));
+        _adg_append_step(json, "arrange", stats->arrange_count,
+                         stats->arrange_time, stats->arrange_self_time,
+                         stats->arrange_max_time);
+        g_string_append_c(json, ',');
+        _adg_append_step(json, "render", stats->render_count,
+                         stats->render_time, stats->render_self_time,
+                         stats->render_max_time);
+        g_string_append_printf(json, ",\"cache\":{\"hits\":%u,\"misses\":%u}}",
+                               stats->cache_hits, stats->cache_misses);
+    }
+
+    g_string_append(json, "]}");
+    g_free(array);
+
+    return g_string_free(json, FALSE);
+}
+
+/**
+ * adg_switch_trace:
+ * @state: new tracer state
+ *
+ * Enables (if @state is <constant>TRUE</constant>) or disables the
+ * tracing of the invalidation cascades. Disabling the tracer does not
+ * clear the events already recorded: use adg_trace_reset() for that
+ * purpose.
+ *
+ * Since: 1.0
+ **/
+void
+adg_switch_trace(gboolean state)
+{
+    _adg_tracing = state;
+}
+
+/**
+ * adg_trace_is_enabled:
+ *
+ * Checks whether the invalidation cascades are being traced.
+ *
+ * Returns: <constant>TRUE</constant> if the tracer is enabled.
+ *
+ * Since: 1.0
+ **/
+gboolean
+adg_trace_is_enabled(void)
+{
+    return _adg_tracing;
+}
+
+/**
+ * adg_trace_reset:
+ *
+ * Clears all the events recorded so far.
+ *
+ * Since: 1.0
+ **/
+void
+adg_trace_reset(void)
+{
+    if (_adg_events != NULL)
+        g_array_set_size(_adg_events, 0);
+}
+
+/**
+ * adg_trace_get_n_events:
+ *
+ * Gets the number of events recorded so far.
+ *
+ * Returns: the number of traced events.
+ *
+ * Since: 1.0
+ **/
+guint
+adg_trace_get_n_events(void)
+{
+    return _adg_events == NULL ? 0 : _adg_events->len;
+}
+
+/**
+ * adg_trace_to_json:
+ *
+ * Builds a report of the events recorded so far in the Chrome trace
+ * event format, so it can be loaded by any compatible viewer (e.g.
+ * <literal>chrome://tracing</literal> or Perfetto). Every event is a
+ * complete event whose arguments report the emitting object, the
+ * object that originated the cascade and the nesting depth, e.g.:
+ *
+ * <informalexample><programlisting>
+ * {"traceEvents":[{"name":"invalidate","cat":"adg","ph":"X",
+ *   "ts":1024,"dur":12,"pid":1,"tid":1,
+ *   "args":{"object":"AdgStroke 0x55d0c2e0","origin":"AdgPath 0x55d0a1c0","depth":1}}]}
+ * </programlisting></informalexample>
+ *
+ * Returns: (transfer full): a newly allocated string to be freed with g_free().
+ *
+ * Since: 1.0
+ **/
+gchar *
+adg_trace_to_json(void)
+{
+    const AdgTraceEvent *event;
+    GString *json;
+    guint n;
+
+    json = g_string_new("{\"traceEvents\":[");
+
+    for (n = 0; n < adg_trace_get_n_events(); ++n) {
+        event = &g_array_index(_adg_events, AdgTraceEvent, n);
+        if (n > 0)
+            g_string_append_c(json, ',');
+
+        g_string_append_printf(json,
+                               "{\"name\":\"%s\",\"cat\":\"adg\",\"ph\":\"X\","
+                               "\"ts\":%" G_GINT64_FORMAT
+                               ",\"dur\":%" G_GINT64_FORMAT
+                               ",\"pid\":1,\"tid\":1,\"args\":"
+                               "{\"object\":\"%s %p\",\"origin\":\"%s %p\","
+                               "\"depth\":%u}}",
+                               event->name, event->ts, event->dur,
+                               g_type_name(event->type), event->object,
+                               g_type_name(event->origin_type), event->origin,
+                               event->depth);
+    }
+
+    g_string_append(json, "]}");
+
+    return g_string_free(json, FALSE);
+}
+
+
+/* Checks the ADG_PROFILE and ADG_TRACE environment variables: called
+ * once by AdgEntity while initializing its class */
+void
+_adg_profile_init(void)
+{
+    const gchar *value;
+
+    value = g_getenv("ADG_PROFILE");
+    if (! adg_is_string_empty(value)) {
+        _adg_profiling = TRUE;
+        if (g_strcmp0(value, "1") != 0 && _adg_report_file == NULL) {
+            _adg_report_file = g_strdup(value);
+            atexit(_adg_save_report);
+        }
+    }
+
+    value = g_getenv("ADG_TRACE");
+    if (! adg_is_string_empty(value)) {
+        _adg_tracing = TRUE;
+        if (g_strcmp0(value, "1") != 0 && _adg_trace_file == NULL) {
+            _adg_trace_file = g_strdup(value);
+            atexit(_adg_save_trace);
+        }
+    }
+}
+
+/* Starts measuring a phase: every call must be paired with
+ * _adg_profile_end(), even if the profiler is disabled meanwhile */
+gint64
+_adg_profile_begin(void)
+{
+    gint64 children_time = 0;
+
+    if (_adg_frames == NULL)
+        _adg_frames = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+    g_array_append_val(_adg_frames, children_time);
+    return g_get_monotonic_time();
+}
+
+void
+_adg_profile_end(AdgEntity *entity, AdgProfileStep step, gint64 start)
+{
+    AdgProfileStats *stats;
+    gint64 elapsed, self_time;
+    guint depth;
+
+    elapsed = g_get_monotonic_time() - start;
+    depth = _adg_frames->len - 1;
+    self_time = elapsed - g_array_index(_adg_frames, gint64, depth);
+    g_array_set_size(_adg_frames, depth);
+
+    /* The whole phase is a child of the outer one, if any */
+    if (depth > 0)
+        g_array_index(_adg_frames, gint64, depth - 1) += elapsed;
+
+    if (! _adg_profiling)
+        return;
+
+    stats = _adg_get_stats(G_OBJECT_TYPE(entity));
+
+    if (step == ADG_PROFILE_ARRANGE) {
+        ++stats->arrange_count;
+        stats->arrange_time += elapsed;
+        stats->arrange_self_time += self_time;
+        stats->arrange_max_time = MAX(stats->arrange_max_time, elapsed);
+    } else {
+        ++stats->render_count;
+        stats->render_time += elapsed;
+        stats->render_self_time += self_time;
+        stats->render_max_time = MAX(stats->render_max_time, elapsed);
+    }
+}
+
+void
+_adg_profile_cache(AdgEntity *entity, gboolean hit)
+{
+    AdgProfileStats *stats = _adg_get_stats(G_OBJECT_TYPE(entity));
+
+    if (hit)
+        ++stats->cache_hits;
+    else
+        ++stats->cache_misses;
+}
+
+/* Opens a new traced event on @object: every call must be paired with
+ * _adg_trace_end(). The event is recorded when opened, so the events
+ * are sorted by starting time as required by the trace viewers. */
+guint
+_adg_trace_begin(gpointer object, const gchar *name)
+{
+    AdgTraceEvent event;
+
+    if (_adg_events == NULL)
+        _adg_events = g_array_new(FALSE, FALSE, sizeof(AdgTraceEvent));
+
+    /* An event at depth 0 starts a new cascade */
+    if (_adg_trace_depth == 0) {
+        _adg_trace_origin = object;
+        _adg_trace_origin_type = G_OBJECT_TYPE(object);
+    }
+
+    event.name = name;
+    event.object = object;
+    event.type = G_OBJECT_TYPE(object);
+    event.origin = _adg_trace_origin;
+    event.origin_type = _adg_trace_origin_type;
+    event.depth = _adg_trace_depth;
+    event.ts = g_get_monotonic_time();
+    event.dur = 0;
+
+    g_debug("%*s%s: %s %p (origin %s %p)", event.depth * 2, "", name,
+            g_type_name(event.type), object,
+            g_type_name(event.origin_type), event.origin);
+
+    ++_adg_trace_depth;
+    g_array_append_val(_adg_events, event);
+
+    return _adg_events->len - 1;
+}
+
+void
+_adg_trace_end(guint n_event)
+{
+    AdgTraceEvent *event;
+
+    --_adg_trace_depth;
+
+    /* The event could have been dropped by adg_trace_reset() */
+    if (n_event < _adg_events->len) {
+        event = &g_array_index(_adg_events, AdgTraceEvent, n_event);
+        event->dur = g_get_monotonic_time() - event->ts;
+    }
+}
@@ -0,0 +1,64 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2022  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#if !defined(__ADG_H__)
+#error "Only <adg.h> can be included directly."
+#endif
+
+
+#ifndef __ADG_PROFILE_H__
+#define __ADG_PROFILE_H__
+
+
+G_BEGIN_DECLS
+
+typedef struct _AdgProfileStats AdgProfileStats;
+
+struct _AdgProfileStats {
+    GType       type;
+    guint       arrange_count;
+    gint64      arrange_time;
+    gint64      arrange_self_time;
+    gint64      arrange_max_time;
+    guint       render_count;
+    gint64      render_time;
+    gint64      render_self_time;
+    gint64      render_max_time;
+    guint       cache_hits;
+    guint       cache_misses;
+};
+
+
+void                    adg_switch_profile      (gboolean        state);
+gboolean                adg_profile_is_enabled  (void);
+void                    adg_profile_reset       (void);
+AdgProfileStats *       adg_profile_get_stats   (guint          *n_stats);
+gchar *                 adg_profile_to_json     (void);
+
+void                    adg_switch_trace        (gboolean        state);
+gboolean                adg_trace_is_enabled    (void);
+void                    adg_trace_reset         (void);
+guint                   adg_trace_get_n_events  (void);
+gchar *                 adg_trace_to_json       (void);
+
+G_END_DECLS
+
+
+#endif /* __ADG_PROFILE_H__ */
@@ -75,6 +75,9 @@ static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_memory_size        (AdgEntity      *entity,
+                                                 AdgMemoryStats *stats);
+static AdgEntity *      _adg_clone              (AdgEntity      *entity);
 static gchar *          _adg_default_value      (AdgDim         *dim);
 static gboolean         _adg_compute_geometry   (AdgDim         *dim);
 static void             _adg_update_entities    (AdgRDim        *rdim);
@@ -103,6 +106,8 @@ adg_rdim_class_init(AdgRDimClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_size = _adg_memory_size;
+    entity_class->clone = _adg_clone;
 
     dim_class->default_value = _adg_default_value;
     dim_class->compute_geometry = _adg_compute_geometry;
@@ -446,6 +451,29 @@ _adg_arrange(AdgEntity *entity)
     adg_entity_set_extents(entity, &extents);
 }
 
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgRDimPrivate *data = adg_rdim_get_instance_private((AdgRDim *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    if (adg_entity_account_shared(data->trail))
+        stats->paths += adg_trail_get_memory_size(data->trail);
+
+    if (data->marker != NULL)
+        adg_entity_account_memory((AdgEntity *) data->marker);
+}
+
+static AdgEntity *
+_adg_clone(AdgEntity *entity)
+{
+    /* The private data is only geometry rebuilt while arranging:
+     * this override just enables the typed clone of AdgDim */
+    return _ADG_OLD_ENTITY_CLASS->clone(entity);
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
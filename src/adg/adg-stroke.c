@@ -76,6 +76,9 @@ static void             _adg_local_changed      (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_memory_size        (AdgEntity      *entity,
+                                                 AdgMemoryStats *stats);
+static AdgEntity *      _adg_clone              (AdgEntity      *entity);
 static void             _adg_unset_trail        (AdgStroke      *stroke);
 
 
@@ -97,6 +100,8 @@ adg_stroke_class_init(AdgStrokeClass *klass)
     entity_class->local_changed = _adg_local_changed;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_size = _adg_memory_size;
+    entity_class->clone = _adg_clone;
 
     param = adg_param_spec_dress("line-dress",
                                  P_("Line Dress"),
@@ -185,8 +190,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -298,7 +305,9 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->global_changed)
         _ADG_OLD_ENTITY_CLASS->global_changed(entity);
 
-    adg_entity_invalidate(entity);
+    /* The trail is not affected by the maps: only the extents
+     * must be recomputed, so there is no need to invalidate */
+    adg_entity_set_extents(entity, NULL);
 }
 
 static void
@@ -307,7 +316,7 @@ _adg_local_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->local_changed)
         _ADG_OLD_ENTITY_CLASS->local_changed(entity);
 
-    adg_entity_invalidate(entity);
+    adg_entity_set_extents(entity, NULL);
 }
 
 static void
@@ -334,6 +343,42 @@ _adg_arrange(AdgEntity *entity)
     adg_entity_set_extents(entity, &extents);
 }
 
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgStrokePrivate *data = adg_stroke_get_instance_private((AdgStroke *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    /* A trail can be shared by more strokes: account it once */
+    if (adg_entity_account_shared(data->trail))
+        stats->paths += adg_trail_get_memory_size(data->trail);
+}
+
+static AdgEntity *
+_adg_clone(AdgEntity *entity)
+{
+    AdgStrokePrivate *data, *clone_data;
+    AdgEntity *clone;
+
+    clone = _ADG_OLD_ENTITY_CLASS->clone(entity);
+    data = adg_stroke_get_instance_private((AdgStroke *) entity);
+    clone_data = adg_stroke_get_instance_private((AdgStroke *) clone);
+
+    clone_data->line_dress = data->line_dress;
+
+    /* The trail is shared with the original stroke */
+    if (data->trail != NULL && clone_data->trail == NULL) {
+        clone_data->trail = g_object_ref(data->trail);
+        g_object_weak_ref((GObject *) data->trail,
+                          (GWeakNotify) _adg_unset_trail, clone);
+        adg_model_add_dependency((AdgModel *) data->trail, clone);
+    }
+
+    return clone;
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
@@ -38,9 +38,13 @@
 
 /**
  * AdgStyleClass:
+ * @clone:      virtual method to duplicate the style.
  * @invalidate: virtual method to reset the style.
  * @apply:      abstract virtual to apply a style to a cairo context.
  *
+ * The default @clone copies the readable and writable properties
+ * when the class does not override it.
+ *
  * The default @invalidate handler does not do anything.
  *
  * The virtual method @apply *must* be implemented by any derived class.
@@ -67,10 +71,12 @@ enum {
 };
 
 static void             _adg_dispose            (GObject        *object);
+static AdgStyle *       _adg_clone              (AdgStyle       *style);
 static void             _adg_apply              (AdgStyle       *style,
                                                  AdgEntity      *entity,
                                                  cairo_t        *cr);
 static guint            _adg_signals[LAST_SIGNAL] = { 0 };
+static guint            _adg_serial = 0;
 
 
 static void
@@ -82,7 +88,7 @@ adg_style_class_init(AdgStyleClass *klass)
 
     gobject_class->dispose = _adg_dispose;
 
-    klass->clone = (AdgStyle *(*)(AdgStyle *)) adg_object_clone;
+    klass->clone = _adg_clone;
     klass->invalidate = NULL;
     klass->apply = _adg_apply;
 
@@ -145,6 +151,22 @@ _adg_dispose(GObject *object)
         _ADG_OLD_OBJECT_CLASS->dispose(object);
 }
 
+static AdgStyle *
+_adg_clone(AdgStyle *style)
+{
+    AdgStyleClass *klass, *parent_class;
+
+    klass = ADG_STYLE_GET_CLASS(style);
+    parent_class = g_type_class_peek_parent(klass);
+
+    /* Styles with their own clone method chaining up here
+     * copy their fields directly: skip the property round trip */
+    if (klass->clone != parent_class->clone)
+        return g_object_new(G_OBJECT_TYPE(style), NULL);
+
+    return (AdgStyle *) adg_object_clone((GObject *) style);
+}
+
 
 /**
  * adg_style_invalidate:
@@ -154,6 +176,11 @@ _adg_dispose(GObject *object)
  * is always emitted while disposing @style, so be sure it
  * can be called more than once without harms.
  *
+ * Any rendering retained by the entities (see
+ * adg_canvas_set_cache_budget()) is considered stale after this
+ * call, so implementations must call it whenever a property that
+ * affects the rendering is changed.
+ *
  * <note><para>
  * This function is only useful in new style implementations.
  * </para></note>
@@ -165,9 +192,17 @@ adg_style_invalidate(AdgStyle *style)
 {
     g_return_if_fail(ADG_IS_STYLE(style));
 
+    ++_adg_serial;
     g_signal_emit(style, _adg_signals[INVALIDATE], 0);
 }
 
+/* Serial bumped by any adg_style_invalidate() call */
+guint
+_adg_style_get_serial(void)
+{
+    return _adg_serial;
+}
+
 /**
  * adg_style_clone:
  * @style: (transfer none): an #AdgStyle derived style
@@ -70,6 +70,7 @@
 #include "adg-table.h"
 #include "adg-table-row.h"
 #include "adg-table-cell.h"
+#include "adg-pool-private.h"
 
 
 struct _AdgTableCell {
@@ -93,6 +94,8 @@ static void             _adg_cell_set_value_pos (AdgTableCell   *table_cell,
                                                  const CpmlPair *from_factor,
                                                  const CpmlPair *to_factor);
 
+static AdgPool          _adg_cell_pool = ADG_POOL_INIT(AdgTableCell);
+
 
 GType
 adg_table_cell_get_type(void)
@@ -123,7 +126,7 @@ AdgTableCell *
 adg_table_cell_dup(const AdgTableCell *src)
 {
     g_return_val_if_fail(src != NULL, NULL);
-    return cpml_memdup(src, sizeof(AdgTableCell));
+    return _adg_pool_dup(&_adg_cell_pool, src);
 }
 
 /**
@@ -303,7 +306,7 @@ adg_table_cell_free(AdgTableCell *table_cell)
     }
 
     adg_table_cell_dispose(table_cell);
-    g_free(table_cell);
+    _adg_pool_free(&_adg_cell_pool, table_cell);
 }
 
 /**
@@ -856,7 +859,7 @@ _adg_cell_new(void)
 {
     AdgTableCell *table_cell;
 
-    table_cell = g_new(AdgTableCell, 1);
+    table_cell = _adg_pool_alloc(&_adg_cell_pool);
     table_cell->row = NULL;
     table_cell->width = 0.;
     table_cell->has_frame = FALSE;
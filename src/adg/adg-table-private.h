@@ -39,6 +39,7 @@ struct _AdgTablePrivate {
 
     AdgTableStyle *table_style;
     AdgStroke     *grid;
+    AdgArenaPath   grid_path;
     AdgStroke     *frame;
     GSList        *rows;
     GHashTable    *cell_names;
@@ -52,6 +52,7 @@
 #include "adg-table.h"
 #include "adg-table-row.h"
 #include "adg-table-cell.h"
+#include "adg-pool-private.h"
 
 
 struct _AdgTableRow {
@@ -64,6 +65,8 @@ struct _AdgTableRow {
 
 static AdgTableRow *    _adg_row_new        (AdgTable       *table);
 
+static AdgPool          _adg_row_pool = ADG_POOL_INIT(AdgTableRow);
+
 
 GType
 adg_table_row_get_type(void)
@@ -94,7 +97,7 @@ AdgTableRow *
 adg_table_row_dup(const AdgTableRow *src)
 {
     g_return_val_if_fail(src != NULL, NULL);
-    return cpml_memdup(src, sizeof(AdgTableRow));
+    return _adg_pool_dup(&_adg_row_pool, src);
 }
 
 /**
@@ -176,7 +179,7 @@ adg_table_row_free(AdgTableRow *table_row)
     if (table != NULL)
         adg_table_remove(table, table_row);
 
-    g_free(table_row);
+    _adg_pool_free(&_adg_row_pool, table_row);
 }
 
 /**
@@ -450,7 +453,7 @@ adg_table_row_arrange(AdgTableRow *table_row, const CpmlExtents *layout)
 static AdgTableRow *
 _adg_row_new(AdgTable *table)
 {
-    AdgTableRow *table_row = g_new(AdgTableRow, 1);
+    AdgTableRow *table_row = _adg_pool_alloc(&_adg_row_pool);
 
     table_row->table = table;
     table_row->cells = NULL;
@@ -58,6 +58,7 @@
 #include "adg-alignment.h"
 #include "adg-dress.h"
 #include "adg-param-dress.h"
+#include "adg-arena-private.h"
 
 #include "adg-table.h"
 #include "adg-table-private.h"
@@ -104,15 +105,28 @@ static void         _adg_arrange_frame      (AdgEntity      *entity,
                                              const CpmlExtents *extents);
 static void         _adg_render             (AdgEntity      *entity,
                                              cairo_t        *cr);
+static void         _adg_memory_size        (AdgEntity      *entity,
+                                             AdgMemoryStats *stats);
+static void         _adg_account_cell       (AdgTableCell   *table_cell,
+                                             gpointer        user_data);
 static void         _adg_propagate          (AdgTable       *table,
                                              const gchar    *detailed_signal,
                                              ...);
 static void         _adg_foreach_row        (AdgTableRow    *table_row,
                                              const AdgClosure *closure);
+static cairo_path_t *_adg_grid_callback     (AdgTrail       *trail,
+                                             gpointer        user_data);
+static void         _adg_count_frame        (AdgTableCell   *table_cell,
+                                             gint           *num_data);
 static void         _adg_append_frame       (AdgTableCell   *table_cell,
-                                             AdgPath        *path);
+                                             cairo_path_data_t **path_data);
 static void         _adg_proxy_signal       (AdgTableCell   *table_cell,
                                              AdgProxyData   *proxy_data);
+static void         _adg_propagate_direct   (AdgTable       *table,
+                                             GCallback       callback,
+                                             gpointer        user_data);
+static void         _adg_proxy_direct       (AdgTableCell   *table_cell,
+                                             const AdgClosure *closure);
 static gboolean     _adg_value_match        (gpointer        key,
                                              gpointer        value,
                                              gpointer        user_data);
@@ -139,6 +153,7 @@ adg_table_class_init(AdgTableClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->memory_size = _adg_memory_size;
 
     param = adg_param_spec_dress("table-dress",
                                  P_("Table Dress"),
@@ -163,6 +178,7 @@ adg_table_init(AdgTable *table)
     data->has_frame = TRUE;
     data->table_style = NULL;
     data->grid = NULL;
+    _adg_arena_path_init(&data->grid_path);
     data->frame = NULL;
     data->rows = NULL;
     data->cell_names = NULL;
@@ -205,6 +221,8 @@ _adg_finalize(GObject *object)
     if (data->cell_names)
         g_hash_table_destroy(data->cell_names);
 
+    _adg_arena_path_dispose(&data->grid_path);
+
     if (_ADG_OLD_OBJECT_CLASS->finalize)
         _ADG_OLD_OBJECT_CLASS->finalize(object);
 }
@@ -243,8 +261,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -595,7 +615,8 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->global_changed)
         _ADG_OLD_ENTITY_CLASS->global_changed(entity);
 
-    _adg_propagate((AdgTable *) entity, "global-changed");
+    _adg_propagate_direct((AdgTable *) entity,
+                          G_CALLBACK(adg_entity_global_changed), NULL);
 }
 
 static void
@@ -604,13 +625,15 @@ _adg_local_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->local_changed)
         _ADG_OLD_ENTITY_CLASS->local_changed(entity);
 
-    _adg_propagate((AdgTable *) entity, "local-changed");
+    _adg_propagate_direct((AdgTable *) entity,
+                          G_CALLBACK(adg_entity_local_changed), NULL);
 }
 
 static void
 _adg_invalidate(AdgEntity *entity)
 {
-    _adg_propagate((AdgTable *) entity, "invalidate");
+    _adg_propagate_direct((AdgTable *) entity,
+                          G_CALLBACK(adg_entity_invalidate), NULL);
 }
 
 static void
@@ -669,20 +692,22 @@ _adg_arrange_grid(AdgEntity *entity)
 {
     AdgTable *table = (AdgTable *) entity;
     AdgTablePrivate *data = adg_table_get_instance_private(table);
-    AdgPath *path;
     AdgTrail *trail;
     AdgDress dress;
 
     if (data->grid)
         return;
 
-    path = adg_path_new();
-    trail = (AdgTrail *) path;
-
-    adg_table_foreach_cell(table, (GCallback) _adg_append_frame, path);
+    /* The grid data is built on the arena of the canvas, if any,
+     * by the trail callback: it is rebuilt from the cell extents
+     * whenever the arena has been rewound in the meantime */
+    _adg_arena_path_invalidate(&data->grid_path);
+    trail = adg_trail_new(_adg_grid_callback, table);
 
-    if (!adg_trail_get_extents(trail)->is_defined)
+    if (!adg_trail_get_extents(trail)->is_defined) {
+        g_object_unref(trail);
         return;
+    }
 
     dress = adg_table_style_get_grid_dress(data->table_style);
     data->grid = g_object_new(ADG_TYPE_STROKE,
@@ -690,6 +715,7 @@ _adg_arrange_grid(AdgEntity *entity)
                               "trail", trail,
                               "parent", entity,
                               NULL);
+    g_object_unref(trail);
     adg_entity_arrange((AdgEntity *) data->grid);
 }
 
@@ -727,6 +753,40 @@ _adg_arrange_frame(AdgEntity *entity, const CpmlExtents *extents)
     adg_entity_arrange((AdgEntity *) data->frame);
 }
 
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgTablePrivate *data = adg_table_get_instance_private((AdgTable *) entity);
+
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    if (data->grid != NULL)
+        adg_entity_account_memory((AdgEntity *) data->grid);
+
+    stats->paths += _adg_arena_path_get_size(&data->grid_path);
+
+    if (data->frame != NULL)
+        adg_entity_account_memory((AdgEntity *) data->frame);
+
+    adg_table_foreach_cell((AdgTable *) entity,
+                           (GCallback) _adg_account_cell, NULL);
+}
+
+static void
+_adg_account_cell(AdgTableCell *table_cell, gpointer user_data)
+{
+    AdgEntity *entity;
+
+    entity = adg_table_cell_title(table_cell);
+    if (entity != NULL)
+        adg_entity_account_memory(entity);
+
+    entity = adg_table_cell_value(table_cell);
+    if (entity != NULL)
+        adg_entity_account_memory(entity);
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
@@ -734,7 +794,8 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
 
     adg_style_apply((AdgStyle *) data->table_style, entity, cr);
 
-    _adg_propagate((AdgTable *) entity, "render", cr);
+    _adg_propagate_direct((AdgTable *) entity,
+                          G_CALLBACK(adg_entity_render), cr);
 }
 
 static void
@@ -774,26 +835,68 @@ _adg_foreach_row(AdgTableRow *table_row, const AdgClosure *closure)
     adg_table_row_foreach(table_row, closure->callback, closure->user_data);
 }
 
+static cairo_path_t *
+_adg_grid_callback(AdgTrail *trail, gpointer user_data)
+{
+    AdgTable *table = (AdgTable *) user_data;
+    AdgTablePrivate *data = adg_table_get_instance_private(table);
+    cairo_path_data_t *path_data;
+    gint num_data;
+
+    if (_adg_arena_path_is_valid(&data->grid_path))
+        return &data->grid_path.path;
+
+    num_data = 0;
+    adg_table_foreach_cell(table, (GCallback) _adg_count_frame, &num_data);
+    if (num_data == 0)
+        return NULL;
+
+    path_data = _adg_arena_path_alloc(&data->grid_path, num_data);
+    adg_table_foreach_cell(table, (GCallback) _adg_append_frame, &path_data);
+
+    return &data->grid_path.path;
+}
+
 static void
-_adg_append_frame(AdgTableCell *table_cell, AdgPath *path)
+_adg_count_frame(AdgTableCell *table_cell, gint *num_data)
 {
-    CpmlPair pair;
+    /* A closed rectangle: move_to, three line_to and close_path */
+    if (adg_table_cell_has_frame(table_cell))
+        *num_data += 9;
+}
+
+static void
+_adg_append_frame(AdgTableCell *table_cell, cairo_path_data_t **path_data)
+{
+    cairo_path_data_t *p;
     const CpmlExtents *extents;
 
     if (! adg_table_cell_has_frame(table_cell))
         return;
 
     extents = adg_table_cell_get_extents(table_cell);
-
-    cpml_pair_copy(&pair, &extents->org);
-    adg_path_move_to(path, &pair);
-    pair.x += extents->size.x;
-    adg_path_line_to(path, &pair);
-    pair.y += extents->size.y;
-    adg_path_line_to(path, &pair);
-    pair.x -= extents->size.x;
-    adg_path_line_to(path, &pair);
-    adg_path_close(path);
+    p = *path_data;
+
+    p[0].header.type = CPML_MOVE;
+    p[0].header.length = 2;
+    p[1].point.x = extents->org.x;
+    p[1].point.y = extents->org.y;
+    p[2].header.type = CPML_LINE;
+    p[2].header.length = 2;
+    p[3].point.x = extents->org.x + extents->size.x;
+    p[3].point.y = extents->org.y;
+    p[4].header.type = CPML_LINE;
+    p[4].header.length = 2;
+    p[5].point.x = extents->org.x + extents->size.x;
+    p[5].point.y = extents->org.y + extents->size.y;
+    p[6].header.type = CPML_LINE;
+    p[6].header.length = 2;
+    p[7].point.x = extents->org.x;
+    p[7].point.y = extents->org.y + extents->size.y;
+    p[8].header.type = CPML_CLOSE;
+    p[8].header.length = 1;
+
+    *path_data = p + 9;
 }
 
 static void
@@ -820,6 +923,39 @@ _adg_proxy_signal(AdgTableCell *table_cell, AdgProxyData *proxy_data)
     }
 }
 
+static void
+_adg_propagate_direct(AdgTable *table, GCallback callback, gpointer user_data)
+{
+    AdgTablePrivate *data = adg_table_get_instance_private(table);
+    AdgClosure closure = { callback, user_data };
+
+    /* Used instead of _adg_propagate() for the entity methods with
+     * a fast path: no signal lookup and no variadic copies needed */
+    if (data->frame)
+        ((void (*) (gpointer, gpointer)) callback) (data->frame, user_data);
+
+    if (data->grid)
+        ((void (*) (gpointer, gpointer)) callback) (data->grid, user_data);
+
+    adg_table_foreach_cell(table, (GCallback) _adg_proxy_direct, &closure);
+}
+
+static void
+_adg_proxy_direct(AdgTableCell *table_cell, const AdgClosure *closure)
+{
+    AdgEntity *entity;
+
+    entity = adg_table_cell_title(table_cell);
+    if (entity)
+        ((void (*) (gpointer, gpointer)) closure->callback)
+            (adg_entity_get_parent(entity), closure->user_data);
+
+    entity = adg_table_cell_value(table_cell);
+    if (entity)
+        ((void (*) (gpointer, gpointer)) closure->callback)
+            (adg_entity_get_parent(entity), closure->user_data);
+}
+
 static gboolean
 _adg_value_match(gpointer key, gpointer value, gpointer user_data)
 {
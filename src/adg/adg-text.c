@@ -58,6 +58,8 @@
 #include "adg-text.h"
 #include "adg-text-private.h"
 
+#include <string.h>
+
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_text_parent_class)
 #define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_text_parent_class)
@@ -93,6 +95,10 @@ static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_memory_size        (AdgEntity      *entity,
+                                                 AdgMemoryStats *stats);
+static void             _adg_render_proxy       (AdgEntity      *entity,
+                                                 cairo_t        *cr);
 static void             _adg_set_font_dress     (AdgTextual     *textual,
                                                  AdgDress        dress);
 static AdgDress         _adg_get_font_dress     (AdgTextual     *textual);
@@ -122,6 +128,8 @@ adg_text_class_init(AdgTextClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->render_proxy = _adg_render_proxy;
+    entity_class->memory_size = _adg_memory_size;
 
     g_object_class_override_property(gobject_class, PROP_FONT_DRESS, "font-dress");
     g_object_class_override_property(gobject_class, PROP_TEXT, "text");
@@ -207,8 +215,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -328,6 +338,41 @@ _adg_arrange(AdgEntity *entity)
     _adg_refresh_extents((AdgText *) entity);
 }
 
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgTextPrivate *data = adg_text_get_instance_private((AdgText *) entity);
+    GSList *line, *run;
+    PangoGlyphString *glyphs;
+
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    if (data->text != NULL)
+        stats->text += strlen(data->text) + 1;
+
+    if (data->layout == NULL)
+        return;
+
+    /* Pango does not expose the memory used by a layout: estimate it
+     * from its copy of the text, the logical attributes and the glyph
+     * strings of every run */
+    stats->text += strlen(pango_layout_get_text(data->layout)) + 1 +
+                   pango_layout_get_character_count(data->layout) *
+                   sizeof(PangoLogAttr);
+
+    for (line = pango_layout_get_lines_readonly(data->layout);
+         line != NULL; line = line->next) {
+        stats->text += sizeof(PangoLayoutLine);
+        for (run = ((PangoLayoutLine *) line->data)->runs;
+             run != NULL; run = run->next) {
+            glyphs = ((PangoLayoutRun *) run->data)->glyphs;
+            stats->text += sizeof(PangoGlyphItem) + sizeof(PangoGlyphString) +
+                           glyphs->num_glyphs * (sizeof(PangoGlyphInfo) + sizeof(gint));
+        }
+    }
+}
+
 static void
 _adg_render(AdgEntity *entity, cairo_t *cr)
 {
@@ -348,6 +393,21 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     }
 }
 
+/* Text too small to be read: show a translucent box of the text color
+ * in place of the glyphs */
+static void
+_adg_render_proxy(AdgEntity *entity, cairo_t *cr)
+{
+    AdgTextPrivate *data = adg_text_get_instance_private((AdgText *) entity);
+    const CpmlExtents *extents = adg_entity_get_extents(entity);
+
+    adg_entity_apply_dress(entity, data->font_dress, cr);
+    cairo_rectangle(cr, extents->org.x, extents->org.y,
+                    extents->size.x, extents->size.y);
+    cairo_clip(cr);
+    cairo_paint_with_alpha(cr, 0.5);
+}
+
 static void
 _adg_set_font_dress(AdgTextual *textual, AdgDress dress)
 {
@@ -32,6 +32,8 @@ struct _AdgToyTextPrivate {
 
     int                  num_glyphs;
     cairo_glyph_t       *glyphs;
+    CpmlExtents          raw_extents;
+    cairo_matrix_t       glyphs_ctm;
 
     cairo_scaled_font_t *font;
 };
@@ -54,6 +54,8 @@
 #include "adg-toy-text.h"
 #include "adg-toy-text-private.h"
 
+#include <string.h>
+
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_toy_text_parent_class)
 #define _ADG_OLD_ENTITY_CLASS  ((AdgEntityClass *) adg_toy_text_parent_class)
@@ -88,6 +90,11 @@ static void             _adg_invalidate         (AdgEntity      *entity);
 static void             _adg_arrange            (AdgEntity      *entity);
 static void             _adg_render             (AdgEntity      *entity,
                                                  cairo_t        *cr);
+static void             _adg_memory_size        (AdgEntity      *entity,
+                                                 AdgMemoryStats *stats);
+static AdgEntity *      _adg_clone              (AdgEntity      *entity);
+static void             _adg_render_proxy       (AdgEntity      *entity,
+                                                 cairo_t        *cr);
 static void             _adg_set_font_dress     (AdgTextual     *textual,
                                                  AdgDress        dress);
 static AdgDress         _adg_get_font_dress     (AdgTextual     *textual);
@@ -96,6 +103,10 @@ static void             _adg_set_text           (AdgTextual     *textual,
 static gchar *          _adg_dup_text           (AdgTextual     *textual);
 static void             _adg_clear_font         (AdgToyText     *toy_text);
 static void             _adg_clear_glyphs       (AdgToyText     *toy_text);
+static void             _adg_get_ctm            (AdgEntity      *entity,
+                                                 cairo_matrix_t *ctm);
+static void             _adg_refresh            (AdgToyText     *toy_text);
+static void             _adg_refresh_extents    (AdgToyText     *toy_text);
 
 
 static void
@@ -116,6 +127,9 @@ adg_toy_text_class_init(AdgToyTextClass *klass)
     entity_class->invalidate = _adg_invalidate;
     entity_class->arrange = _adg_arrange;
     entity_class->render = _adg_render;
+    entity_class->render_proxy = _adg_render_proxy;
+    entity_class->memory_size = _adg_memory_size;
+    entity_class->clone = _adg_clone;
 
     g_object_class_override_property(gobject_class, PROP_FONT_DRESS, "font-dress");
     g_object_class_override_property(gobject_class, PROP_TEXT, "text");
@@ -138,6 +152,7 @@ adg_toy_text_init(AdgToyText *toy_text)
     data->font_dress = ADG_DRESS_FONT_TEXT;
     data->text = NULL;
     data->glyphs = NULL;
+    data->raw_extents.is_defined = FALSE;
     adg_entity_set_local_mix((AdgEntity *) toy_text, ADG_MIX_ANCESTORS_NORMALIZED);
 }
 
@@ -193,8 +208,10 @@ _adg_set_property(GObject *object, guint prop_id,
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
-        break;
+        return;
     }
+
+    adg_entity_mark_dirty((AdgEntity *) object);
 }
 
 
@@ -222,7 +239,7 @@ _adg_global_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->global_changed)
         _ADG_OLD_ENTITY_CLASS->global_changed(entity);
 
-    adg_entity_invalidate(entity);
+    _adg_refresh((AdgToyText *) entity);
 }
 
 static void
@@ -231,7 +248,7 @@ _adg_local_changed(AdgEntity *entity)
     if (_ADG_OLD_ENTITY_CLASS->local_changed)
         _ADG_OLD_ENTITY_CLASS->local_changed(entity);
 
-    adg_entity_invalidate(entity);
+    _adg_refresh((AdgToyText *) entity);
 }
 
 static void
@@ -254,25 +271,20 @@ _adg_arrange(AdgEntity *entity)
     if (data->font == NULL) {
         AdgDress dress;
         AdgFontStyle *font_style;
-        cairo_matrix_t ctm;
 
         dress = data->font_dress;
         font_style = (AdgFontStyle *) adg_entity_style(entity, dress);
 
-        adg_matrix_copy(&ctm, adg_entity_get_global_matrix(entity));
-        adg_matrix_transform(&ctm, adg_entity_get_local_matrix(entity),
-                             ADG_TRANSFORM_BEFORE);
-
-        data->font = adg_font_style_get_scaled_font(font_style, &ctm);
+        _adg_get_ctm(entity, &data->glyphs_ctm);
+        data->font = adg_font_style_get_scaled_font(font_style,
+                                                    &data->glyphs_ctm);
     }
 
     if (adg_is_string_empty(data->text)) {
         /* Undefined text */
         extents.is_defined = FALSE;
-    } else if (data->glyphs != NULL) {
-        /* Cached result */
-        return;
-    } else {
+        adg_entity_set_extents(entity, &extents);
+    } else if (data->glyphs == NULL) {
         cairo_status_t status;
         cairo_text_extents_t cairo_extents;
 
@@ -291,13 +303,45 @@ _adg_arrange(AdgEntity *entity)
 
         cairo_scaled_font_glyph_extents(data->font, data->glyphs,
                                         data->num_glyphs, &cairo_extents);
-        cpml_extents_from_cairo_text(&extents, &cairo_extents);
-        cpml_extents_transform(&extents, adg_entity_get_local_matrix(entity));
-        cpml_extents_transform(&extents, adg_entity_get_global_matrix(entity));
+        cpml_extents_from_cairo_text(&data->raw_extents, &cairo_extents);
+        _adg_refresh_extents(toy_text);
+    }
+}
+
+static void
+_adg_memory_size(AdgEntity *entity, AdgMemoryStats *stats)
+{
+    AdgToyTextPrivate *data = adg_toy_text_get_instance_private((AdgToyText *) entity);
 
+    if (_ADG_OLD_ENTITY_CLASS->memory_size)
+        _ADG_OLD_ENTITY_CLASS->memory_size(entity, stats);
+
+    if (data->text != NULL)
+        stats->text += strlen(data->text) + 1;
+
+    if (data->glyphs != NULL)
+        stats->text += data->num_glyphs * sizeof(cairo_glyph_t);
+}
+
+static AdgEntity *
+_adg_clone(AdgEntity *entity)
+{
+    AdgToyTextPrivate *data, *clone_data;
+    AdgEntity *clone;
+
+    clone = _ADG_OLD_ENTITY_CLASS->clone(entity);
+    data = adg_toy_text_get_instance_private((AdgToyText *) entity);
+    clone_data = adg_toy_text_get_instance_private((AdgToyText *) clone);
+
+    /* The glyphs depend on the rendering context, so they
+     * will be computed again by the clone */
+    clone_data->font_dress = data->font_dress;
+    if (g_strcmp0(clone_data->text, data->text) != 0) {
+        g_free(clone_data->text);
+        clone_data->text = g_strdup(data->text);
     }
 
-    adg_entity_set_extents(entity, &extents);
+    return clone;
 }
 
 static void
@@ -314,6 +358,21 @@ _adg_render(AdgEntity *entity, cairo_t *cr)
     }
 }
 
+/* Text too small to be read: show a translucent box of the text color
+ * in place of the glyphs */
+static void
+_adg_render_proxy(AdgEntity *entity, cairo_t *cr)
+{
+    AdgToyTextPrivate *data = adg_toy_text_get_instance_private((AdgToyText *) entity);
+    const CpmlExtents *extents = adg_entity_get_extents(entity);
+
+    adg_entity_apply_dress(entity, data->font_dress, cr);
+    cairo_rectangle(cr, extents->org.x, extents->org.y,
+                    extents->size.x, extents->size.y);
+    cairo_clip(cr);
+    cairo_paint_with_alpha(cr, 0.5);
+}
+
 static void
 _adg_set_font_dress(AdgTextual *textual, AdgDress dress)
 {
@@ -358,4 +417,49 @@ _adg_clear_glyphs(AdgToyText *toy_text)
     }
 
     data->num_glyphs = 0;
+    data->raw_extents.is_defined = FALSE;
+}
+
+static void
+_adg_get_ctm(AdgEntity *entity, cairo_matrix_t *ctm)
+{
+    adg_matrix_copy(ctm, adg_entity_get_global_matrix(entity));
+    adg_matrix_transform(ctm, adg_entity_get_local_matrix(entity),
+                         ADG_TRANSFORM_BEFORE);
+}
+
+/* Called whenever a map changed. The glyphs depend only on the scale
+ * and rotation of the ctm: a pure translation (such as the repositioning
+ * of a quote during a zoom) can reuse them, moving only the extents. */
+static void
+_adg_refresh(AdgToyText *toy_text)
+{
+    AdgToyTextPrivate *data = adg_toy_text_get_instance_private(toy_text);
+    const cairo_matrix_t *glyphs_ctm = &data->glyphs_ctm;
+    cairo_matrix_t ctm;
+
+    if (data->font != NULL && data->glyphs != NULL) {
+        _adg_get_ctm((AdgEntity *) toy_text, &ctm);
+
+        if (ctm.xx == glyphs_ctm->xx && ctm.yy == glyphs_ctm->yy &&
+            ctm.xy == glyphs_ctm->xy && ctm.yx == glyphs_ctm->yx) {
+            _adg_refresh_extents(toy_text);
+            return;
+        }
+    }
+
+    adg_entity_invalidate((AdgEntity *) toy_text);
+}
+
+static void
+_adg_refresh_extents(AdgToyText *toy_text)
+{
+    AdgToyTextPrivate *data = adg_toy_text_get_instance_private(toy_text);
+    AdgEntity *entity = (AdgEntity *) toy_text;
+    CpmlExtents extents;
+
+    cpml_extents_copy(&extents, &data->raw_extents);
+    cpml_extents_transform(&extents, adg_entity_get_local_matrix(entity));
+    cpml_extents_transform(&extents, adg_entity_get_global_matrix(entity));
+    adg_entity_set_extents(entity, &extents);
 }
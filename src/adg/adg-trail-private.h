@@ -25,6 +25,14 @@
 G_BEGIN_DECLS
 
 typedef struct _AdgTrailPrivate AdgTrailPrivate;
+typedef struct _AdgArcOffset    AdgArcOffset;
+
+/* Offsets just after an arc, both in the source and in the converted
+ * path: used to map a source offset to its converted counterpart */
+struct _AdgArcOffset {
+    gint                source;
+    gint                converted;
+};
 
 struct _AdgTrailPrivate {
     cairo_path_t        cairo_path;
@@ -34,6 +42,14 @@ struct _AdgTrailPrivate {
 
     gboolean            in_construction;
     CpmlExtents         extents;
+
+    /* Until an arc is met the source path is used as is, so
+     * @array and @arcs are allocated only by paths with arcs */
+    struct {
+        GArray         *array;
+        GArray         *arcs;
+        gint            n_source;
+    }                   converted;
 };
 
 G_END_DECLS
@@ -49,11 +49,17 @@
 /**
  * AdgTrailClass:
  * @get_cairo_path: virtual method to get the #cairo_path_t bound to the trail.
+ * @memory_size:    virtual method returning the bytes of path data owned by
+ *                  the trail.
  *
  * The default @get_cairo_path calls the #AdgTrailCallback callback passed
  * to adg_trail_new() during construction. No caching is performed in
  * between.
  *
+ * The default @memory_size accounts the converted path cached by
+ * #AdgTrail: derived classes keeping their own data should chain up
+ * and add their own figures.
+ *
  * Since: 1.0
  **/
 
@@ -80,12 +86,14 @@
 
 #include "adg-trail.h"
 #include "adg-trail-private.h"
+#include "adg-arena-private.h"
 
 
 #define _ADG_OLD_OBJECT_CLASS  ((GObjectClass *) adg_trail_parent_class)
 #define _ADG_OLD_MODEL_CLASS   ((AdgModelClass *) adg_trail_parent_class)
 
 #define EMPTY_PATH(p)          ((p) == NULL || (p)->data == NULL || (p)->num_data <= 0)
+#define HAS_ARCS(data)         ((data)->converted.arcs != NULL && (data)->converted.arcs->len > 0)
 
 G_DEFINE_TYPE_WITH_PRIVATE(AdgTrail, adg_trail, ADG_TYPE_MODEL)
 
@@ -105,7 +113,12 @@ static void             _adg_set_property       (GObject        *object,
                                                  const GValue   *value,
                                                  GParamSpec     *pspec);
 static void             _adg_clear              (AdgModel       *model);
+static AdgModel *       _adg_clone              (AdgModel       *model);
 static cairo_path_t *   _adg_get_cairo_path     (AdgTrail       *trail);
+static gsize            _adg_memory_size        (AdgTrail       *trail);
+static cairo_path_t *   _adg_source_path        (AdgTrail       *trail);
+static void             _adg_rewind             (AdgTrailPrivate *data,
+                                                 gint            offset);
 static GArray *         _adg_arc_to_curves      (GArray         *array,
                                                  const cairo_path_data_t *src,
                                                  gdouble         max_angle);
@@ -126,8 +139,10 @@ adg_trail_class_init(AdgTrailClass *klass)
     gobject_class->set_property = _adg_set_property;
 
     model_class->clear = _adg_clear;
+    model_class->clone = _adg_clone;
 
     klass->get_cairo_path = _adg_get_cairo_path;
+    klass->memory_size = _adg_memory_size;
 
     param = g_param_spec_double("max-angle",
                                 P_("Max Angle"),
@@ -149,13 +164,23 @@ adg_trail_init(AdgTrail *trail)
     data->max_angle = G_PI_2;
     data->in_construction = FALSE;
     data->extents.is_defined = FALSE;
+    data->converted.array = NULL;
+    data->converted.arcs = NULL;
+    data->converted.n_source = 0;
 }
 
 static void
 _adg_finalize(GObject *object)
 {
+    AdgTrailPrivate *data = adg_trail_get_instance_private((AdgTrail *) object);
+
     _adg_clear((AdgModel *) object);
 
+    if (data->converted.arcs != NULL) {
+        g_array_free(data->converted.array, TRUE);
+        g_array_free(data->converted.arcs, TRUE);
+    }
+
     if (_ADG_OLD_OBJECT_CLASS->finalize)
         _ADG_OLD_OBJECT_CLASS->finalize(object);
 }
@@ -187,6 +212,8 @@ _adg_set_property(GObject *object, guint prop_id,
     switch (prop_id) {
     case PROP_MAX_ANGLE:
         data->max_angle = g_value_get_double(value);
+        /* The arcs must be converted again */
+        _adg_rewind(data, 0);
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -231,8 +258,13 @@ adg_trail_new(AdgTrailCallback callback, gpointer user_data)
  * adg_trail_cairo_path() and converts its #CPML_ARC primitives,
  * not recognized by cairo, into approximated Bézier curves
  * primitives (#CPML_CURVE). The conversion is cached, so any further
- * request is O(1). This cache is cleared only by the
- * adg_model_clear() method.
+ * request is O(1). This cache is cleared by the adg_model_clear()
+ * method. adg_trail_clear_from() can be used instead to clear only
+ * the tail of the cache: in that case the next request converts only
+ * the part of the path starting from the cleared offset.
+ *
+ * A path without arcs needs no conversion: the data of the source
+ * path is returned as is, without copying it.
  *
  * Returns: (transfer none): a pointer to the internal cairo path or <constant>NULL</constant> on errors.
  *
@@ -243,41 +275,117 @@ adg_trail_get_cairo_path(AdgTrail *trail)
 {
     AdgTrailPrivate *data;
     cairo_path_t *cairo_path;
-    GArray *dst;
     const cairo_path_data_t *p_src;
+    AdgArcOffset arc;
     int i;
 
     g_return_val_if_fail(ADG_IS_TRAIL(trail), NULL);
 
     data = adg_trail_get_instance_private(trail);
 
-    /* Check for cached result */
-    if (data->cairo_path.data != NULL)
-        return &data->cairo_path;
+    if (data->cairo_path.data != NULL) {
+        /* A converted path is owned by trail: valid until cleared */
+        if (HAS_ARCS(data))
+            return &data->cairo_path;
+
+        /* Otherwise it is the source path itself, valid as long as the
+         * source is the same: data built on a scratch arena, e.g. from
+         * a callback, is moved around when the arena is rewound */
+        cairo_path = _adg_source_path(trail);
+        if (cairo_path != NULL &&
+            cairo_path->data == data->cairo_path.data &&
+            cairo_path->num_data == data->cairo_path.num_data)
+            return &data->cairo_path;
+
+        _adg_rewind(data, 0);
+    } else {
+        cairo_path = _adg_source_path(trail);
+    }
 
-    cairo_path = adg_trail_cairo_path(trail);
-    if (EMPTY_PATH(cairo_path))
+    if (EMPTY_PATH(cairo_path)) {
+        _adg_rewind(data, 0);
         return NULL;
+    }
 
-    dst = g_array_sized_new(FALSE, FALSE,
-                            sizeof(cairo_path_data_t), cairo_path->num_data);
+    /* A source path shorter than the converted one has been
+     * rebuilt from scratch: nothing can be retained */
+    if (cairo_path->num_data < data->converted.n_source)
+        _adg_rewind(data, 0);
 
-    /* Cycle the cairo_path_t and convert arcs to Bézier curves */
-    for (i = 0; i < cairo_path->num_data; i += p_src->header.length) {
+    /* Cycle the cairo_path_t, starting from where the previous
+     * conversion stopped, and convert arcs to Bézier curves */
+    for (i = data->converted.n_source; i < cairo_path->num_data;
+         i += p_src->header.length) {
         p_src = (const cairo_path_data_t *) cairo_path->data + i;
 
-        if (p_src->header.type == CPML_ARC)
-            dst = _adg_arc_to_curves(dst, p_src, data->max_angle);
-        else
-            dst = g_array_append_vals(dst, p_src, p_src->header.length);
+        if (p_src->header.type == CPML_ARC) {
+            if (data->converted.arcs == NULL) {
+                data->converted.array = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+                data->converted.arcs = g_array_new(FALSE, FALSE, sizeof(AdgArcOffset));
+            }
+
+            /* The first arc: up to now the source was used as is */
+            if (data->converted.arcs->len == 0)
+                g_array_append_vals(data->converted.array,
+                                    cairo_path->data, i);
+
+            data->converted.array = _adg_arc_to_curves(data->converted.array,
+                                                       p_src, data->max_angle);
+            arc.source = i + p_src->header.length;
+            arc.converted = data->converted.array->len;
+            g_array_append_val(data->converted.arcs, arc);
+        } else if (HAS_ARCS(data)) {
+            g_array_append_vals(data->converted.array, p_src,
+                                p_src->header.length);
+        }
     }
 
-    cairo_path = &data->cairo_path;
-    cairo_path->status = CAIRO_STATUS_SUCCESS;
-    cairo_path->num_data = dst->len;
-    cairo_path->data = (cairo_path_data_t *) g_array_free(dst, FALSE);
+    data->converted.n_source = cairo_path->num_data;
+    data->cairo_path.status = CAIRO_STATUS_SUCCESS;
 
-    return cairo_path;
+    if (HAS_ARCS(data)) {
+        data->cairo_path.num_data = data->converted.array->len;
+        data->cairo_path.data = (cairo_path_data_t *) data->converted.array->data;
+    } else {
+        data->cairo_path.num_data = cairo_path->num_data;
+        data->cairo_path.data = cairo_path->data;
+    }
+
+    return &data->cairo_path;
+}
+
+/**
+ * adg_trail_clear_from:
+ * @trail: an #AdgTrail
+ * @offset: the first modified #cairo_path_data_t of the source path
+ *
+ * <note><para>
+ * This function is only useful in trail implementations.
+ * </para></note>
+ *
+ * Partially clears the cache of @trail, retaining the converted path
+ * (see adg_trail_get_cairo_path()) up to @offset. @offset must be the
+ * start of a primitive of the path returned by adg_trail_cairo_path()
+ * and no primitive before @offset must have been modified.
+ *
+ * This is a cheaper alternative to adg_model_clear() for paths that
+ * are modified only at their end, e.g. when new primitives are
+ * appended or the last ones are removed.
+ *
+ * Since: 1.0
+ **/
+void
+adg_trail_clear_from(AdgTrail *trail, gint offset)
+{
+    AdgTrailPrivate *data;
+
+    g_return_if_fail(ADG_IS_TRAIL(trail));
+    g_return_if_fail(offset >= 0);
+
+    data = adg_trail_get_instance_private(trail);
+
+    _adg_rewind(data, offset);
+    data->extents.is_defined = FALSE;
 }
 
 /**
@@ -300,6 +408,10 @@ adg_trail_get_cairo_path(AdgTrail *trail)
  * previously returned useless because the #cairo_path_t could be
  * relocated and the old #cairo_path_t will likely contain rubbish.
  *
+ * Because the returned path can be modified, any data cached by
+ * @trail on top of it (the converted path and the extents) is
+ * cleared by this call.
+ *
  * Returns: (transfer none): a pointer to the #cairo_path_t or <constant>NULL</constant> on errors.
  *
  * Since: 1.0
@@ -307,26 +419,14 @@ adg_trail_get_cairo_path(AdgTrail *trail)
 cairo_path_t *
 adg_trail_cairo_path(AdgTrail *trail)
 {
-    AdgTrailClass *klass;
-    AdgTrailPrivate *data;
     cairo_path_t *cairo_path;
 
     g_return_val_if_fail(ADG_IS_TRAIL(trail), NULL);
 
-    klass = ADG_TRAIL_GET_CLASS(trail);
-    if (klass->get_cairo_path == NULL)
-        return NULL;
+    cairo_path = _adg_source_path(trail);
 
-    data = adg_trail_get_instance_private(trail);
-    if (data->in_construction) {
-        g_warning(_("%s: you cannot access the path from the callback you provided to build it"),
-                  G_STRLOC);
-        return NULL;
-    }
-
-    data->in_construction = TRUE;
-    cairo_path = klass->get_cairo_path(trail);
-    data->in_construction = FALSE;
+    if (cairo_path != NULL)
+        adg_trail_clear_from(trail, 0);
 
     return cairo_path;
 }
@@ -351,7 +451,7 @@ adg_trail_n_segments(AdgTrail *trail)
 
     g_return_val_if_fail(ADG_IS_TRAIL(trail), 0);
 
-    cairo_path = adg_trail_cairo_path(trail);
+    cairo_path = _adg_source_path(trail);
 
     n = 0;
     if (! EMPTY_PATH(cairo_path) && cpml_segment_from_cairo(&iterator, cairo_path)) {
@@ -372,6 +472,11 @@ adg_trail_n_segments(AdgTrail *trail)
  * got from the cairo path: check out adg_trail_cairo_path() for
  * further information.
  *
+ * Differently from adg_trail_cairo_path(), this function does not
+ * clear the data cached by @trail, so the segment data should not
+ * be modified: code that needs to modify it must get the segment
+ * from adg_trail_cairo_path() instead.
+ *
  * When the segment is not found, either because @n_segment is out
  * of range or because there is still no path bound to @trail, this
  * function will return <constant>FALSE</constant> leaving @segment
@@ -398,7 +503,9 @@ adg_trail_put_segment(AdgTrail *trail, guint n_segment, CpmlSegment *segment)
         return FALSE;
     }
 
-    cairo_path = adg_trail_cairo_path(trail);
+    /* Read the source path directly: adg_trail_cairo_path() would
+     * throw away the converted path for nothing */
+    cairo_path = _adg_source_path(trail);
     found = ! EMPTY_PATH(cairo_path) &&
         cpml_segment_from_cairo(&iterator, cairo_path);
 
@@ -436,7 +543,7 @@ adg_trail_get_extents(AdgTrail *trail)
         CpmlSegment segment;
         CpmlExtents extents;
 
-        cairo_path = adg_trail_cairo_path(trail);
+        cairo_path = _adg_source_path(trail);
         if (! EMPTY_PATH(cairo_path) &&
             cpml_segment_from_cairo(&segment, cairo_path)) {
             do {
@@ -533,23 +640,62 @@ adg_trail_get_max_angle(AdgTrail *trail)
     return data->max_angle;
 }
 
+/**
+ * adg_trail_get_memory_size:
+ * @trail: an #AdgTrail
+ *
+ * Gets an estimate of the memory used by the path data owned by
+ * @trail, that is the cached converted path plus whatever the
+ * #AdgTrailClass.memory_size method of the derived class accounts.
+ * The #GObject instance itself is not included.
+ *
+ * Returns: the size in bytes of the path data owned by @trail
+ *
+ * Since: 1.0
+ **/
+gsize
+adg_trail_get_memory_size(AdgTrail *trail)
+{
+    AdgTrailClass *klass;
+
+    g_return_val_if_fail(ADG_IS_TRAIL(trail), 0);
+
+    klass = ADG_TRAIL_GET_CLASS(trail);
+    if (klass->memory_size == NULL)
+        return 0;
+
+    return klass->memory_size(trail);
+}
+
 
 static void
 _adg_clear(AdgModel *model)
 {
     AdgTrailPrivate *data = adg_trail_get_instance_private((AdgTrail *) model);
 
-    g_free(data->cairo_path.data);
-
-    data->cairo_path.status = CAIRO_STATUS_INVALID_PATH_DATA;
-    data->cairo_path.data = NULL;
-    data->cairo_path.num_data = 0;
+    /* The memory is retained for the next conversion */
+    _adg_rewind(data, 0);
     data->extents.is_defined = FALSE;
 
     if (_ADG_OLD_MODEL_CLASS->clear)
         _ADG_OLD_MODEL_CLASS->clear(model);
 }
 
+static AdgModel *
+_adg_clone(AdgModel *model)
+{
+    AdgModel *clone = _ADG_OLD_MODEL_CLASS->clone(model);
+    AdgTrailPrivate *data = adg_trail_get_instance_private((AdgTrail *) model);
+    AdgTrailPrivate *clone_data = adg_trail_get_instance_private((AdgTrail *) clone);
+
+    /* The converted path is a cache: let the clone rebuild it */
+    clone_data->callback = data->callback;
+    clone_data->user_data = data->user_data;
+    clone_data->max_angle = data->max_angle;
+
+    return clone;
+}
+
 static cairo_path_t *
 _adg_get_cairo_path(AdgTrail *trail)
 {
@@ -564,6 +710,84 @@ _adg_get_cairo_path(AdgTrail *trail)
     return data->callback(trail, data->user_data);
 }
 
+static gsize
+_adg_memory_size(AdgTrail *trail)
+{
+    AdgTrailPrivate *data = adg_trail_get_instance_private(trail);
+
+    /* Without arcs, the source path is used as is */
+    if (data->converted.arcs == NULL)
+        return 0;
+
+    return data->converted.array->len * sizeof(cairo_path_data_t) +
+           data->converted.arcs->len * sizeof(AdgArcOffset);
+}
+
+static cairo_path_t *
+_adg_source_path(AdgTrail *trail)
+{
+    AdgTrailClass *klass;
+    AdgTrailPrivate *data;
+    cairo_path_t *cairo_path;
+
+    klass = ADG_TRAIL_GET_CLASS(trail);
+    if (klass->get_cairo_path == NULL)
+        return NULL;
+
+    data = adg_trail_get_instance_private(trail);
+    if (data->in_construction) {
+        g_warning(_("%s: you cannot access the path from the callback you provided to build it"),
+                  G_STRLOC);
+        return NULL;
+    }
+
+    data->in_construction = TRUE;
+    cairo_path = klass->get_cairo_path(trail);
+    data->in_construction = FALSE;
+
+    return cairo_path;
+}
+
+static void
+_adg_rewind(AdgTrailPrivate *data, gint offset)
+{
+    GArray *arcs = data->converted.arcs;
+    const AdgArcOffset *arc;
+    guint n;
+
+    data->cairo_path.status = CAIRO_STATUS_INVALID_PATH_DATA;
+    data->cairo_path.data = NULL;
+    data->cairo_path.num_data = 0;
+
+    if (offset >= data->converted.n_source)
+        return;
+
+    data->converted.n_source = offset;
+
+    /* Without arcs nothing has been converted */
+    if (arcs == NULL)
+        return;
+
+    /* Drop the arcs that are not entirely before offset */
+    for (n = arcs->len; n > 0; --n) {
+        arc = &g_array_index(arcs, AdgArcOffset, n - 1);
+        if (arc->source <= offset)
+            break;
+    }
+    g_array_set_size(arcs, n);
+
+    /* Between two arcs, source and converted data are the same
+     * apart from a constant shift, given by the last arc. Before
+     * the first arc the source path is used as is. */
+    if (n > 0) {
+        arc = &g_array_index(arcs, AdgArcOffset, n - 1);
+        g_array_set_size(data->converted.array,
+                         offset - arc->source + arc->converted);
+    } else {
+        g_array_set_size(data->converted.array, 0);
+    }
+}
+
 static GArray *
 _adg_arc_to_curves(GArray *array, const cairo_path_data_t *src,
                    gdouble max_angle)
@@ -581,15 +805,28 @@ _adg_arc_to_curves(GArray *array, const cairo_path_data_t *src,
         CpmlSegment segment;
         int n_curves;
         cairo_path_data_t *curves;
+        AdgArena *arena;
 
         n_curves = ceil(fabs(end-start) / max_angle);
-        curves = g_new(cairo_path_data_t, n_curves * 4);
+
+        /* The curves are only a scratch buffer: use the current
+         * arena, if any, to avoid the allocator round trip, and
+         * give it back as soon as it has been copied */
+        arena = _adg_arena_get_current();
+        if (arena != NULL)
+            curves = _adg_arena_alloc(arena, sizeof(cairo_path_data_t) * n_curves * 4);
+        else
+            curves = g_new(cairo_path_data_t, n_curves * 4);
+
         segment.data = curves;
         cpml_arc_to_curves(&arc, &segment, n_curves);
 
         array = g_array_append_vals(array, curves, n_curves * 4);
 
-        g_free(curves);
+        if (arena != NULL)
+            _adg_arena_release(arena, curves, sizeof(cairo_path_data_t) * n_curves * 4);
+        else
+            g_free(curves);
     }
 
     return array;
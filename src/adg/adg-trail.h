@@ -53,6 +53,7 @@ struct _AdgTrailClass {
     /*< public >*/
     /* Virtual table */
     cairo_path_t *  (*get_cairo_path)           (AdgTrail        *trail);
+    gsize           (*memory_size)              (AdgTrail        *trail);
 };
 
 
@@ -62,6 +63,8 @@ AdgTrail *          adg_trail_new               (AdgTrailCallback callback,
 
 const cairo_path_t *adg_trail_get_cairo_path    (AdgTrail        *trail);
 cairo_path_t *      adg_trail_cairo_path        (AdgTrail        *trail);
+void                adg_trail_clear_from        (AdgTrail        *trail,
+                                                 gint             offset);
 guint               adg_trail_n_segments        (AdgTrail        *trail);
 gboolean            adg_trail_put_segment       (AdgTrail        *trail,
                                                  guint            n_segment,
@@ -71,6 +74,7 @@ void                adg_trail_dump              (AdgTrail        *trail);
 void                adg_trail_set_max_angle     (AdgTrail        *trail,
                                                  gdouble          angle);
 gdouble             adg_trail_get_max_angle     (AdgTrail        *trail);
+gsize               adg_trail_get_memory_size   (AdgTrail        *trail);
 
 G_END_DECLS
 
@@ -472,11 +472,13 @@ adg_type_from_filename(const gchar *file)
  *
  * A helper method that clones a generic #GObject instance. The implementation
  * leverages the g_object_get_property() method on @src to get all the
- * properties and uses g_object_newv() to create the destination clone.
+ * properties and uses g_object_new_with_properties() to create the
+ * destination clone.
  *
  * The code is not as sophisticated as one might expect, so apart from what
- * described there is no other magic involved. It is internally used by ADG to
- * clone #AdgStyle instances in adg_style_clone().
+ * described there is no other magic involved. It is internally used by ADG
+ * as a fallback for the types that do not provide a typed clone method,
+ * see adg_style_clone(), adg_entity_clone() and adg_model_clone().
  *
  * Returns: (transfer full): the clone of @src.
  *
@@ -484,6 +486,13 @@ adg_type_from_filename(const gchar *file)
  **/
 GObject *
 adg_object_clone(GObject *src)
+{
+    g_return_val_if_fail(G_IS_OBJECT(src), NULL);
+    return _adg_object_clone_except(src, G_TYPE_INVALID);
+}
+
+GObject *
+_adg_object_clone_except(GObject *src, GType owner_type)
 {
     GObject     *dst;
     GParamSpec **specs;
@@ -493,14 +502,14 @@ adg_object_clone(GObject *src)
     GValue      *value;
     guint        n, n_specs, n_properties;
 
-    g_return_val_if_fail(G_IS_OBJECT(src), NULL);
     specs = g_object_class_list_properties(G_OBJECT_GET_CLASS(src), &n_specs);
     names = g_new0(const char *, n_specs);
     values = g_new0(GValue, n_specs);
     n_properties = 0;
 
     for (n = 0; n < n_specs; ++n) {
-        if ((specs[n]->flags & G_PARAM_READWRITE) == G_PARAM_READWRITE) {
+        if ((specs[n]->flags & G_PARAM_READWRITE) == G_PARAM_READWRITE &&
+            specs[n]->owner_type != owner_type) {
             name = g_intern_string(specs[n]->name);
             names[n_properties] = name;
             value = &values[n_properties];
@@ -512,6 +521,10 @@ adg_object_clone(GObject *src)
 
     dst = g_object_new_with_properties(G_TYPE_FROM_INSTANCE(src),
                                        n_properties, names, values);
+
+    for (n = 0; n < n_properties; ++n)
+        g_value_unset(&values[n]);
+
     g_free(specs);
     g_free(names);
     g_free(values);
@@ -0,0 +1,729 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2022  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/* Synthetic benchmarks: builds canvases at scale and times the
+ * main phases of their life cycle, printing the results as JSON.
+ *
+ * All the times are in milliseconds. Use --scale and --pistons to
+ * change the size of the drawings. */
+
+
+#include <adg.h>
+#include <glib/gstdio.h>
+#include <math.h>
+
+#define SQRT3   1.732050808
+#define CHAMFER 0.3
+#define CELL    40.
+
+
+typedef struct _BenchPart BenchPart;
+typedef struct _BenchScenario BenchScenario;
+
+struct _BenchPart {
+    gdouble     A, B, C;
+    gdouble     DHOLE, LHOLE;
+    gdouble     D1, D2, D3, D4, D5, D6, D7;
+    gdouble     RD34;
+    gdouble     LD2, LD3, LD5, LD6, LD7;
+    gdouble     ZGROOVE, DGROOVE, LGROOVE;
+};
+
+struct _BenchScenario {
+    const gchar *name;
+    gpointer   (*build)         (AdgContainer   *container,
+                                 gint            n);
+    void       (*change)        (gpointer        target);
+};
+
+
+static gint scale = 100;
+static gint pistons = 10;
+
+/* The default values of the piston in adg-demo */
+static const BenchPart part = {
+    .A = 50, .B = 20.6, .C = 2,
+    .DHOLE = 2, .LHOLE = 3,
+    .D1 = 9.3, .D2 = 6.5, .D3 = 13.8, .D4 = 6.5, .D5 = 4.5, .D6 = 7.2, .D7 = 2,
+    .RD34 = 1,
+    .LD2 = 7, .LD3 = 3.5, .LD5 = 5, .LD6 = 1, .LD7 = 0.5,
+    .ZGROOVE = 16, .DGROOVE = 8.3, .LGROOVE = 1
+};
+
+
+static gdouble
+_bench_elapsed(gint64 start)
+{
+    return (g_get_monotonic_time() - start) / 1000.;
+}
+
+/* Places the n-th item of a scenario on a square grid */
+static void
+_bench_cell(gint n, gint total, gdouble *x, gdouble *y)
+{
+    gint columns = ceil(sqrt(total));
+
+    *x = (n % columns) * CELL;
+    *y = (n / columns) * CELL;
+}
+
+static void
+_bench_model_changed(gpointer target)
+{
+    adg_model_changed(target);
+}
+
+
+static gpointer
+_bench_strokes(AdgContainer *container, gint n)
+{
+    AdgPath *path, *first;
+    gdouble x, y;
+    gint i, j;
+
+    first = NULL;
+
+    for (i = 0; i < n; ++i) {
+        _bench_cell(i, n, &x, &y);
+        path = adg_path_new();
+        adg_path_move_to_explicit(path, x, y);
+
+        /* A long zig-zag with a rounded corner every few segments */
+        for (j = 1; j <= 200; ++j) {
+            adg_path_line_to_explicit(path, x + j * CELL / 250,
+                                      y + (j % 2) * CELL / 2);
+            if (j % 10 == 0)
+                adg_path_fillet(path, CELL / 1000);
+        }
+
+        adg_container_add(container,
+                          ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path))));
+        g_object_unref(path);
+
+        if (first == NULL)
+            first = path;
+    }
+
+    /* The path is owned by its stroke, hence by the canvas */
+    return first;
+}
+
+static gpointer
+_bench_dimensions(AdgContainer *container, gint n)
+{
+    AdgPath *path;
+    AdgModel *model;
+    AdgLDim *ldim;
+    CpmlPair pair;
+    gdouble x, y;
+    gchar ref1[16], ref2[16], pos[16];
+    gint i;
+
+    /* The bound dimensions share a single model, as in real drawings */
+    path = adg_path_new();
+    model = ADG_MODEL(path);
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, CELL, 0);
+    adg_container_add(container, ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path))));
+    g_object_unref(path);
+
+    for (i = 0; i < n; ++i) {
+        _bench_cell(i, n, &x, &y);
+
+        adg_container_add(container,
+                          ADG_ENTITY(adg_ldim_new_full_explicit(x, y, x + CELL / 2, y,
+                                                                x, y - 5, ADG_DIR_UP)));
+        adg_container_add(container,
+                          ADG_ENTITY(adg_adim_new_full_explicit(x, y, x + CELL / 3, y + CELL / 3,
+                                                                x, y, x, y,
+                                                                x + CELL / 4, y + CELL / 8)));
+        adg_container_add(container,
+                          ADG_ENTITY(adg_rdim_new_full_explicit(x + CELL / 2, y + CELL / 2,
+                                                                x + CELL / 2 + 5, y + CELL / 2,
+                                                                x + CELL, y + CELL)));
+
+        g_snprintf(ref1, sizeof(ref1), "R1-%d", i);
+        g_snprintf(ref2, sizeof(ref2), "R2-%d", i);
+        g_snprintf(pos, sizeof(pos), "P-%d", i);
+
+        pair.x = x;
+        pair.y = y + CELL / 2;
+        adg_model_set_named_pair(model, ref1, &pair);
+        pair.x = x + CELL / 2;
+        adg_model_set_named_pair(model, ref2, &pair);
+        pair.y += 5;
+        adg_model_set_named_pair(model, pos, &pair);
+
+        ldim = adg_ldim_new_full_from_model(model, ref1, ref2, pos, ADG_DIR_DOWN);
+        adg_container_add(container, ADG_ENTITY(ldim));
+    }
+
+    return path;
+}
+
+static gpointer
+_bench_hatches(AdgContainer *container, gint n)
+{
+    AdgPath *path, *first;
+    gdouble x, y;
+    gint i;
+
+    first = NULL;
+
+    for (i = 0; i < n; ++i) {
+        _bench_cell(i, n, &x, &y);
+        path = adg_path_new();
+        adg_path_move_to_explicit(path, x, y);
+        adg_path_line_to_explicit(path, x + CELL * 0.8, y);
+        adg_path_line_to_explicit(path, x + CELL * 0.8, y + CELL * 0.4);
+        adg_path_arc_to_explicit(path, x + CELL * 0.4, y + CELL * 0.8,
+                                 x, y + CELL * 0.4);
+        adg_path_close(path);
+
+        adg_container_add(container,
+                          ADG_ENTITY(adg_hatch_new(ADG_TRAIL(path))));
+        adg_container_add(container,
+                          ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path))));
+        g_object_unref(path);
+
+        if (first == NULL)
+            first = path;
+    }
+
+    return first;
+}
+
+static gpointer
+_bench_table(AdgContainer *container, gint n)
+{
+    AdgTable *table;
+    AdgTableRow *row;
+    AdgTableCell *cell, *first;
+    gchar value[32];
+    gint i;
+
+    table = adg_table_new();
+    first = NULL;
+
+    for (i = 0; i < n; ++i) {
+        row = adg_table_row_new(table);
+
+        g_snprintf(value, sizeof(value), "%d", i + 1);
+        cell = adg_table_cell_new_full(row, 20, NULL, NULL, TRUE);
+        adg_table_cell_set_text_value(cell, value);
+
+        cell = adg_table_cell_new_full(row, 100, NULL, "PART", TRUE);
+        adg_table_cell_set_text_value(cell, "Sample part");
+
+        g_snprintf(value, sizeof(value), "%g", i * 0.25);
+        cell = adg_table_cell_new_full(row, 40, NULL, "WEIGHT", TRUE);
+        adg_table_cell_set_text_value(cell, value);
+
+        if (first == NULL)
+            first = cell;
+    }
+
+    adg_container_add(container, ADG_ENTITY(table));
+
+    return first;
+}
+
+static void
+_bench_table_changed(gpointer target)
+{
+    adg_table_cell_set_text_value(target, "0.125");
+}
+
+/* The following functions build the same piston of adg-demo */
+
+static void
+_bench_add_groove(AdgPath *path)
+{
+    AdgModel *model = ADG_MODEL(path);
+    CpmlPair pair;
+
+    pair.x = part.ZGROOVE;
+    pair.y = part.D1 / 2;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "DGROOVEI_X", &pair);
+
+    pair.y = part.D3 / 2;
+    adg_model_set_named_pair(model, "DGROOVEY_POS", &pair);
+
+    pair.y = part.DGROOVE / 2;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "DGROOVEI_Y", &pair);
+
+    pair.x += part.LGROOVE;
+    adg_path_line_to(path, &pair);
+
+    pair.y = part.D3 / 2;
+    adg_model_set_named_pair(model, "DGROOVEX_POS", &pair);
+
+    pair.y = part.D1 / 2;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "DGROOVEF_X", &pair);
+}
+
+static AdgPath *
+_bench_piston_hole(void)
+{
+    AdgPath *path;
+    AdgModel *model;
+    CpmlPair pair, edge;
+
+    path = adg_path_new();
+    model = ADG_MODEL(path);
+
+    pair.x = part.LHOLE;
+    pair.y = 0;
+    adg_path_move_to(path, &pair);
+    adg_model_set_named_pair(model, "LHOLE", &pair);
+
+    pair.y = part.DHOLE / 2;
+    pair.x -= pair.y / SQRT3;
+    adg_path_line_to(path, &pair);
+    cpml_pair_copy(&edge, &pair);
+
+    pair.x = 0;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "DHOLE", &pair);
+
+    pair.y = (part.D1 + part.DHOLE) / 4;
+    adg_path_line_to(path, &pair);
+
+    adg_path_curve_to_explicit(path,
+                               part.LHOLE / 2, part.DHOLE / 2,
+                               part.LHOLE + 2, part.D1 / 2,
+                               part.LHOLE + 2, 0);
+    adg_path_reflect(path, NULL);
+    adg_path_join(path);
+    adg_path_close(path);
+
+    adg_path_move_to(path, &edge);
+    edge.y = -edge.y;
+    adg_path_line_to(path, &edge);
+
+    return path;
+}
+
+static AdgPath *
+_bench_piston_body(void)
+{
+    AdgPath *path;
+    AdgModel *model;
+    CpmlPair pair, tmp;
+    const CpmlPrimitive *primitive;
+
+    path = adg_path_new();
+    model = ADG_MODEL(path);
+
+    pair.x = 0;
+    pair.y = part.D1 / 2;
+    adg_path_move_to(path, &pair);
+    adg_model_set_named_pair(model, "D1I", &pair);
+
+    _bench_add_groove(path);
+
+    pair.x = part.A - part.B - part.LD2;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "D1F", &pair);
+
+    pair.y = part.D3 / 2;
+    adg_model_set_named_pair(model, "D2_POS", &pair);
+
+    pair.x += (part.D1 - part.D2) / 2;
+    pair.y = part.D2 / 2;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "D2I", &pair);
+
+    pair.x = part.A - part.B;
+    adg_path_line_to(path, &pair);
+    adg_path_fillet(path, 0.4);
+
+    pair.x = part.A - part.B;
+    pair.y = part.D3 / 2;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "D3I", &pair);
+
+    pair.x = part.A;
+    adg_model_set_named_pair(model, "East", &pair);
+
+    pair.x = 0;
+    adg_model_set_named_pair(model, "West", &pair);
+
+    adg_path_chamfer(path, CHAMFER, CHAMFER);
+
+    pair.x = part.A - part.B + part.LD3;
+    pair.y = part.D3 / 2;
+    adg_path_line_to(path, &pair);
+
+    primitive = adg_path_over_primitive(path);
+    cpml_primitive_put_point(primitive, 0, &tmp);
+    adg_model_set_named_pair(model, "D3I_X", &tmp);
+    cpml_primitive_put_point(primitive, -1, &tmp);
+    adg_model_set_named_pair(model, "D3I_Y", &tmp);
+
+    adg_path_chamfer(path, CHAMFER, CHAMFER);
+
+    pair.y = part.D4 / 2;
+    adg_path_line_to(path, &pair);
+
+    primitive = adg_path_over_primitive(path);
+    cpml_primitive_put_point(primitive, 0, &tmp);
+    adg_model_set_named_pair(model, "D3F_Y", &tmp);
+    cpml_primitive_put_point(primitive, -1, &tmp);
+    adg_model_set_named_pair(model, "D3F_X", &tmp);
+
+    adg_path_fillet(path, part.RD34);
+
+    pair.x += part.RD34;
+    adg_model_set_named_pair(model, "D4I", &pair);
+
+    pair.x = part.A - part.C - part.LD5;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "D4F", &pair);
+
+    pair.y = part.D3 / 2;
+    adg_model_set_named_pair(model, "D4_POS", &pair);
+
+    primitive = adg_path_over_primitive(path);
+    cpml_primitive_put_point(primitive, 0, &tmp);
+    tmp.x += part.RD34;
+    adg_model_set_named_pair(model, "RD34", &tmp);
+
+    tmp.x -= cos(G_PI_4) * part.RD34;
+    tmp.y -= sin(G_PI_4) * part.RD34;
+    adg_model_set_named_pair(model, "RD34_R", &tmp);
+
+    tmp.x += part.RD34;
+    tmp.y += part.RD34;
+    adg_model_set_named_pair(model, "RD34_XY", &tmp);
+
+    pair.x += (part.D4 - part.D5) / 2;
+    pair.y = part.D5 / 2;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "D5I", &pair);
+
+    pair.x = part.A - part.C;
+    adg_path_line_to(path, &pair);
+    adg_path_fillet(path, 0.2);
+
+    pair.y = part.D6 / 2;
+    adg_path_line_to(path, &pair);
+
+    primitive = adg_path_over_primitive(path);
+    cpml_primitive_put_point(primitive, 0, &tmp);
+    adg_model_set_named_pair(model, "D5F", &tmp);
+
+    adg_path_fillet(path, 0.1);
+
+    pair.x += part.LD6;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "D6F", &pair);
+
+    primitive = adg_path_over_primitive(path);
+    cpml_primitive_put_point(primitive, 0, &tmp);
+    adg_model_set_named_pair(model, "D6I_X", &tmp);
+    cpml_primitive_put_point(primitive, -1, &tmp);
+    adg_model_set_named_pair(model, "D6I_Y", &tmp);
+
+    pair.x = part.A - part.LD7;
+    pair.y -= (part.C - part.LD7 - part.LD6) / SQRT3;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "D67", &pair);
+
+    pair.y = part.D7 / 2;
+    adg_path_line_to(path, &pair);
+
+    pair.x = part.A;
+    adg_path_line_to(path, &pair);
+    adg_model_set_named_pair(model, "D7F", &pair);
+
+    adg_path_reflect(path, NULL);
+    adg_path_join(path);
+    adg_path_close(path);
+
+    return path;
+}
+
+static void
+_bench_piston_dimensions(AdgContainer *container, AdgModel *model)
+{
+    AdgDim *dim;
+
+    dim = (AdgDim *) adg_ldim_new_full_from_model(model, "-D3I_X", "-D3F_X",
+                                                  "-D3F_Y", ADG_DIR_UP);
+    adg_dim_set_outside(dim, ADG_THREE_STATE_OFF);
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_ldim_new_full_from_model(model, "-D6I_X", "-D7F",
+                                                  "-East", ADG_DIR_UP);
+    adg_dim_set_limits(dim, "-0.06", NULL);
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_adim_new_full_from_model(model, "-D6I_Y", "-D6F",
+                                                  "-D6F", "-D67", "-D6F");
+    adg_dim_set_level(dim, 2);
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_rdim_new_full_from_model(model, "-RD34", "-RD34_R",
+                                                  "-RD34_XY");
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_ldim_new_full_from_model(model, "-DGROOVEI_X", "-DGROOVEF_X",
+                                                  "-DGROOVEX_POS", ADG_DIR_UP);
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_ldim_new_full_from_model(model, "D2I", "-D2I",
+                                                  "-D2_POS", ADG_DIR_LEFT);
+    adg_dim_set_limits(dim, "-0.1", NULL);
+    adg_dim_set_outside(dim, ADG_THREE_STATE_OFF);
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_adim_new_full_from_model(model, "D1F", "D1I",
+                                                  "D2I", "D1F", "D1F");
+    adg_dim_set_level(dim, 2);
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_ldim_new_full_from_model(model, "D1I", "DGROOVEI_X",
+                                                  "West", ADG_DIR_DOWN);
+    adg_dim_set_level(dim, 2);
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_ldim_new_full_from_model(model, "D4F", "D6I_X",
+                                                  "D4_POS", ADG_DIR_DOWN);
+    adg_dim_set_limits(dim, NULL, "+0.2");
+    adg_dim_set_outside(dim, ADG_THREE_STATE_OFF);
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_ldim_new_full_from_model(model, "D1I", "D7F",
+                                                  "D3F_Y", ADG_DIR_DOWN);
+    adg_dim_set_limits(dim, "-0.05", "+0.05");
+    adg_dim_set_level(dim, 3);
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_ldim_new_full_from_model(model, "D6F", "-D6F",
+                                                  "East", ADG_DIR_RIGHT);
+    adg_dim_set_limits(dim, "-0.1", NULL);
+    adg_dim_set_level(dim, 4);
+    adg_container_add(container, ADG_ENTITY(dim));
+
+    dim = (AdgDim *) adg_ldim_new_full_from_model(model, "D1I", "-D1I",
+                                                  "-West", ADG_DIR_LEFT);
+    adg_dim_set_limits(dim, "-0.05", "+0.05");
+    adg_dim_set_level(dim, 2);
+    adg_container_add(container, ADG_ENTITY(dim));
+}
+
+static gpointer
+_bench_pistons(AdgContainer *container, gint n)
+{
+    AdgContainer *piston;
+    AdgPath *body, *hole, *axis, *first;
+    AdgEdges *edges;
+    AdgStroke *stroke;
+    cairo_matrix_t map;
+    gdouble x, y;
+    gint i;
+
+    first = NULL;
+
+    for (i = 0; i < n; ++i) {
+        /* The piston is 50x14: use a wider cell */
+        _bench_cell(i, n, &x, &y);
+        cairo_matrix_init_translate(&map, x * 2, y / 2);
+
+        piston = adg_container_new();
+        adg_entity_set_local_map(ADG_ENTITY(piston), &map);
+        adg_container_add(container, ADG_ENTITY(piston));
+
+        body = _bench_piston_body();
+        hole = _bench_piston_hole();
+        edges = adg_edges_new_with_source(ADG_TRAIL(body));
+        axis = adg_path_new();
+        adg_path_move_to_explicit(axis, -1, 0);
+        adg_path_line_to_explicit(axis, part.A + 1, 0);
+
+        adg_container_add(piston, ADG_ENTITY(adg_stroke_new(ADG_TRAIL(body))));
+        adg_container_add(piston, ADG_ENTITY(adg_hatch_new(ADG_TRAIL(hole))));
+        adg_container_add(piston, ADG_ENTITY(adg_stroke_new(ADG_TRAIL(hole))));
+        adg_container_add(piston, ADG_ENTITY(adg_stroke_new(ADG_TRAIL(edges))));
+        stroke = adg_stroke_new(ADG_TRAIL(axis));
+        adg_stroke_set_line_dress(stroke, ADG_DRESS_LINE_AXIS);
+        adg_container_add(piston, ADG_ENTITY(stroke));
+        _bench_piston_dimensions(piston, ADG_MODEL(body));
+
+        g_object_unref(body);
+        g_object_unref(hole);
+        g_object_unref(edges);
+        g_object_unref(axis);
+
+        if (first == NULL)
+            first = body;
+    }
+
+    return first;
+}
+
+
+static const BenchScenario scenarios[] = {
+    { "strokes",    _bench_strokes,     _bench_model_changed },
+    { "dimensions", _bench_dimensions,  _bench_model_changed },
+    { "hatches",    _bench_hatches,     _bench_model_changed },
+    { "table",      _bench_table,       _bench_table_changed },
+    { "pistons",    _bench_pistons,     _bench_model_changed },
+};
+
+static void
+_bench_export(AdgCanvas *canvas, cairo_surface_type_t type,
+              const gchar *extension)
+{
+    gchar *template, *file;
+    GError *error;
+    gint64 start;
+    gboolean done;
+    gint fd;
+
+    template = g_strdup_printf("adg-bench-XXXXXX.%s", extension);
+    error = NULL;
+    fd = g_file_open_tmp(template, &file, &error);
+    g_free(template);
+
+    if (fd < 0) {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        g_print(",\n      \"export_%s\": null", extension);
+        return;
+    }
+
+    g_close(fd, NULL);
+
+    start = g_get_monotonic_time();
+    done = adg_canvas_export(canvas, type, file, &error);
+
+    /* Formats not supported by cairo are reported as null */
+    if (done)
+        g_print(",\n      \"export_%s\": %.3f", extension, _bench_elapsed(start));
+    else
+        g_print(",\n      \"export_%s\": null", extension);
+
+    if (error != NULL)
+        g_error_free(error);
+
+    g_remove(file);
+    g_free(file);
+}
+
+static void
+_bench_run(const BenchScenario *scenario, gint n)
+{
+    AdgCanvas *canvas;
+    AdgEntity *entity;
+    const CpmlExtents *extents;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gpointer target;
+    gint64 start;
+    gint width, height;
+
+    g_print("    {\n      \"name\": \"%s\",\n      \"size\": %d", scenario->name, n);
+
+    start = g_get_monotonic_time();
+    canvas = adg_canvas_new();
+    entity = ADG_ENTITY(canvas);
+    target = scenario->build(ADG_CONTAINER(canvas), n);
+    g_print(",\n      \"build\": %.3f", _bench_elapsed(start));
+
+    start = g_get_monotonic_time();
+    adg_entity_arrange(entity);
+    g_print(",\n      \"arrange\": %.3f", _bench_elapsed(start));
+
+    start = g_get_monotonic_time();
+    scenario->change(target);
+    adg_entity_arrange(entity);
+    g_print(",\n      \"rearrange\": %.3f", _bench_elapsed(start));
+
+    extents = adg_entity_get_extents(entity);
+    width = CLAMP(extents->size.x, 1, 4096);
+    height = CLAMP(extents->size.y, 1, 4096);
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cr = cairo_create(surface);
+    cairo_translate(cr, -extents->org.x, -extents->org.y);
+
+    start = g_get_monotonic_time();
+    adg_entity_render(entity, cr);
+    cairo_surface_flush(surface);
+    g_print(",\n      \"render\": %.3f", _bench_elapsed(start));
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+
+    _bench_export(canvas, CAIRO_SURFACE_TYPE_PDF, "pdf");
+    _bench_export(canvas, CAIRO_SURFACE_TYPE_SVG, "svg");
+    _bench_export(canvas, CAIRO_SURFACE_TYPE_IMAGE, "png");
+
+    start = g_get_monotonic_time();
+    adg_entity_destroy(entity);
+    g_print(",\n      \"destroy\": %.3f\n    }", _bench_elapsed(start));
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError *error;
+    guint n;
+    GOptionEntry entries[] = {
+        { "scale", 'n', 0, G_OPTION_ARG_INT, &scale,
+          "Number of items in every synthetic scenario", "N" },
+        { "pistons", 'm', 0, G_OPTION_ARG_INT, &pistons,
+          "Number of replicated demo pistons", "M" },
+        { NULL }
+    };
+
+    context = g_option_context_new("- benchmark the ADG library");
+    g_option_context_add_main_entries(context, entries, NULL);
+    error = NULL;
+
+    if (! g_option_context_parse(context, &argc, &argv, &error)) {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        g_option_context_free(context);
+        return 1;
+    }
+
+    g_option_context_free(context);
+
+    g_print("{\n  \"scale\": %d,\n  \"pistons\": %d,\n  \"scenarios\": [\n",
+            scale, pistons);
+
+    for (n = 0; n < G_N_ELEMENTS(scenarios); ++n) {
+        if (n > 0)
+            g_print(",\n");
+        _bench_run(&scenarios[n],
+                   scenarios[n].build == _bench_pistons ? pistons : scale);
+    }
+
+    g_print("\n  ]\n}\n");
+
+    return 0;
+}
@@ -87,6 +87,33 @@ _adg_property_angle(void)
     adg_entity_destroy((AdgEntity *) arrow);
 }
 
+static void
+_adg_behavior_model(void)
+{
+    AdgMarker *marker;
+    AdgModel *model;
+    const cairo_path_t *cairo_path;
+
+    marker = ADG_MARKER(adg_arrow_new());
+    model = adg_marker_model(marker);
+    g_assert_nonnull(model);
+    cairo_path = adg_trail_get_cairo_path(ADG_TRAIL(model));
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, 7);
+
+    /* Without arcs the trail uses the model data as is */
+    g_assert_cmpuint(adg_trail_get_memory_size(ADG_TRAIL(model)), ==, 0);
+
+    /* The same trail is reused after an invalidation */
+    adg_entity_invalidate(ADG_ENTITY(marker));
+    g_assert_true(adg_marker_model(marker) == model);
+    cairo_path = adg_trail_get_cairo_path(ADG_TRAIL(model));
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, 7);
+
+    adg_entity_destroy(ADG_ENTITY(marker));
+}
+
 
 int
 main(int argc, char *argv[])
@@ -96,6 +123,8 @@ main(int argc, char *argv[])
     adg_test_add_object_checks("/adg/arrow/type/object", ADG_TYPE_ARROW);
     adg_test_add_entity_checks("/adg/arrow/type/entity", ADG_TYPE_ARROW);
 
+    g_test_add_func("/adg/arrow/behavior/model", _adg_behavior_model);
+
     g_test_add_func("/adg/arrow/property/local-mix", _adg_property_local_mix);
     g_test_add_func("/adg/arrow/property/angle", _adg_property_angle);
 
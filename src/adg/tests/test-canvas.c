@@ -21,6 +21,7 @@
 #include <config.h>
 #include <adg-test.h>
 #include <adg.h>
+#include <string.h>
 
 #ifdef G_OS_WIN32
 
@@ -72,6 +73,397 @@ _adg_behavior_entity(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static void
+_adg_count(AdgEntity *entity, gpointer cr, gint *counter)
+{
+    ++*counter;
+}
+
+static void
+_adg_behavior_cache(void)
+{
+    AdgCanvas *canvas;
+    AdgLDim *ldim;
+    AdgEntity *quote;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gint n;
+
+    canvas = adg_canvas_new();
+    ldim = adg_ldim_new_full_explicit(0, 0, 50, 0, 25, 30, 0);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(ldim));
+    adg_canvas_set_cache_budget(canvas, 4000000);
+    g_assert_cmpuint(adg_canvas_get_cache_budget(canvas), ==, 4000000);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 400, 400);
+    cr = cairo_create(surface);
+
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    quote = ADG_ENTITY(adg_dim_get_quote(ADG_DIM(ldim)));
+    g_assert_nonnull(quote);
+
+    /* The quote is rendered by the dimension: if the dimension is
+     * retained, the quote must not be rendered again */
+    n = 0;
+    g_signal_connect(quote, "render", G_CALLBACK(_adg_count), &n);
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    g_assert_cmpint(n, ==, 0);
+
+    /* Any change must drop the retained output */
+    adg_entity_global_changed(ADG_ENTITY(ldim));
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    g_assert_cmpint(n, ==, 1);
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    g_assert_cmpint(n, ==, 1);
+
+    /* Same thing when the device transformation changes */
+    cairo_translate(cr, 1, 1);
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    g_assert_cmpint(n, ==, 2);
+
+    /* A too small budget cannot retain anything */
+    adg_canvas_set_cache_budget(canvas, 1);
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    g_assert_cmpint(n, ==, 4);
+
+    /* Disabling the cache */
+    adg_canvas_set_cache_budget(canvas, 0);
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    g_assert_cmpint(n, ==, 5);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static guint
+_adg_alpha(cairo_surface_t *surface, gdouble x, gdouble y)
+{
+    const guint32 *pixel;
+
+    cairo_surface_flush(surface);
+    pixel = (const guint32 *) (cairo_image_surface_get_data(surface) +
+                               (gint) y * cairo_image_surface_get_stride(surface));
+    return pixel[(gint) x] >> 24;
+}
+
+static void
+_adg_behavior_lod(void)
+{
+    AdgCanvas *canvas;
+    AdgToyText *toy_text;
+    const CpmlExtents *extents;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gdouble proxy_size, hide_size, x, y, width, height;
+
+    canvas = adg_canvas_new();
+    toy_text = adg_toy_text_new("Level of detail");
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(toy_text));
+
+    /* The policy is disabled by default */
+    adg_canvas_get_lod_sizes(canvas, &proxy_size, &hide_size);
+    adg_assert_isapprox(proxy_size, 0);
+    adg_assert_isapprox(hide_size, 0);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 400, 400);
+    cr = cairo_create(surface);
+    cairo_translate(cr, 100, 100);
+
+    adg_entity_arrange(ADG_ENTITY(toy_text));
+    extents = adg_entity_get_extents(ADG_ENTITY(toy_text));
+    g_assert_true(extents->is_defined);
+    x = extents->org.x + extents->size.x / 2;
+    y = extents->org.y + extents->size.y / 2;
+    cairo_user_to_device(cr, &x, &y);
+
+    /* Smaller than the hide threshold: nothing is rendered */
+    adg_canvas_set_lod_sizes(canvas, 0, 1000);
+    adg_canvas_get_lod_sizes(canvas, NULL, &hide_size);
+    adg_assert_isapprox(hide_size, 1000);
+    adg_entity_render(ADG_ENTITY(toy_text), cr);
+    g_assert_cmpuint(_adg_alpha(surface, x, y), ==, 0);
+
+    /* Smaller than the proxy threshold: a translucent box is rendered */
+    adg_canvas_set_lod_sizes(canvas, 1000, 0);
+    adg_canvas_get_lod_sizes(canvas, &proxy_size, NULL);
+    adg_assert_isapprox(proxy_size, 1000);
+    adg_entity_render(ADG_ENTITY(toy_text), cr);
+    g_assert_cmpuint(_adg_alpha(surface, x, y), >, 100);
+    g_assert_cmpuint(_adg_alpha(surface, x, y), <, 160);
+
+    /* Vector outputs are never simplified */
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    surface = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, NULL);
+    cr = cairo_create(surface);
+    adg_canvas_set_lod_sizes(canvas, 0, 1000);
+    adg_entity_render(ADG_ENTITY(toy_text), cr);
+    cairo_recording_surface_ink_extents(surface, &x, &y, &width, &height);
+    g_assert_cmpfloat(width, >, 0);
+    g_assert_cmpfloat(height, >, 0);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_clear(cairo_t *cr)
+{
+    cairo_save(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+static void
+_adg_behavior_cache_style(void)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgStroke *stroke;
+    AdgLineStyle *line_style;
+    AdgColorStyle *color_style;
+    const CpmlExtents *extents;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gdouble x, y;
+
+    canvas = adg_canvas_new();
+    adg_canvas_set_cache_budget(canvas, 4000000);
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 100, 100);
+    adg_path_line_to_explicit(path, 200, 100);
+    adg_path_line_to_explicit(path, 200, 200);
+    adg_path_line_to_explicit(path, 100, 200);
+    adg_path_close(path);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    g_object_unref(path);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(stroke));
+
+    /* Use custom styles, so the fallback ones are left untouched */
+    line_style = g_object_new(ADG_TYPE_LINE_STYLE, "width", 1., NULL);
+    color_style = g_object_new(ADG_TYPE_COLOR_STYLE, "alpha", 1., NULL);
+    adg_entity_set_style(ADG_ENTITY(stroke), ADG_DRESS_LINE_STROKE,
+                         ADG_STYLE(line_style));
+    adg_entity_set_style(ADG_ENTITY(stroke), ADG_DRESS_COLOR,
+                         ADG_STYLE(color_style));
+    g_object_unref(line_style);
+    g_object_unref(color_style);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 400, 400);
+    cr = cairo_create(surface);
+
+    adg_entity_arrange(ADG_ENTITY(stroke));
+    extents = adg_entity_get_extents(ADG_ENTITY(stroke));
+    g_assert_true(extents->is_defined);
+
+    /* A point just outside the left edge of the square */
+    x = extents->org.x - 4;
+    y = extents->org.y + extents->size.y / 2;
+    cairo_user_to_device(cr, &x, &y);
+
+    /* Render twice, so the second output comes from the snapshot */
+    adg_entity_render(ADG_ENTITY(stroke), cr);
+    _adg_clear(cr);
+    adg_entity_render(ADG_ENTITY(stroke), cr);
+    g_assert_cmpuint(_adg_alpha(surface, x, y), ==, 0);
+
+    /* A wider line must cover that point */
+    g_object_set(line_style, "width", 20., NULL);
+    _adg_clear(cr);
+    adg_entity_render(ADG_ENTITY(stroke), cr);
+    g_assert_cmpuint(_adg_alpha(surface, x, y), ==, 255);
+
+    /* A transparent color must clear it again */
+    adg_color_style_set_alpha(color_style, 0);
+    _adg_clear(cr);
+    adg_entity_render(ADG_ENTITY(stroke), cr);
+    g_assert_cmpuint(_adg_alpha(surface, x, y), ==, 0);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_behavior_allocations(void)
+{
+    AdgCanvas *canvas;
+    AdgTestAllocations first, again;
+    AdgMemoryStats *stats;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    guint n, n_stats;
+    gsize snapshots;
+
+    canvas = adg_canvas_new();
+    adg_container_add(ADG_CONTAINER(canvas),
+                      ADG_ENTITY(adg_ldim_new_full_explicit(0, 0, 50, 0, 25, 30, 0)));
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 200, 200);
+    cr = cairo_create(surface);
+
+    if (! adg_test_allocations_begin()) {
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+        adg_entity_destroy(ADG_ENTITY(canvas));
+        g_test_skip("Allocation hooks not available");
+        return;
+    }
+
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    adg_test_allocations_end(&first);
+    g_assert_cmpuint(first.n_allocations, >, 0);
+
+    /* Re-arranging an unchanged canvas must not allocate anything */
+    adg_test_allocations_begin();
+    adg_entity_arrange(ADG_ENTITY(canvas));
+    adg_test_allocations_end(&again);
+    g_assert_cmpuint(again.n_allocations, ==, 0);
+    g_assert_cmpint(again.peak_bytes, ==, 0);
+
+    /* A retained re-render just paints the snapshots: whatever cairo
+     * needs for that is transient and the same for every pass */
+    adg_canvas_set_cache_budget(canvas, 4000000);
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    snapshots = 0;
+    stats = adg_canvas_get_memory_stats(canvas, &n_stats);
+    for (n = 0; n < n_stats; ++n)
+        snapshots += stats[n].snapshots;
+    g_free(stats);
+    g_assert_cmpuint(snapshots, >, 0);
+
+    adg_test_allocations_begin();
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    adg_test_allocations_end(&first);
+    adg_test_allocations_begin();
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    adg_test_allocations_end(&again);
+    g_assert_cmpuint(again.n_allocations, ==, first.n_allocations);
+
+    /* Nothing is rebuilt, so no snapshot sized memory is ever held */
+    g_assert_cmpint(again.peak_bytes, <, (gint64) snapshots);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static AdgCanvas *
+_adg_arc_canvas(gboolean has_arena)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+
+    canvas = adg_canvas_new();
+    adg_canvas_switch_arena(canvas, has_arena);
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_arc_to_explicit(path, 50, 20, 100, 0);
+    adg_path_line_to_explicit(path, 100, 50);
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path))));
+    g_object_unref(path);
+
+    /* The markers of the dimension build their models on the arena */
+    adg_container_add(ADG_CONTAINER(canvas),
+                      ADG_ENTITY(adg_ldim_new_full_explicit(0, 0, 100, 0, 50, -30, 0)));
+
+    return canvas;
+}
+
+static gsize
+_adg_stats_paths(AdgCanvas *canvas, GType type)
+{
+    AdgMemoryStats *stats;
+    guint n, n_stats;
+    gsize paths;
+
+    stats = adg_canvas_get_memory_stats(canvas, &n_stats);
+    paths = 0;
+    for (n = 0; n < n_stats; ++n)
+        if (stats[n].type == type)
+            paths = stats[n].paths;
+    g_free(stats);
+
+    return paths;
+}
+
+static void
+_adg_behavior_arena(void)
+{
+    AdgCanvas *canvas, *arena_canvas;
+    const CpmlExtents *extents, *arena_extents;
+    cairo_surface_t *surface, *arena_surface;
+    cairo_t *cr, *arena_cr;
+    gsize size;
+    guint n;
+
+    canvas = _adg_arc_canvas(FALSE);
+    arena_canvas = _adg_arc_canvas(TRUE);
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 300, 300);
+    arena_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 300, 300);
+    cr = cairo_create(surface);
+    arena_cr = cairo_create(arena_surface);
+
+    /* The arena must not change the result, also when rewound */
+    for (n = 0; n < 3; ++n) {
+        adg_entity_invalidate(ADG_ENTITY(canvas));
+        adg_entity_invalidate(ADG_ENTITY(arena_canvas));
+        adg_entity_arrange(ADG_ENTITY(canvas));
+        adg_entity_arrange(ADG_ENTITY(arena_canvas));
+
+        extents = adg_entity_get_extents(ADG_ENTITY(canvas));
+        arena_extents = adg_entity_get_extents(ADG_ENTITY(arena_canvas));
+        g_assert_true(arena_extents->is_defined);
+        adg_assert_isapprox(arena_extents->org.x, extents->org.x);
+        adg_assert_isapprox(arena_extents->org.y, extents->org.y);
+        adg_assert_isapprox(arena_extents->size.x, extents->size.x);
+        adg_assert_isapprox(arena_extents->size.y, extents->size.y);
+
+        adg_entity_render(ADG_ENTITY(canvas), cr);
+        adg_entity_render(ADG_ENTITY(arena_canvas), arena_cr);
+        cairo_surface_flush(surface);
+        cairo_surface_flush(arena_surface);
+        size = cairo_image_surface_get_stride(surface) *
+               cairo_image_surface_get_height(surface);
+        g_assert_cmpint(memcmp(cairo_image_surface_get_data(surface),
+                               cairo_image_surface_get_data(arena_surface),
+                               size), ==, 0);
+    }
+
+    /* The memory owned by the arena belongs to the canvas and it
+     * has been really used: the arrow models of the canvas without
+     * arena own their path data, the ones on the arena do not. The
+     * memory of the model trails is counted too and, as the arrow
+     * paths have no arcs, it is not a copy of the arena data */
+    g_assert_cmpuint(_adg_stats_paths(canvas, ADG_TYPE_CANVAS), ==, 0);
+    g_assert_cmpuint(_adg_stats_paths(arena_canvas, ADG_TYPE_CANVAS), >, 0);
+    g_assert_cmpuint(_adg_stats_paths(arena_canvas, ADG_TYPE_ARROW), ==, 0);
+    g_assert_cmpuint(_adg_stats_paths(canvas, ADG_TYPE_ARROW), >, 0);
+
+    /* Disabling the arena releases its memory */
+    adg_canvas_switch_arena(arena_canvas, FALSE);
+    g_assert_cmpuint(_adg_stats_paths(arena_canvas, ADG_TYPE_CANVAS), ==, 0);
+
+    /* Without arena, the models are rebuilt on the heap on demand */
+    adg_entity_invalidate(ADG_ENTITY(arena_canvas));
+    adg_entity_render(ADG_ENTITY(arena_canvas), arena_cr);
+    g_assert_cmpuint(_adg_stats_paths(arena_canvas, ADG_TYPE_ARROW), ==,
+                     _adg_stats_paths(canvas, ADG_TYPE_ARROW));
+
+    cairo_destroy(cr);
+    cairo_destroy(arena_cr);
+    cairo_surface_destroy(surface);
+    cairo_surface_destroy(arena_surface);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+    adg_entity_destroy(ADG_ENTITY(arena_canvas));
+}
+
 static void
 _adg_behavior_misc(void)
 {
@@ -528,6 +920,45 @@ _adg_property_has_frame(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static void
+_adg_property_has_arena(void)
+{
+    AdgCanvas *canvas;
+    gboolean invalid_boolean;
+    gboolean has_arena;
+
+    canvas = ADG_CANVAS(adg_canvas_new());
+    invalid_boolean = (gboolean) 1234;
+
+    /* Disabled by default */
+    has_arena = adg_canvas_has_arena(canvas);
+    g_assert_false(has_arena);
+
+    /* Using the public APIs */
+    adg_canvas_switch_arena(canvas, TRUE);
+    has_arena = adg_canvas_has_arena(canvas);
+    g_assert_true(has_arena);
+
+    adg_canvas_switch_arena(canvas, invalid_boolean);
+    has_arena = adg_canvas_has_arena(canvas);
+    g_assert_true(has_arena);
+
+    adg_canvas_switch_arena(canvas, FALSE);
+    has_arena = adg_canvas_has_arena(canvas);
+    g_assert_false(has_arena);
+
+    /* Using GObject property methods */
+    g_object_set(canvas, "has-arena", TRUE, NULL);
+    g_object_get(canvas, "has-arena", &has_arena, NULL);
+    g_assert_true(has_arena);
+
+    g_object_set(canvas, "has-arena", FALSE, NULL);
+    g_object_get(canvas, "has-arena", &has_arena, NULL);
+    g_assert_false(has_arena);
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
 static void
 _adg_property_top_padding(void)
 {
@@ -874,6 +1305,67 @@ _adg_method_export(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static void
+_adg_method_get_memory_stats(void)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    AdgToyText *toy_text;
+    AdgMemoryStats *stats, *stroke, *text;
+    guint n, n_stats;
+
+    canvas = adg_canvas_new();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_line_to_explicit(path, 10, 10);
+    toy_text = adg_toy_text_new("Memory");
+
+    /* Two strokes sharing the same trail */
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path))));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path))));
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(toy_text));
+    g_object_unref(path);
+    adg_entity_arrange(ADG_ENTITY(canvas));
+
+    /* Sanity checks */
+    g_assert_null(adg_canvas_get_memory_stats(NULL, &n_stats));
+    g_assert_null(adg_canvas_get_memory_stats(canvas, NULL));
+
+    stats = adg_canvas_get_memory_stats(canvas, &n_stats);
+    g_assert_nonnull(stats);
+    g_assert_cmpuint(n_stats, ==, 3);
+
+    stroke = text = NULL;
+    for (n = 0; n < n_stats; ++n) {
+        g_assert_cmpuint(stats[n].n_entities, >, 0);
+        g_assert_cmpuint(stats[n].instance, >, 0);
+        if (stats[n].type == ADG_TYPE_STROKE)
+            stroke = &stats[n];
+        else if (stats[n].type == ADG_TYPE_TOY_TEXT)
+            text = &stats[n];
+        else
+            g_assert_true(stats[n].type == ADG_TYPE_CANVAS);
+    }
+
+    /* The shared trail must be accounted only once */
+    g_assert_nonnull(stroke);
+    g_assert_cmpuint(stroke->n_entities, ==, 2);
+    g_assert_cmpuint(stroke->paths, ==, adg_trail_get_memory_size(ADG_TRAIL(path)));
+    g_assert_cmpuint(stroke->paths, >, 0);
+
+    g_assert_nonnull(text);
+    g_assert_cmpuint(text->n_entities, ==, 1);
+    g_assert_cmpuint(text->text, >, 0);
+
+    g_free(stats);
+
+    /* Accounting outside of a report is a no-op */
+    g_assert_false(adg_entity_account_shared(canvas));
+
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
 static void
 _adg_method_export_data(void)
 {
@@ -1080,6 +1572,11 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/canvas/behavior/entity", _adg_behavior_entity);
     g_test_add_func("/adg/canvas/behavior/misc", _adg_behavior_misc);
+    g_test_add_func("/adg/canvas/behavior/cache", _adg_behavior_cache);
+    g_test_add_func("/adg/canvas/behavior/cache-style", _adg_behavior_cache_style);
+    g_test_add_func("/adg/canvas/behavior/lod", _adg_behavior_lod);
+    g_test_add_func("/adg/canvas/behavior/allocations", _adg_behavior_allocations);
+    g_test_add_func("/adg/canvas/behavior/arena", _adg_behavior_arena);
     adg_test_add_global_space_checks("/adg/canvas/behavior/global-space", adg_test_canvas());
     adg_test_add_local_space_checks("/adg/canvas/behavior/local-space", adg_test_canvas());
 
@@ -1094,6 +1591,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/canvas/property/bottom-margin", _adg_property_bottom_margin);
     g_test_add_func("/adg/canvas/property/left-margin", _adg_property_left_margin);
     g_test_add_func("/adg/canvas/property/has-frame", _adg_property_has_frame);
+    g_test_add_func("/adg/canvas/property/has-arena", _adg_property_has_arena);
     g_test_add_func("/adg/canvas/property/top-padding", _adg_property_top_padding);
     g_test_add_func("/adg/canvas/property/right-padding", _adg_property_right_padding);
     g_test_add_func("/adg/canvas/property/bottom-padding", _adg_property_bottom_padding);
@@ -1107,6 +1605,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/canvas/method/get-paddings", _adg_method_get_paddings);
     g_test_add_func("/adg/canvas/method/export", _adg_method_export);
     g_test_add_func("/adg/canvas/method/export_data", _adg_method_export_data);
+    g_test_add_func("/adg/canvas/method/get-memory-stats", _adg_method_get_memory_stats);
 #if GTK3_ENABLED || GTK2_ENABLED
     g_test_add_func("/adg/canvas/method/set-paper", _adg_method_set_paper);
     g_test_add_func("/adg/canvas/method/get-page-setup", _adg_method_get_page_setup);
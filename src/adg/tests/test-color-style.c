@@ -182,6 +182,44 @@ _adg_property_red(void)
     g_object_unref(color_style);
 }
 
+static void
+_adg_method_apply(void)
+{
+    AdgColorStyle *color_style;
+    AdgEntity *entity;
+    cairo_t *cr;
+    cairo_pattern_t *source;
+    gdouble red, green, blue, alpha;
+
+    color_style = adg_color_style_new();
+    entity = ADG_ENTITY(adg_logo_new());
+    cr = adg_test_cairo_context();
+    adg_color_style_set_rgb(color_style, 0.25, 0.5, 0.75);
+
+    adg_style_apply(ADG_STYLE(color_style), entity, cr);
+    source = cairo_get_source(cr);
+    g_assert_cmpint(cairo_pattern_get_rgba(source, &red, &green, &blue, &alpha),
+                    ==, CAIRO_STATUS_SUCCESS);
+    adg_assert_isapprox(red, 0.25);
+    adg_assert_isapprox(green, 0.5);
+    adg_assert_isapprox(blue, 0.75);
+    adg_assert_isapprox(alpha, 1);
+
+    /* Applying the same color again must not change the source */
+    adg_style_apply(ADG_STYLE(color_style), entity, cr);
+    g_assert_true(cairo_get_source(cr) == source);
+
+    adg_color_style_set_alpha(color_style, 0.5);
+    adg_style_apply(ADG_STYLE(color_style), entity, cr);
+    source = cairo_get_source(cr);
+    cairo_pattern_get_rgba(source, &red, &green, &blue, &alpha);
+    adg_assert_isapprox(alpha, 0.5);
+
+    cairo_destroy(cr);
+    adg_entity_destroy(entity);
+    g_object_unref(color_style);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -195,5 +233,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/color-style/property/green", _adg_property_green);
     g_test_add_func("/adg/color-style/property/red", _adg_property_red);
 
+    g_test_add_func("/adg/color-style/method/apply", _adg_method_apply);
+
     return g_test_run();
 }
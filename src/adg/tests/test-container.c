@@ -20,6 +20,7 @@
 
 #include <adg-test.h>
 #include <adg.h>
+#include <string.h>
 
 
 static void
@@ -46,6 +47,8 @@ _adg_behavior_misc(void)
     children = adg_container_children(container);
     g_assert_nonnull(children);
     g_assert_cmpint(g_slist_length(children), ==, 2);
+    g_assert_true(children->data == entity1);
+    g_assert_true(children->next->data == entity2);
     g_slist_free(children);
 
     adg_entity_destroy(entity1);
@@ -61,6 +64,413 @@ _adg_behavior_misc(void)
     adg_entity_destroy(ADG_ENTITY(container));
 }
 
+static void
+_adg_collect(AdgEntity *entity, GSList **list)
+{
+    *list = g_slist_prepend(*list, entity);
+}
+
+static void
+_adg_behavior_many(void)
+{
+    AdgContainer *container;
+    AdgEntity *entities[100];
+    GSList *children, *node;
+    guint n;
+
+    container = adg_container_new();
+
+    for (n = 0; n < G_N_ELEMENTS(entities); ++n) {
+        entities[n] = ADG_ENTITY(adg_logo_new());
+        adg_container_add(container, entities[n]);
+    }
+
+    /* Remove the odd children, in different ways */
+    for (n = 1; n < G_N_ELEMENTS(entities); n += 2) {
+        if (n % 4 == 1)
+            adg_entity_destroy(entities[n]);
+        else
+            adg_container_remove(container, entities[n]);
+    }
+
+    /* The remaining children must keep their order */
+    children = NULL;
+    adg_container_foreach(container, G_CALLBACK(_adg_collect), &children);
+    children = g_slist_reverse(children);
+    g_assert_cmpuint(g_slist_length(children), ==, G_N_ELEMENTS(entities) / 2);
+    for (n = 0, node = children; node != NULL; n += 2, node = node->next)
+        g_assert_true(node->data == entities[n]);
+    g_slist_free(children);
+
+    /* Removed children must not be found anymore */
+    adg_container_remove(container, entities[0]);
+    children = adg_container_children(container);
+    g_assert_true(children->data == entities[2]);
+    g_slist_free(children);
+
+    adg_entity_destroy(ADG_ENTITY(container));
+}
+
+static void
+_adg_behavior_destroy(void)
+{
+    AdgContainer *container;
+    AdgPath *path;
+    AdgEntity *entities[100];
+    guint n;
+
+    container = adg_container_new();
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 10);
+
+    for (n = 0; n < G_N_ELEMENTS(entities); ++n) {
+        entities[n] = ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path)));
+        g_object_add_weak_pointer((GObject *) entities[n],
+                                  (gpointer *) &entities[n]);
+        adg_container_add(container, entities[n]);
+    }
+
+    /* Leave some holes in the children array */
+    adg_entity_destroy(entities[10]);
+    adg_entity_destroy(entities[50]);
+    g_assert_null(entities[10]);
+    g_assert_null(entities[50]);
+    g_assert_cmpuint(g_slist_length((GSList *) adg_model_get_dependencies(ADG_MODEL(path))),
+                     ==, G_N_ELEMENTS(entities) - 2);
+
+    /* Destroying the container must release every child
+     * and every dependency on the shared model */
+    adg_entity_destroy(ADG_ENTITY(container));
+    for (n = 0; n < G_N_ELEMENTS(entities); ++n)
+        g_assert_null(entities[n]);
+    g_assert_null(adg_model_get_dependencies(ADG_MODEL(path)));
+
+    g_object_unref(path);
+}
+
+static void
+_adg_count_render(AdgEntity *entity, cairo_t *cr, gpointer user_data)
+{
+    ++*(gint *) user_data;
+}
+
+static void
+_adg_behavior_culling(void)
+{
+    AdgContainer *container;
+    AdgEntity *entity1, *entity2;
+    cairo_matrix_t map;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gint n1, n2;
+
+    container = adg_container_new();
+    entity1 = ADG_ENTITY(adg_logo_new());
+    entity2 = ADG_ENTITY(adg_logo_new());
+    adg_container_add(container, entity1);
+    adg_container_add(container, entity2);
+
+    /* Move the second entity far away from the clip area */
+    cairo_matrix_init_translate(&map, 10000, 10000);
+    adg_entity_set_global_map(entity2, &map);
+
+    n1 = n2 = 0;
+    g_signal_connect(entity1, "render", G_CALLBACK(_adg_count_render), &n1);
+    g_signal_connect(entity2, "render", G_CALLBACK(_adg_count_render), &n2);
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cr = cairo_create(surface);
+
+    adg_entity_render(ADG_ENTITY(container), cr);
+    g_assert_cmpint(n1, ==, 1);
+    g_assert_cmpint(n2, ==, 0);
+
+    /* Disabling culling must render everything */
+    adg_switch_culling(FALSE);
+    adg_entity_render(ADG_ENTITY(container), cr);
+    g_assert_cmpint(n1, ==, 2);
+    g_assert_cmpint(n2, ==, 1);
+    adg_switch_culling(TRUE);
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(ADG_ENTITY(container));
+}
+
+static guint
+_adg_arrange_count(GType type)
+{
+    AdgProfileStats *array;
+    guint n, n_stats, count;
+
+    array = adg_profile_get_stats(&n_stats);
+    count = 0;
+    for (n = 0; n < n_stats; ++n)
+        if (array[n].type == type)
+            count = array[n].arrange_count;
+    g_free(array);
+
+    return count;
+}
+
+static void
+_adg_dirty_once(AdgEntity *entity, gpointer user_data)
+{
+    gboolean *done = user_data;
+
+    if (! *done) {
+        *done = TRUE;
+        adg_entity_mark_dirty(entity);
+    }
+}
+
+static void
+_adg_behavior_dirty(void)
+{
+    AdgContainer *container;
+    AdgEntity *entity;
+    CpmlExtents extents, fake;
+    gboolean done;
+
+    container = adg_container_new();
+    entity = ADG_ENTITY(adg_logo_new());
+    adg_container_add(container, entity);
+
+    adg_entity_arrange(ADG_ENTITY(container));
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    g_assert_true(extents.is_defined);
+
+    /* Tamper the extents: a clean subtree must not be arranged again */
+    cpml_extents_copy(&fake, &extents);
+    fake.size.x += 1234;
+    adg_entity_set_extents(entity, &fake);
+    adg_entity_arrange(ADG_ENTITY(container));
+    adg_assert_isapprox(adg_entity_get_extents(entity)->size.x, fake.size.x);
+
+    /* Invalidating the child must trigger a new arrange */
+    adg_entity_invalidate(entity);
+    adg_entity_arrange(ADG_ENTITY(container));
+    adg_assert_isapprox(adg_entity_get_extents(entity)->size.x, extents.size.x);
+
+    /* Same thing when changing a map of an ancestor */
+    adg_entity_set_extents(entity, &fake);
+    adg_entity_set_global_map(ADG_ENTITY(container), adg_matrix_identity());
+    adg_entity_arrange(ADG_ENTITY(container));
+    adg_assert_isapprox(adg_entity_get_extents(entity)->size.x, extents.size.x);
+
+    /* Same thing when setting a property defined by a derived type */
+    adg_entity_set_extents(entity, &fake);
+    adg_logo_set_frame_dress(ADG_LOGO(entity),
+                             adg_logo_get_frame_dress(ADG_LOGO(entity)));
+    adg_entity_arrange(ADG_ENTITY(container));
+    adg_assert_isapprox(adg_entity_get_extents(entity)->size.x, extents.size.x);
+
+    adg_entity_destroy(ADG_ENTITY(container));
+
+    /* Setters not going through the property system must mark it too */
+    container = adg_container_new();
+    entity = ADG_ENTITY(adg_ldim_new_full_explicit(0, 0, 50, 0, 25, 30, 0));
+    adg_container_add(container, entity);
+    adg_entity_arrange(ADG_ENTITY(container));
+
+    adg_switch_profile(TRUE);
+    adg_profile_reset();
+    adg_entity_arrange(ADG_ENTITY(container));
+    g_assert_cmpuint(_adg_arrange_count(ADG_TYPE_LDIM), ==, 0);
+
+    adg_dim_set_level(ADG_DIM(entity), adg_dim_get_level(ADG_DIM(entity)));
+    adg_entity_arrange(ADG_ENTITY(container));
+    g_assert_cmpuint(_adg_arrange_count(ADG_TYPE_LDIM), ==, 1);
+    adg_profile_reset();
+    adg_switch_profile(FALSE);
+
+    adg_entity_destroy(ADG_ENTITY(container));
+
+    /* A child dirtied after being arranged in the arrange phase of its
+     * parent must be arranged again by the next phase */
+    container = adg_container_new();
+    entity = ADG_ENTITY(adg_logo_new());
+    adg_container_add(container, entity);
+    done = FALSE;
+    g_signal_connect_after(entity, "arrange",
+                           G_CALLBACK(_adg_dirty_once), &done);
+    adg_entity_arrange(ADG_ENTITY(container));
+    g_assert_true(done);
+
+    adg_switch_profile(TRUE);
+    adg_profile_reset();
+    adg_entity_arrange(ADG_ENTITY(container));
+    g_assert_cmpuint(_adg_arrange_count(ADG_TYPE_LOGO), ==, 1);
+    adg_entity_arrange(ADG_ENTITY(container));
+    g_assert_cmpuint(_adg_arrange_count(ADG_TYPE_LOGO), ==, 1);
+    adg_profile_reset();
+    adg_switch_profile(FALSE);
+
+    adg_entity_destroy(ADG_ENTITY(container));
+}
+
+static cairo_surface_t *
+_adg_render_strokes(AdgContainer *container, gboolean batching)
+{
+    cairo_surface_t *surface;
+    cairo_t *cr;
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cr = cairo_create(surface);
+
+    adg_switch_batching(batching);
+    adg_entity_render(ADG_ENTITY(container), cr);
+    adg_switch_batching(FALSE);
+
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+    return surface;
+}
+
+static void
+_adg_get_line_width(AdgEntity *entity, cairo_t *cr, gpointer user_data)
+{
+    gdouble *width = user_data;
+    *width = cairo_get_line_width(cr);
+}
+
+static void
+_adg_behavior_shared_styles(void)
+{
+    AdgContainer *container;
+    AdgLineStyle *line_style;
+    AdgPath *path;
+    AdgEntity *stroke1, *stroke2;
+    cairo_surface_t *surface;
+    gdouble width1, width2;
+
+    container = adg_container_new();
+    line_style = adg_line_style_new();
+    adg_line_style_set_width(line_style, 7);
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 10, 10);
+    adg_path_line_to_explicit(path, 90, 10);
+    stroke1 = ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path)));
+    stroke2 = ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path)));
+    g_object_unref(path);
+
+    adg_entity_set_style(stroke1, ADG_DRESS_LINE_STROKE, ADG_STYLE(line_style));
+    adg_entity_set_style(stroke2, ADG_DRESS_LINE_STROKE, ADG_STYLE(line_style));
+    adg_container_add(container, stroke1);
+    adg_container_add(container, stroke2);
+
+    /* The handlers run before the rendering, at the container level */
+    g_signal_connect(stroke1, "render",
+                     G_CALLBACK(_adg_get_line_width), &width1);
+    g_signal_connect(stroke2, "render",
+                     G_CALLBACK(_adg_get_line_width), &width2);
+
+    /* The line style applied by the first stroke must still be set
+     * when the second stroke starts rendering */
+    surface = _adg_render_strokes(container, FALSE);
+    adg_assert_isapprox(width1, 2);
+    adg_assert_isapprox(width2, 7);
+
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(ADG_ENTITY(container));
+    g_object_unref(line_style);
+}
+
+static void
+_adg_behavior_batching(void)
+{
+    AdgContainer *container;
+    AdgPath *path;
+    cairo_surface_t *surface1, *surface2;
+    gint n;
+
+    container = adg_container_new();
+
+    for (n = 0; n < 3; ++n) {
+        path = adg_path_new();
+        adg_path_move_to_explicit(path, 10, 10 + n * 30);
+        adg_path_line_to_explicit(path, 90, 10 + n * 30);
+        adg_container_add(container, ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path))));
+        g_object_unref(path);
+    }
+
+    /* Batched and unbatched strokes must give the same result */
+    surface1 = _adg_render_strokes(container, FALSE);
+    surface2 = _adg_render_strokes(container, TRUE);
+    g_assert_cmpint(cairo_image_surface_get_stride(surface1), ==,
+                    cairo_image_surface_get_stride(surface2));
+    g_assert_cmpint(memcmp(cairo_image_surface_get_data(surface1),
+                           cairo_image_surface_get_data(surface2),
+                           cairo_image_surface_get_stride(surface1) * 100), ==, 0);
+
+    cairo_surface_destroy(surface1);
+    cairo_surface_destroy(surface2);
+    adg_entity_destroy(ADG_ENTITY(container));
+}
+
+static gboolean
+_adg_same_surfaces(cairo_surface_t *surface1, cairo_surface_t *surface2)
+{
+    return memcmp(cairo_image_surface_get_data(surface1),
+                  cairo_image_surface_get_data(surface2),
+                  cairo_image_surface_get_stride(surface1) * 100) == 0;
+}
+
+static void
+_adg_behavior_batching_features(void)
+{
+    AdgCanvas *canvas;
+    AdgPath *path;
+    cairo_surface_t *plain, *surface1, *surface2;
+    AdgProfileStats *array;
+    guint n, n_stats, n_renders;
+
+    canvas = adg_canvas_new();
+
+    for (n = 0; n < 3; ++n) {
+        path = adg_path_new();
+        adg_path_move_to_explicit(path, 10, 10 + n * 30);
+        adg_path_line_to_explicit(path, 90, 10 + n * 30);
+        adg_container_add(ADG_CONTAINER(canvas),
+                          ADG_ENTITY(adg_stroke_new(ADG_TRAIL(path))));
+        g_object_unref(path);
+    }
+
+    plain = _adg_render_strokes(ADG_CONTAINER(canvas), TRUE);
+
+    /* The level of detail policy must hide the batchable strokes too */
+    adg_canvas_set_lod_sizes(canvas, 0, 1000);
+    surface1 = _adg_render_strokes(ADG_CONTAINER(canvas), FALSE);
+    surface2 = _adg_render_strokes(ADG_CONTAINER(canvas), TRUE);
+    g_assert_false(_adg_same_surfaces(surface1, plain));
+    g_assert_true(_adg_same_surfaces(surface1, surface2));
+    cairo_surface_destroy(surface1);
+    cairo_surface_destroy(surface2);
+    adg_canvas_set_lod_sizes(canvas, 0, 0);
+
+    /* The profiler must account every stroke */
+    adg_switch_profile(TRUE);
+    adg_profile_reset();
+    surface1 = _adg_render_strokes(ADG_CONTAINER(canvas), TRUE);
+    g_assert_true(_adg_same_surfaces(surface1, plain));
+    cairo_surface_destroy(surface1);
+
+    array = adg_profile_get_stats(&n_stats);
+    n_renders = 0;
+    for (n = 0; n < n_stats; ++n)
+        if (array[n].type == ADG_TYPE_STROKE)
+            n_renders = array[n].render_count;
+    g_assert_cmpuint(n_renders, ==, 3);
+    g_free(array);
+    adg_profile_reset();
+    adg_switch_profile(FALSE);
+
+    cairo_surface_destroy(plain);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
 static void
 _adg_property_child(void)
 {
@@ -131,6 +541,13 @@ main(int argc, char *argv[])
     adg_test_init(&argc, &argv);
 
     g_test_add_func("/adg/container/behavior/misc", _adg_behavior_misc);
+    g_test_add_func("/adg/container/behavior/many", _adg_behavior_many);
+    g_test_add_func("/adg/container/behavior/destroy", _adg_behavior_destroy);
+    g_test_add_func("/adg/container/behavior/culling", _adg_behavior_culling);
+    g_test_add_func("/adg/container/behavior/dirty", _adg_behavior_dirty);
+    g_test_add_func("/adg/container/behavior/shared-styles", _adg_behavior_shared_styles);
+    g_test_add_func("/adg/container/behavior/batching", _adg_behavior_batching);
+    g_test_add_func("/adg/container/behavior/batching-features", _adg_behavior_batching_features);
 
     adg_test_add_object_checks("/adg/container/type/object", ADG_TYPE_CONTAINER);
     adg_test_add_entity_checks("/adg/container/type/entity", ADG_TYPE_CONTAINER);
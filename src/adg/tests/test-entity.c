@@ -94,6 +94,47 @@ _adg_behavior_style(void)
     g_object_unref(line_style);
 }
 
+static void
+_adg_behavior_resolved_style(void)
+{
+    AdgContainer *container;
+    AdgEntity *entity;
+    AdgStyle *fallback, *line_style;
+    guint generation;
+
+    container = adg_container_new();
+    entity = ADG_ENTITY(adg_logo_new());
+    line_style = ADG_STYLE(adg_line_style_new());
+    fallback = adg_dress_get_fallback(ADG_DRESS_LINE);
+    g_object_ref(fallback);
+
+    adg_container_add(container, entity);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_LINE) == fallback);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_LINE) == fallback);
+
+    /* Styles overriden by an ancestor */
+    adg_entity_set_style(ADG_ENTITY(container), ADG_DRESS_LINE, line_style);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_LINE) == line_style);
+
+    /* Reparenting */
+    g_object_ref(entity);
+    adg_container_remove(container, entity);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_LINE) == fallback);
+
+    /* Changing the fallback style */
+    generation = adg_dress_get_generation();
+    adg_dress_set_fallback(ADG_DRESS_LINE, line_style);
+    g_assert_cmpuint(adg_dress_get_generation(), !=, generation);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_LINE) == line_style);
+    adg_dress_set_fallback(ADG_DRESS_LINE, fallback);
+    g_assert_true(adg_entity_style(entity, ADG_DRESS_LINE) == fallback);
+
+    g_object_unref(entity);
+    adg_entity_destroy(ADG_ENTITY(container));
+    g_object_unref(line_style);
+    g_object_unref(fallback);
+}
+
 static void
 _adg_behavior_local(void)
 {
@@ -143,6 +184,86 @@ _adg_behavior_local(void)
     adg_entity_destroy(ADG_ENTITY(canvas));
 }
 
+static gsize
+_adg_instance_size(AdgEntity *entity)
+{
+    AdgMemoryStats *stats;
+    guint n, n_stats;
+    gsize size;
+
+    stats = adg_entity_get_memory_stats(entity, &n_stats);
+    size = 0;
+    for (n = 0; n < n_stats; ++n)
+        size += stats[n].instance;
+    g_free(stats);
+
+    return size;
+}
+
+static void
+_adg_behavior_matrices(void)
+{
+    AdgContainer *container;
+    AdgEntity *child, *grandchild;
+    cairo_matrix_t map, translation, expected;
+    gsize size;
+
+    container = adg_container_new();
+    child = ADG_ENTITY(adg_container_new());
+    grandchild = ADG_ENTITY(adg_logo_new());
+    adg_container_add(container, child);
+    adg_container_add(ADG_CONTAINER(child), grandchild);
+
+    /* Identity maps are shared, not stored by every entity */
+    g_assert_true(adg_entity_get_global_map(grandchild) == adg_matrix_identity());
+    g_assert_true(adg_entity_get_local_map(grandchild) == adg_matrix_identity());
+
+    cairo_matrix_init_rotate(&map, G_PI_4);
+    cairo_matrix_scale(&map, 2, 3);
+    cairo_matrix_init_translate(&translation, 10, 20);
+    adg_entity_set_global_map(ADG_ENTITY(container), &map);
+    adg_entity_set_global_map(child, &translation);
+    adg_entity_set_local_map(ADG_ENTITY(container), &translation);
+    adg_entity_set_local_map(child, &map);
+    adg_entity_arrange(ADG_ENTITY(container));
+
+    /* The shortcuts must give the same result of a full multiplication */
+    cairo_matrix_multiply(&expected, &translation, &map);
+    g_assert_true(adg_matrix_equal(adg_entity_get_global_matrix(child), &expected));
+    g_assert_true(adg_matrix_equal(adg_entity_get_global_matrix(grandchild), &expected));
+
+    cairo_matrix_multiply(&expected, &map, &translation);
+    g_assert_true(adg_matrix_equal(adg_entity_get_local_matrix(child), &expected));
+    g_assert_true(adg_matrix_equal(adg_entity_get_local_matrix(grandchild), &expected));
+
+    /* Going back to identities */
+    adg_entity_set_global_map(child, adg_matrix_identity());
+    adg_entity_set_global_map(ADG_ENTITY(container), adg_matrix_identity());
+    adg_entity_global_changed(ADG_ENTITY(container));
+    g_assert_true(adg_matrix_equal(adg_entity_get_global_matrix(grandchild),
+                                   adg_matrix_identity()));
+
+    adg_entity_destroy(ADG_ENTITY(container));
+
+    /* Translations are kept inline: only generic matrices take room */
+    container = adg_container_new();
+    adg_entity_arrange(ADG_ENTITY(container));
+    size = _adg_instance_size(ADG_ENTITY(container));
+
+    adg_entity_set_global_map(ADG_ENTITY(container), &translation);
+    adg_entity_set_local_map(ADG_ENTITY(container), &translation);
+    adg_entity_arrange(ADG_ENTITY(container));
+    g_assert_cmpuint(_adg_instance_size(ADG_ENTITY(container)), ==, size);
+
+    /* The global map and the global matrix are now generic */
+    adg_entity_set_global_map(ADG_ENTITY(container), &map);
+    adg_entity_arrange(ADG_ENTITY(container));
+    g_assert_cmpuint(_adg_instance_size(ADG_ENTITY(container)), ==,
+                     size + 2 * sizeof(cairo_matrix_t));
+
+    adg_entity_destroy(ADG_ENTITY(container));
+}
+
 static void
 _adg_property_floating(void)
 {
@@ -379,6 +500,48 @@ _adg_property_local_mix(void)
     adg_entity_destroy(entity);
 }
 
+static void
+_adg_count_calls(AdgEntity *entity, gpointer user_data)
+{
+    ++*(gint *) user_data;
+}
+
+static void
+_adg_behavior_handlers(void)
+{
+    AdgEntity *entity;
+    gint n_arrange;
+    gulong handler;
+
+    entity = ADG_ENTITY(adg_logo_new());
+    n_arrange = 0;
+
+    /* Without handlers the fast path must still arrange the entity */
+    adg_entity_arrange(entity);
+    g_assert_true(adg_entity_get_extents(entity)->is_defined);
+    adg_entity_invalidate(entity);
+    g_assert_false(adg_entity_get_extents(entity)->is_defined);
+
+    /* Connected handlers must be called */
+    handler = g_signal_connect(entity, "arrange",
+                               G_CALLBACK(_adg_count_calls), &n_arrange);
+    adg_entity_arrange(entity);
+    g_assert_cmpint(n_arrange, ==, 1);
+    g_assert_true(adg_entity_get_extents(entity)->is_defined);
+
+    /* Blocked handlers must not */
+    g_signal_handler_block(entity, handler);
+    adg_entity_arrange(entity);
+    g_assert_cmpint(n_arrange, ==, 1);
+    g_signal_handler_unblock(entity, handler);
+
+    g_signal_handler_disconnect(entity, handler);
+    adg_entity_arrange(entity);
+    g_assert_cmpint(n_arrange, ==, 1);
+
+    adg_entity_destroy(entity);
+}
+
 static void
 _adg_property_extents(void)
 {
@@ -448,7 +611,10 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/entity/behavior/misc", _adg_behavior_misc);
     g_test_add_func("/adg/entity/behavior/style", _adg_behavior_style);
+    g_test_add_func("/adg/entity/behavior/resolved-style", _adg_behavior_resolved_style);
     g_test_add_func("/adg/entity/behavior/local", _adg_behavior_local);
+    g_test_add_func("/adg/entity/behavior/handlers", _adg_behavior_handlers);
+    g_test_add_func("/adg/entity/behavior/matrices", _adg_behavior_matrices);
 
     g_test_add_func("/adg/entity/property/floating", _adg_property_floating);
     g_test_add_func("/adg/entity/property/parent", _adg_property_parent);
@@ -49,6 +49,70 @@ _adg_property_named_pair(void)
     g_object_unref(model);
 }
 
+static void
+_adg_property_named_pair_quark(void)
+{
+    AdgModel *model;
+    CpmlPair pair;
+    const CpmlPair *named_pair;
+    GQuark quark;
+    gchar name[16];
+    gint n;
+
+    model = ADG_MODEL(adg_path_new());
+    quark = g_quark_from_static_string("Quark");
+    pair.x = 1;
+    pair.y = 2;
+
+    /* Check sanity */
+    g_assert_null(adg_model_get_named_pair_quark(NULL, quark));
+    g_assert_null(adg_model_get_named_pair_quark(model, 0));
+    g_assert_null(adg_model_get_named_pair_quark(model, quark));
+
+    adg_model_set_named_pair_quark(model, quark, &pair);
+    named_pair = adg_model_get_named_pair_quark(model, quark);
+    g_assert_true(cpml_pair_equal(named_pair, &pair));
+
+    /* Quark and string APIs must share the same named pairs */
+    named_pair = adg_model_get_named_pair(model, "Quark");
+    g_assert_true(cpml_pair_equal(named_pair, &pair));
+
+    /* Fill the table enough to trigger some rehashing */
+    for (n = 0; n < 100; ++n) {
+        g_snprintf(name, sizeof(name), "P%d", n);
+        pair.x = n;
+        pair.y = -n;
+        adg_model_set_named_pair(model, name, &pair);
+    }
+
+    /* Remove every other pair and check the remaining ones */
+    for (n = 0; n < 100; n += 2) {
+        g_snprintf(name, sizeof(name), "P%d", n);
+        adg_model_set_named_pair(model, name, NULL);
+    }
+
+    for (n = 0; n < 100; ++n) {
+        g_snprintf(name, sizeof(name), "P%d", n);
+        named_pair = adg_model_get_named_pair(model, name);
+        if (n % 2 == 0) {
+            g_assert_null(named_pair);
+        } else {
+            g_assert_nonnull(named_pair);
+            adg_assert_isapprox(named_pair->x, n);
+            adg_assert_isapprox(named_pair->y, -n);
+        }
+    }
+
+    adg_model_set_named_pair_quark(model, quark, NULL);
+    g_assert_null(adg_model_get_named_pair_quark(model, quark));
+
+    /* Resetting the model removes all the named pairs */
+    adg_model_reset(model);
+    g_assert_null(adg_model_get_named_pair(model, "P1"));
+
+    g_object_unref(model);
+}
+
 static void
 _adg_property_dependency(void)
 {
@@ -100,6 +164,21 @@ _adg_property_dependency(void)
     dependencies = adg_model_get_dependencies(model);
     g_assert_null(dependencies);
 
+    /* The same entity can be added more than once */
+    adg_model_add_dependency(model, valid_entity);
+    adg_model_add_dependency(model, valid_entity);
+    dependencies = adg_model_get_dependencies(model);
+    g_assert_cmpuint(g_slist_length((GSList *) dependencies), ==, 1);
+
+    adg_model_remove_dependency(model, valid_entity);
+    dependencies = adg_model_get_dependencies(model);
+    g_assert_nonnull(dependencies);
+    g_assert_true(dependencies->data == valid_entity);
+
+    adg_model_remove_dependency(model, valid_entity);
+    dependencies = adg_model_get_dependencies(model);
+    g_assert_null(dependencies);
+
     g_object_unref(model);
     adg_entity_destroy(valid_entity);
 }
@@ -114,6 +193,7 @@ main(int argc, char *argv[])
     adg_test_add_model_checks("/adg/model/type/model", ADG_TYPE_MODEL);
 
     g_test_add_func("/adg/model/named-pair", _adg_property_named_pair);
+    g_test_add_func("/adg/model/named-pair-quark", _adg_property_named_pair_quark);
     g_test_add_func("/adg/model/dependency", _adg_property_dependency);
 
     return g_test_run();
@@ -20,6 +20,7 @@
 
 #include <adg-test.h>
 #include <adg.h>
+#include <string.h>
 
 
 static void
@@ -468,6 +469,8 @@ static void
 _adg_method_remove_primitive(void)
 {
     AdgPath *path;
+    const CpmlPair *cp;
+    const CpmlPrimitive *primitive;
     int n;
 
     path = adg_path_new();
@@ -487,6 +490,51 @@ _adg_method_remove_primitive(void)
     /* Ensure the current point is no more set */
     g_assert_false(adg_path_has_current_point(path));
 
+    /* Check last and over primitives are properly restored */
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 0);
+    adg_path_line_to_explicit(path, 1, 1);
+    adg_path_line_to_explicit(path, 0, 1);
+
+    adg_path_remove_primitive(path);
+    cp = adg_path_get_current_point(path);
+    g_assert_nonnull(cp);
+    adg_assert_isapprox(cp->x, 1);
+    adg_assert_isapprox(cp->y, 1);
+    primitive = adg_path_last_primitive(path);
+    g_assert_nonnull(primitive);
+    adg_assert_isapprox(primitive->org->point.x, 1);
+    adg_assert_isapprox(primitive->org->point.y, 0);
+    g_assert_nonnull(adg_path_over_primitive(path));
+
+    adg_path_remove_primitive(path);
+    cp = adg_path_get_current_point(path);
+    g_assert_nonnull(cp);
+    adg_assert_isapprox(cp->x, 1);
+    adg_assert_isapprox(cp->y, 0);
+    g_assert_nonnull(adg_path_last_primitive(path));
+    g_assert_null(adg_path_over_primitive(path));
+
+    adg_path_remove_primitive(path);
+    g_assert_false(adg_path_has_current_point(path));
+    g_assert_null(adg_path_last_primitive(path));
+    g_assert_null(adg_trail_get_cairo_path(ADG_TRAIL(path)));
+
+    /* A primitive appended after a close has no origin but must
+     * not be removed together with the following one */
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 0);
+    adg_path_close(path);
+    adg_path_line_to_explicit(path, 5, 5);
+    adg_path_line_to_explicit(path, 6, 6);
+
+    adg_path_remove_primitive(path);
+    cp = adg_path_get_current_point(path);
+    g_assert_nonnull(cp);
+    adg_assert_isapprox(cp->x, 5);
+    adg_assert_isapprox(cp->y, 5);
+    g_assert_cmpint(adg_trail_cairo_path(ADG_TRAIL(path))->num_data, ==, 7);
+
     g_object_unref(path);
 }
 
@@ -998,6 +1046,206 @@ _adg_method_reflect(void)
     g_object_unref(path);
 }
 
+static void
+_adg_method_snapshot(void)
+{
+    AdgPath *path, *path2;
+    AdgPathSnapshot *snapshot1, *snapshot2, *snapshot3;
+    const cairo_path_t *cairo_path;
+    const CpmlPair *cp;
+
+    path = adg_path_new();
+
+    /* Check sanity */
+    g_assert_null(adg_path_snapshot(NULL));
+    adg_path_restore(NULL, NULL);
+    adg_path_restore(path, NULL);
+
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 0);
+    snapshot1 = adg_path_snapshot(path);
+    g_assert_nonnull(snapshot1);
+
+    adg_path_line_to_explicit(path, 1, 1);
+    snapshot2 = adg_path_snapshot(path);
+    g_assert_nonnull(snapshot2);
+    g_assert_true(snapshot2 != snapshot1);
+
+    /* Nothing changed: the same snapshot must be returned */
+    snapshot3 = adg_path_snapshot(path);
+    g_assert_true(snapshot3 == snapshot2);
+    adg_path_snapshot_unref(snapshot3);
+
+    adg_path_restore(path, snapshot1);
+    cairo_path = adg_trail_get_cairo_path(ADG_TRAIL(path));
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, 4);
+    cp = adg_path_get_current_point(path);
+    g_assert_nonnull(cp);
+    adg_assert_isapprox(cp->x, 1);
+    adg_assert_isapprox(cp->y, 0);
+
+    /* Branch from snapshot1 */
+    adg_path_line_to_explicit(path, 2, 0);
+    adg_path_remove_primitive(path);
+    adg_path_line_to_explicit(path, 3, 0);
+    snapshot3 = adg_path_snapshot(path);
+
+    adg_path_restore(path, snapshot2);
+    cairo_path = adg_trail_get_cairo_path(ADG_TRAIL(path));
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, 6);
+    adg_assert_isapprox(cairo_path->data[5].point.x, 1);
+    adg_assert_isapprox(cairo_path->data[5].point.y, 1);
+
+    adg_path_restore(path, snapshot3);
+    cp = adg_path_get_current_point(path);
+    g_assert_nonnull(cp);
+    adg_assert_isapprox(cp->x, 3);
+    adg_assert_isapprox(cp->y, 0);
+    g_assert_nonnull(adg_path_over_primitive(path));
+
+    /* Snapshots can be restored into different paths */
+    path2 = adg_path_new();
+    adg_path_restore(path2, snapshot2);
+    cp = adg_path_get_current_point(path2);
+    g_assert_nonnull(cp);
+    adg_assert_isapprox(cp->x, 1);
+    adg_assert_isapprox(cp->y, 1);
+
+    /* Snapshots survive their paths */
+    g_object_unref(path);
+    g_object_unref(path2);
+
+    adg_path_snapshot_unref(snapshot1);
+    adg_path_snapshot_unref(snapshot2);
+    adg_path_snapshot_unref(snapshot3);
+}
+
+static void
+_adg_method_clone(void)
+{
+    AdgPath *path, *clone;
+    const cairo_path_t *cairo_path, *clone_path;
+    const CpmlPair *cp;
+    CpmlPair pair;
+
+    g_assert_null(adg_model_clone(NULL));
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 0);
+    adg_path_line_to_explicit(path, 1, 1);
+    pair.x = 3;
+    pair.y = 4;
+    adg_model_set_named_pair(ADG_MODEL(path), "pair", &pair);
+
+    clone = ADG_PATH(adg_model_clone(ADG_MODEL(path)));
+    g_assert_nonnull(clone);
+    g_assert_true(clone != path);
+
+    cairo_path = adg_trail_get_cairo_path(ADG_TRAIL(path));
+    clone_path = adg_trail_get_cairo_path(ADG_TRAIL(clone));
+    g_assert_nonnull(clone_path);
+    g_assert_cmpint(clone_path->num_data, ==, cairo_path->num_data);
+    g_assert_true(clone_path->data != cairo_path->data);
+    g_assert_cmpint(memcmp(clone_path->data, cairo_path->data,
+                           cairo_path->num_data * sizeof(cairo_path_data_t)), ==, 0);
+
+    cp = adg_path_get_current_point(clone);
+    g_assert_nonnull(cp);
+    adg_assert_isapprox(cp->x, 1);
+    adg_assert_isapprox(cp->y, 1);
+
+    cp = adg_model_get_named_pair(ADG_MODEL(clone), "pair");
+    g_assert_nonnull(cp);
+    adg_assert_isapprox(cp->x, 3);
+    adg_assert_isapprox(cp->y, 4);
+
+    /* The clone must be independent from the original path */
+    adg_path_line_to_explicit(clone, 2, 2);
+    g_assert_cmpint(adg_trail_get_cairo_path(ADG_TRAIL(path))->num_data, ==, 6);
+    g_assert_cmpint(adg_trail_get_cairo_path(ADG_TRAIL(clone))->num_data, ==, 8);
+
+    g_object_unref(path);
+    g_object_unref(clone);
+}
+
+static void
+_adg_behavior_allocations(void)
+{
+    AdgPath *path;
+    AdgTestAllocations allocations;
+    gint n;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 1, 1);
+
+    if (! adg_test_allocations_begin()) {
+        g_object_unref(path);
+        g_test_skip("Allocation hooks not available");
+        return;
+    }
+
+    for (n = 0; n < 1000; ++n)
+        adg_path_line_to_explicit(path, n, n % 2);
+
+    adg_test_allocations_end(&allocations);
+
+    /* Appending must be amortized: the data array and the history
+     * of the primitives grow geometrically, so only a few (about
+     * log2(1000) each) reallocations are expected */
+    g_assert_cmpuint(allocations.n_allocations, <=, 2 * 12);
+
+    /* Every line-to takes 2 cairo_path_data_t in the data array
+     * plus 2 offsets in the history: geometric growth can at most
+     * double that */
+    g_assert_cmpint(allocations.peak_bytes, <=,
+                    2 * 1000 * (2 * sizeof(cairo_path_data_t) + 2 * sizeof(gint)));
+
+    g_object_unref(path);
+}
+
+static void
+_adg_behavior_changed(void)
+{
+    AdgPath *path;
+    AdgTrail *trail;
+    cairo_path_t *raw;
+    const cairo_path_t *cairo_path;
+    const CpmlExtents *extents;
+
+    path = adg_path_new();
+    trail = ADG_TRAIL(path);
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    adg_path_line_to_explicit(path, 10, 10);
+
+    /* Keep a raw pointer to the data, then fill the caches */
+    raw = adg_trail_cairo_path(trail);
+    g_assert_nonnull(raw);
+    cairo_path = adg_trail_get_cairo_path(trail);
+    g_assert_nonnull(cairo_path);
+    adg_assert_isapprox(cairo_path->data[5].point.y, 10);
+    extents = adg_trail_get_extents(trail);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.y, 10);
+
+    /* Modify the data directly and notify the change */
+    raw->data[5].point.y = 20;
+    adg_model_changed(ADG_MODEL(path));
+
+    cairo_path = adg_trail_get_cairo_path(trail);
+    g_assert_nonnull(cairo_path);
+    adg_assert_isapprox(cairo_path->data[5].point.y, 20);
+    extents = adg_trail_get_extents(trail);
+    g_assert_true(extents->is_defined);
+    adg_assert_isapprox(extents->size.y, 20);
+
+    g_object_unref(path);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -1007,6 +1255,9 @@ main(int argc, char *argv[])
     adg_test_add_object_checks("/adg/path/type/object", ADG_TYPE_PATH);
     adg_test_add_model_checks("/adg/path/type/model", ADG_TYPE_PATH);
 
+    g_test_add_func("/adg/path/behavior/allocations", _adg_behavior_allocations);
+    g_test_add_func("/adg/path/behavior/changed", _adg_behavior_changed);
+
     g_test_add_func("/adg/path/method/get-current-point", _adg_method_get_current_point);
     g_test_add_func("/adg/path/method/has-current-point", _adg_method_has_current_point);
     g_test_add_func("/adg/path/method/last-primitive", _adg_method_last_primitive);
@@ -1025,6 +1276,8 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/path/method/fillet", _adg_method_fillet);
     g_test_add_func("/adg/path/method/join", _adg_method_join);
     g_test_add_func("/adg/path/method/reflect", _adg_method_reflect);
+    g_test_add_func("/adg/path/method/snapshot", _adg_method_snapshot);
+    g_test_add_func("/adg/path/method/clone", _adg_method_clone);
 
     return g_test_run();
 }
@@ -93,6 +93,7 @@ _adg_behavior_named_pair(void)
     AdgPoint *explicit_point, *explicit_point2, *model_point;
     AdgModel *model;
     CpmlPair *pair;
+    guint generation;
 
     explicit_point = adg_point_new();
     g_assert_nonnull(explicit_point);
@@ -154,12 +155,68 @@ _adg_behavior_named_pair(void)
     g_assert_true(cpml_pair_equal(pair, &p1));
     g_free(pair);
 
+    /* Check the cached lookup follows the named pair changes */
+    generation = adg_model_get_generation(model);
+    g_assert_cmpuint(generation, !=, 0);
+    adg_model_set_named_pair_explicit(model, "named-pair", 1, 2);
+    g_assert_cmpuint(adg_model_get_generation(model), !=, generation);
+    adg_point_invalidate(model_point);
+    g_assert_true(adg_point_update(model_point));
+    pair = (CpmlPair *) model_point;
+    adg_assert_isapprox(pair->x, 1);
+    adg_assert_isapprox(pair->y, 2);
+
+    /* Adding other pairs could relocate the cached one */
+    adg_model_set_named_pair_explicit(model, "other-pair", 3, 4);
+    adg_model_set_named_pair_explicit(model, "named-pair", 5, 6);
+    adg_point_invalidate(model_point);
+    g_assert_true(adg_point_update(model_point));
+    adg_assert_isapprox(pair->x, 5);
+    adg_assert_isapprox(pair->y, 6);
+
+    adg_model_set_named_pair(model, "named-pair", NULL);
+    adg_point_invalidate(model_point);
+    g_assert_false(adg_point_update(model_point));
+
     adg_point_destroy(explicit_point);
     adg_point_destroy(model_point);
     g_object_unref(model);
 }
 
 
+static void
+_adg_behavior_pool(void)
+{
+    AdgPoint *points[100], *point;
+    gpointer old;
+    guint n;
+
+    /* Points are recycled, so the last destroyed block is reused */
+    point = adg_point_new();
+    old = point;
+    adg_point_destroy(point);
+    point = adg_point_new();
+    if (g_strcmp0(g_getenv("ADG_POOL"), "0") != 0)
+        g_assert_true((gpointer) point == old);
+
+    /* Blocks from the pool must be zeroed and not overlapping */
+    for (n = 0; n < G_N_ELEMENTS(points); ++n) {
+        points[n] = adg_point_new();
+        g_assert_null(adg_point_get_name(points[n]));
+        g_assert_null(adg_point_get_model(points[n]));
+        adg_point_set_pair_explicit(points[n], n, -n);
+    }
+
+    for (n = 0; n < G_N_ELEMENTS(points); ++n) {
+        g_assert_true(adg_point_update(points[n]));
+        adg_assert_isapprox(((CpmlPair *) points[n])->x, n);
+        adg_assert_isapprox(((CpmlPair *) points[n])->y, -n);
+        adg_point_destroy(points[n]);
+    }
+
+    adg_point_destroy(point);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -169,6 +226,7 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/point/behavior/misc", _adg_behavior_misc);
     g_test_add_func("/adg/point/behavior/named-pair", _adg_behavior_named_pair);
+    g_test_add_func("/adg/point/behavior/pool", _adg_behavior_pool);
 
     return g_test_run();
 }
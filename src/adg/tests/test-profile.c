@@ -0,0 +1,190 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2022  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+#include <adg-test.h>
+#include <adg.h>
+#include <string.h>
+
+
+static const AdgProfileStats *
+_adg_find(const AdgProfileStats *array, guint n_stats, GType type)
+{
+    guint n;
+
+    for (n = 0; n < n_stats; ++n)
+        if (array[n].type == type)
+            return &array[n];
+
+    return NULL;
+}
+
+static void
+_adg_behavior_misc(void)
+{
+    AdgCanvas *canvas;
+    AdgToyText *toy_text;
+    AdgProfileStats *array;
+    const AdgProfileStats *stats;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    guint n_stats;
+
+    canvas = adg_canvas_new();
+    toy_text = adg_toy_text_new("Profiled");
+    adg_container_add(ADG_CONTAINER(canvas), ADG_ENTITY(toy_text));
+
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cr = cairo_create(surface);
+
+    /* Nothing is collected while the profiler is disabled */
+    adg_switch_profile(FALSE);
+    g_assert_false(adg_profile_is_enabled());
+    adg_profile_reset();
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+    array = adg_profile_get_stats(&n_stats);
+    g_assert_null(array);
+    g_assert_cmpuint(n_stats, ==, 0);
+
+    adg_switch_profile(TRUE);
+    g_assert_true(adg_profile_is_enabled());
+    adg_entity_invalidate(ADG_ENTITY(canvas));
+    adg_entity_render(ADG_ENTITY(canvas), cr);
+
+    array = adg_profile_get_stats(&n_stats);
+    g_assert_nonnull(array);
+    g_assert_cmpuint(n_stats, >=, 2);
+
+    stats = _adg_find(array, n_stats, ADG_TYPE_TOY_TEXT);
+    g_assert_nonnull(stats);
+    g_assert_cmpuint(stats->arrange_count, ==, 1);
+    g_assert_cmpuint(stats->render_count, ==, 1);
+    g_assert_cmpint(stats->render_max_time, <=, stats->render_time);
+    g_assert_cmpuint(stats->cache_hits, ==, 0);
+    g_assert_cmpuint(stats->cache_misses, ==, 0);
+
+    /* The canvas includes the time spent by its children */
+    stats = _adg_find(array, n_stats, ADG_TYPE_CANVAS);
+    g_assert_nonnull(stats);
+    g_assert_cmpuint(stats->render_count, ==, 1);
+    g_assert_cmpint(stats->render_self_time, <=, stats->render_time);
+    g_free(array);
+
+    adg_profile_reset();
+    array = adg_profile_get_stats(&n_stats);
+    g_assert_null(array);
+    g_assert_cmpuint(n_stats, ==, 0);
+
+    adg_switch_profile(FALSE);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(ADG_ENTITY(canvas));
+}
+
+static void
+_adg_method_to_json(void)
+{
+    AdgToyText *toy_text;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    gchar *json;
+
+    adg_profile_reset();
+    json = adg_profile_to_json();
+    g_assert_cmpstr(json, ==, "{\"types\":[]}");
+    g_free(json);
+
+    toy_text = adg_toy_text_new("Profiled");
+    surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 100, 100);
+    cr = cairo_create(surface);
+
+    adg_switch_profile(TRUE);
+    adg_entity_render(ADG_ENTITY(toy_text), cr);
+    adg_switch_profile(FALSE);
+
+    json = adg_profile_to_json();
+    g_assert_nonnull(strstr(json, "{\"type\":\"AdgToyText\",\"arrange\":{\"count\":1,"));
+    g_assert_nonnull(strstr(json, "\"render\":{\"count\":1,"));
+    g_assert_nonnull(strstr(json, "\"cache\":{\"hits\":0,\"misses\":0}}"));
+    g_free(json);
+
+    adg_profile_reset();
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+    adg_entity_destroy(ADG_ENTITY(toy_text));
+}
+
+static void
+_adg_behavior_trace(void)
+{
+    AdgPath *path;
+    AdgStroke *stroke;
+    gchar *json, *origin;
+
+    path = adg_path_new();
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 10);
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+
+    /* Nothing is recorded while the tracer is disabled */
+    adg_switch_trace(FALSE);
+    g_assert_false(adg_trace_is_enabled());
+    adg_trace_reset();
+    adg_model_changed(ADG_MODEL(path));
+    g_assert_cmpuint(adg_trace_get_n_events(), ==, 0);
+
+    adg_switch_trace(TRUE);
+    g_assert_true(adg_trace_is_enabled());
+    adg_model_changed(ADG_MODEL(path));
+    adg_switch_trace(FALSE);
+    g_assert_cmpuint(adg_trace_get_n_events(), >=, 2);
+
+    /* The model originates the cascade that invalidates the stroke */
+    json = adg_trace_to_json();
+    origin = g_strdup_printf("\"origin\":\"AdgPath %p\"", path);
+    g_assert_true(g_str_has_prefix(json, "{\"traceEvents\":[{\"name\":\"changed\","));
+    g_assert_nonnull(strstr(json, "\"name\":\"invalidate\""));
+    g_assert_nonnull(strstr(json, origin));
+    g_assert_nonnull(strstr(json, "\"depth\":1}"));
+    g_free(origin);
+    g_free(json);
+
+    adg_trace_reset();
+    g_assert_cmpuint(adg_trace_get_n_events(), ==, 0);
+    json = adg_trace_to_json();
+    g_assert_cmpstr(json, ==, "{\"traceEvents\":[]}");
+    g_free(json);
+
+    adg_entity_destroy(ADG_ENTITY(stroke));
+    g_object_unref(path);
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    adg_test_init(&argc, &argv);
+
+    g_test_add_func("/adg/profile/behavior/misc", _adg_behavior_misc);
+    g_test_add_func("/adg/profile/behavior/trace", _adg_behavior_trace);
+
+    g_test_add_func("/adg/profile/method/to-json", _adg_method_to_json);
+
+    return g_test_run();
+}
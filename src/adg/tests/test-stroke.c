@@ -115,6 +115,47 @@ _adg_property_trail(void)
     g_object_unref(valid_trail);
 }
 
+static void
+_adg_method_clone(void)
+{
+    AdgContainer *container;
+    AdgPath *path;
+    AdgStroke *stroke, *clone;
+    cairo_matrix_t map;
+    const GSList *dependencies;
+
+    g_assert_null(adg_entity_clone(NULL));
+
+    container = adg_container_new();
+    path = adg_path_new();
+    stroke = adg_stroke_new(ADG_TRAIL(path));
+    adg_stroke_set_line_dress(stroke, ADG_DRESS_LINE_DIMENSION);
+    cairo_matrix_init_translate(&map, 1, 2);
+    adg_entity_set_local_map(ADG_ENTITY(stroke), &map);
+    adg_container_add(container, ADG_ENTITY(stroke));
+
+    clone = ADG_STROKE(adg_entity_clone(ADG_ENTITY(stroke)));
+    g_assert_nonnull(clone);
+    g_assert_true(clone != stroke);
+    g_assert_null(adg_entity_get_parent(ADG_ENTITY(clone)));
+    g_assert_cmpint(adg_stroke_get_line_dress(clone), ==, ADG_DRESS_LINE_DIMENSION);
+    g_assert_true(adg_matrix_equal(adg_entity_get_local_map(ADG_ENTITY(clone)), &map));
+
+    /* The trail is shared and the clone depends on it */
+    g_assert_true(adg_stroke_get_trail(clone) == ADG_TRAIL(path));
+    dependencies = adg_model_get_dependencies(ADG_MODEL(path));
+    g_assert_nonnull(g_slist_find((GSList *) dependencies, clone));
+    g_assert_nonnull(g_slist_find((GSList *) dependencies, stroke));
+
+    adg_entity_destroy(ADG_ENTITY(clone));
+    dependencies = adg_model_get_dependencies(ADG_MODEL(path));
+    g_assert_true(dependencies->data == stroke);
+    g_assert_null(dependencies->next);
+
+    adg_entity_destroy(ADG_ENTITY(container));
+    g_object_unref(path);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -138,5 +179,7 @@ main(int argc, char *argv[])
     g_test_add_func("/adg/stroke/property/line-dress", _adg_property_line_dress);
     g_test_add_func("/adg/stroke/property/trail", _adg_property_trail);
 
+    g_test_add_func("/adg/stroke/method/clone", _adg_method_clone);
+
     return g_test_run();
 }
@@ -25,12 +25,43 @@
 static void
 _adg_method_clone(void)
 {
-    AdgStyleClass *klass;
+    AdgStyleClass *klass, *style_klass;
+    AdgStyle *style, *clone;
+    GType types[4];
+    guint n;
 
-    /* Just check that the default implementation is adg_object_clone */
-    klass = g_type_class_ref(ADG_TYPE_STYLE);
-    g_assert_true(G_CALLBACK(klass->clone) == G_CALLBACK(adg_object_clone));
-    g_type_class_unref(klass);
+    /* The default implementation must be overriden by the core styles */
+    style_klass = g_type_class_ref(ADG_TYPE_STYLE);
+    g_assert_nonnull(style_klass->clone);
+
+    types[0] = ADG_TYPE_COLOR_STYLE;
+    types[1] = ADG_TYPE_LINE_STYLE;
+    types[2] = ADG_TYPE_FONT_STYLE;
+    types[3] = ADG_TYPE_DIM_STYLE;
+    for (n = 0; n < G_N_ELEMENTS(types); ++n) {
+        klass = g_type_class_ref(types[n]);
+        g_assert_nonnull(klass->clone);
+        g_assert_true(klass->clone != style_klass->clone);
+        g_type_class_unref(klass);
+    }
+
+    g_type_class_unref(style_klass);
+
+    style = ADG_STYLE(adg_color_style_new());
+    adg_color_style_set_rgb(ADG_COLOR_STYLE(style), 0.1, 0.2, 0.3);
+    adg_color_style_set_alpha(ADG_COLOR_STYLE(style), 0.4);
+
+    clone = adg_style_clone(style);
+    g_assert_nonnull(clone);
+    g_assert_true(clone != style);
+    g_assert_true(G_OBJECT_TYPE(clone) == ADG_TYPE_COLOR_STYLE);
+    adg_assert_isapprox(adg_color_style_get_red(ADG_COLOR_STYLE(clone)), 0.1);
+    adg_assert_isapprox(adg_color_style_get_green(ADG_COLOR_STYLE(clone)), 0.2);
+    adg_assert_isapprox(adg_color_style_get_blue(ADG_COLOR_STYLE(clone)), 0.3);
+    adg_assert_isapprox(adg_color_style_get_alpha(ADG_COLOR_STYLE(clone)), 0.4);
+
+    g_object_unref(style);
+    g_object_unref(clone);
 }
 
 
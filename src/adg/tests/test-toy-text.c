@@ -22,6 +22,42 @@
 #include <adg.h>
 
 
+static void
+_adg_behavior_reposition(void)
+{
+    AdgEntity *entity;
+    CpmlExtents extents;
+    const CpmlExtents *new_extents;
+    cairo_matrix_t map;
+
+    entity = ADG_ENTITY(adg_toy_text_new("Testing"));
+    adg_entity_arrange(entity);
+    cpml_extents_copy(&extents, adg_entity_get_extents(entity));
+    g_assert_true(extents.is_defined);
+
+    /* A translation must reuse the glyphs, moving only the extents */
+    adg_test_signal(entity, "invalidate");
+    cairo_matrix_init_translate(&map, 10, 20);
+    adg_entity_set_local_map(entity, &map);
+    adg_entity_arrange(entity);
+    g_assert_false(adg_test_signal_check(FALSE));
+
+    new_extents = adg_entity_get_extents(entity);
+    g_assert_true(new_extents->is_defined);
+    adg_assert_isapprox(new_extents->org.x, extents.org.x + 10);
+    adg_assert_isapprox(new_extents->org.y, extents.org.y + 20);
+    adg_assert_isapprox(new_extents->size.x, extents.size.x);
+    adg_assert_isapprox(new_extents->size.y, extents.size.y);
+
+    /* A different scale requires new glyphs */
+    cairo_matrix_init_scale(&map, 2, 2);
+    adg_entity_set_global_map(entity, &map);
+    adg_entity_arrange(entity);
+    g_assert_true(adg_test_signal_check(TRUE));
+
+    adg_entity_destroy(entity);
+}
+
 static void
 _adg_property_local_mix(void)
 {
@@ -147,6 +183,7 @@ main(int argc, char *argv[])
     adg_test_add_entity_checks("/adg/toy-text/type/entity", ADG_TYPE_TOY_TEXT);
 
     adg_test_add_global_space_checks("/adg/toy-text/behavior/global-space", adg_toy_text_new("Testing"));
+    g_test_add_func("/adg/toy-text/behavior/reposition", _adg_behavior_reposition);
 
     g_test_add_func("/adg/toy-text/property/local-mix", _adg_property_local_mix);
     g_test_add_func("/adg/toy-text/property/font-dress", _adg_property_font_dress);
@@ -42,6 +42,39 @@ _adg_path_callback(AdgTrail *trail, gpointer user_data)
     return &path;
 }
 
+static void
+_adg_assert_incremental(AdgTrail *trail)
+{
+    const cairo_path_t *cairo_path;
+    GArray *incremental;
+    const cairo_path_data_t *data1, *data2;
+    gint n, i;
+
+    cairo_path = adg_trail_get_cairo_path(trail);
+    g_assert_nonnull(cairo_path);
+    incremental = g_array_new(FALSE, FALSE, sizeof(cairo_path_data_t));
+    g_array_append_vals(incremental, cairo_path->data, cairo_path->num_data);
+
+    /* Force a full conversion and compare it with the incremental one */
+    adg_trail_clear_from(trail, 0);
+    cairo_path = adg_trail_get_cairo_path(trail);
+    g_assert_nonnull(cairo_path);
+    g_assert_cmpint(cairo_path->num_data, ==, incremental->len);
+
+    for (n = 0; n < cairo_path->num_data; n += data1->header.length) {
+        data1 = &g_array_index(incremental, cairo_path_data_t, n);
+        data2 = &cairo_path->data[n];
+        g_assert_cmpint(data1->header.type, ==, data2->header.type);
+        g_assert_cmpint(data1->header.length, ==, data2->header.length);
+        for (i = 1; i < data1->header.length; ++i) {
+            adg_assert_isapprox(data1[i].point.x, data2[i].point.x);
+            adg_assert_isapprox(data1[i].point.y, data2[i].point.y);
+        }
+    }
+
+    g_array_free(incremental, TRUE);
+}
+
 
 static void
 _adg_property_max_angle(void)
@@ -162,6 +195,62 @@ _adg_method_put_segment(void)
     g_object_unref(path);
 }
 
+static void
+_adg_method_clear_from(void)
+{
+    AdgPath *path;
+    AdgTrail *trail;
+    const cairo_path_t *cairo_path;
+
+    path = adg_path_new();
+    trail = ADG_TRAIL(path);
+
+    /* Sanity checks */
+    adg_trail_clear_from(NULL, 0);
+    adg_trail_clear_from(trail, -1);
+
+    /* Appending primitives must convert only the new ones */
+    adg_path_move_to_explicit(path, 0, 0);
+    adg_path_line_to_explicit(path, 10, 0);
+    _adg_assert_incremental(trail);
+
+    adg_path_arc_to_explicit(path, 15, 5, 10, 10);
+    _adg_assert_incremental(trail);
+
+    adg_path_line_to_explicit(path, 0, 10);
+    _adg_assert_incremental(trail);
+
+    /* Operations modify the primitive before the appended one */
+    adg_path_fillet(path, 1);
+    adg_path_line_to_explicit(path, 0, 5);
+    _adg_assert_incremental(trail);
+
+    adg_path_chamfer(path, 1, 1);
+    adg_path_close(path);
+    adg_path_fillet(path, 1);
+    _adg_assert_incremental(trail);
+
+    /* Removing primitives must not leave stale data */
+    adg_path_arc_to_explicit(path, 5, 5, 5, 0);
+    _adg_assert_incremental(trail);
+    adg_path_remove_primitive(path);
+    _adg_assert_incremental(trail);
+
+    adg_path_append_cairo_path(path, adg_test_path());
+    _adg_assert_incremental(trail);
+
+    /* A different max angle must convert the whole path again */
+    cairo_path = adg_trail_get_cairo_path(trail);
+    g_assert_nonnull(cairo_path);
+    adg_trail_set_max_angle(trail, G_PI / 10);
+    _adg_assert_incremental(trail);
+
+    adg_model_clear(ADG_MODEL(path));
+    g_assert_null(adg_trail_get_cairo_path(trail));
+
+    g_object_unref(path);
+}
+
 
 int
 main(int argc, char *argv[])
@@ -175,6 +264,7 @@ main(int argc, char *argv[])
 
     g_test_add_func("/adg/trail/method/n-segments", _adg_method_n_segments);
     g_test_add_func("/adg/trail/method/put-segment", _adg_method_put_segment);
+    g_test_add_func("/adg/trail/method/clear-from", _adg_method_clear_from);
 
     return g_test_run();
 }
@@ -0,0 +1,210 @@
+/* ADG - Automatic Drawing Generation
+ * Copyright (C) 2007-2022  Nicola Fontana <ntd at entidi.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ */
+
+
+/* Allocation accounting: the allocator entry points are interposed
+ * by defining them here, so every allocation performed by the test
+ * program (libadg and its dependencies included) goes through them.
+ *
+ * This is kept out of libadgtest on purpose: only the test programs
+ * that call adg_test_allocations_begin() link this helper, so the
+ * other ones use the allocator untouched.
+ *
+ * The real allocator is reached through the aliases exported by
+ * glibc, so this is available on glibc only and not when a sanitizer
+ * provides its own allocator. Every entry point of the malloc family
+ * is interposed: the ones left out would bypass the accounting or,
+ * worse, hand memory not tracked to the interposed free(). */
+
+
+#include <adg/adg-internal.h>
+#include "adg-test.h"
+
+
+#if defined(__GLIBC__) && ! defined(__SANITIZE_ADDRESS__)
+
+#include <malloc.h>
+#include <errno.h>
+#include <stdint.h>
+
+extern void *   __libc_malloc                   (size_t          size);
+extern void *   __libc_calloc                   (size_t          n,
+                                                 size_t          size);
+extern void *   __libc_realloc                  (void           *ptr,
+                                                 size_t          size);
+extern void *   __libc_memalign                 (size_t          alignment,
+                                                 size_t          size);
+extern void *   __libc_valloc                   (size_t          size);
+extern void *   __libc_pvalloc                  (size_t          size);
+extern void     __libc_free                     (void           *ptr);
+
+static gboolean _adg_counting = FALSE;
+static guint64  _adg_n_allocations = 0;
+static gint64   _adg_bytes = 0;
+static gint64   _adg_peak_bytes = 0;
+
+static void
+_adg_allocated(void *ptr, gint64 released)
+{
+    if (_adg_counting && ptr != NULL) {
+        ++_adg_n_allocations;
+        _adg_bytes += (gint64) malloc_usable_size(ptr) - released;
+        if (_adg_bytes > _adg_peak_bytes)
+            _adg_peak_bytes = _adg_bytes;
+    }
+}
+
+void *
+malloc(size_t size)
+{
+    void *ptr = __libc_malloc(size);
+    _adg_allocated(ptr, 0);
+    return ptr;
+}
+
+void *
+calloc(size_t n, size_t size)
+{
+    void *ptr = __libc_calloc(n, size);
+    _adg_allocated(ptr, 0);
+    return ptr;
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+    gint64 released = 0;
+
+    if (_adg_counting && ptr != NULL)
+        released = malloc_usable_size(ptr);
+
+    ptr = __libc_realloc(ptr, size);
+
+    /* realloc(ptr, 0) can release the memory without returning it */
+    if (ptr != NULL)
+        _adg_allocated(ptr, released);
+    else if (size == 0)
+        _adg_bytes -= released;
+
+    return ptr;
+}
+
+void *
+reallocarray(void *ptr, size_t n, size_t size)
+{
+    /* The glibc implementation calls its internal realloc directly */
+    if (size != 0 && n > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    return realloc(ptr, n * size);
+}
+
+void *
+memalign(size_t alignment, size_t size)
+{
+    void *ptr = __libc_memalign(alignment, size);
+    _adg_allocated(ptr, 0);
+    return ptr;
+}
+
+void *
+aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+int
+posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+    void *ptr;
+
+    /* Same checks performed by glibc */
+    if (alignment % sizeof(void *) != 0 ||
+        (alignment & (alignment - 1)) != 0 || alignment == 0)
+        return EINVAL;
+
+    ptr = memalign(alignment, size);
+    if (ptr == NULL)
+        return ENOMEM;
+
+    *memptr = ptr;
+    return 0;
+}
+
+void *
+valloc(size_t size)
+{
+    void *ptr = __libc_valloc(size);
+    _adg_allocated(ptr, 0);
+    return ptr;
+}
+
+void *
+pvalloc(size_t size)
+{
+    void *ptr = __libc_pvalloc(size);
+    _adg_allocated(ptr, 0);
+    return ptr;
+}
+
+void
+free(void *ptr)
+{
+    if (_adg_counting && ptr != NULL)
+        _adg_bytes -= malloc_usable_size(ptr);
+
+    __libc_free(ptr);
+}
+
+gboolean
+adg_test_allocations_begin(void)
+{
+    _adg_n_allocations = 0;
+    _adg_bytes = 0;
+    _adg_peak_bytes = 0;
+    _adg_counting = TRUE;
+    return TRUE;
+}
+
+void
+adg_test_allocations_end(AdgTestAllocations *allocations)
+{
+    _adg_counting = FALSE;
+    allocations->n_allocations = _adg_n_allocations;
+    allocations->peak_bytes = _adg_peak_bytes;
+}
+
+#else
+
+gboolean
+adg_test_allocations_begin(void)
+{
+    return FALSE;
+}
+
+void
+adg_test_allocations_end(AdgTestAllocations *allocations)
+{
+    allocations->n_allocations = 0;
+    allocations->peak_bytes = 0;
+}
+
+#endif
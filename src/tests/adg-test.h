@@ -110,6 +110,33 @@ G_BEGIN_DECLS
  */
 typedef void (*AdgTrapsFunc)(gint i);
 
+/* The following struct is filled by adg_test_allocations_end() with
+ * the allocations performed since adg_test_allocations_begin():
+ * @n_allocations counts every successful malloc() (realloc() and the
+ * aligned variants included) while @peak_bytes is the maximum amount
+ * of memory held at the same time, relative to the starting point.
+ *
+ * These functions are not part of libadgtest: they are provided by
+ * the adgtest-allocations helper, that replaces the allocator of the
+ * whole program and so must be linked only by the tests using them.
+ *
+ * <informalexample><programlisting language="C">
+ * AdgTestAllocations allocations;
+ *
+ * if (! adg_test_allocations_begin()) {
+ *     g_test_skip("Allocation hooks not available");
+ *     return;
+ * }
+ * do_something();
+ * adg_test_allocations_end(&allocations);
+ * g_assert_cmpuint(allocations.n_allocations, ==, 0);
+ * </programlisting></informalexample>
+ */
+typedef struct {
+    guint64     n_allocations;
+    gint64      peak_bytes;
+} AdgTestAllocations;
+
 
 void            adg_test_init                   (int            *p_argc,
                                                  char          **p_argv[]);
@@ -142,6 +169,8 @@ void            adg_test_add_local_space_checks (const gchar    *testpath,
 void            adg_test_add_traps              (const gchar    *testpath,
                                                  AdgTrapsFunc    func,
                                                  gint            n_fragments);
+gboolean        adg_test_allocations_begin      (void);
+void            adg_test_allocations_end        (AdgTestAllocations *allocations);
 
 G_END_DECLS
 